@@ -173,7 +173,8 @@ private:
 
 
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _syst(system), _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _syst(system), _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _commandMutex(), _commandHead(0), _commandTail(0) {
 
 	assert(sampleRate > 0);
 
@@ -217,6 +218,93 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	Common::StackLock lock(_commandMutex);
+	ChannelControl &control = _channelControls[index];
+	control.active = true;
+	control.handle = chanHandle._val;
+	control.volume = chan->getVolume();
+	control.balance = chan->getBalance();
+}
+
+void MixerImpl::deleteChannel(int index) {
+	delete _channels[index];
+	_channels[index] = 0;
+
+	Common::StackLock lock(_commandMutex);
+	_channelControls[index].active = false;
+}
+
+void MixerImpl::pushCommand(const Command &cmd) {
+	while (true) {
+		{
+			Common::StackLock lock(_commandMutex);
+			const uint next = (_commandHead + 1) % COMMAND_QUEUE_SIZE;
+			if (next != _commandTail) {
+				_commands[_commandHead] = cmd;
+				_commandHead = next;
+				return;
+			}
+		}
+
+		// The queue is full, which means the mixer callback is not keeping
+		// up (or is not running at all). Apply the pending commands here.
+		Common::StackLock lock(_mutex);
+		processCommands();
+	}
+}
+
+void MixerImpl::processCommands() {
+	Command pending[COMMAND_QUEUE_SIZE];
+	uint count = 0;
+
+	{
+		Common::StackLock lock(_commandMutex);
+		while (_commandTail != _commandHead) {
+			pending[count++] = _commands[_commandTail];
+			_commandTail = (_commandTail + 1) % COMMAND_QUEUE_SIZE;
+		}
+	}
+
+	for (uint i = 0; i < count; i++)
+		applyCommand(pending[i]);
+}
+
+void MixerImpl::applyCommand(const Command &cmd) {
+	switch (cmd.type) {
+	case Command::kSetVolume:
+	case Command::kSetBalance:
+	case Command::kPauseHandle: {
+		// Silently drop requests for sounds that terminated in the meantime
+		const int index = cmd.handle % NUM_CHANNELS;
+		if (!_channels[index] || _channels[index]->getHandle()._val != cmd.handle)
+			break;
+
+		if (cmd.type == Command::kSetVolume)
+			_channels[index]->setVolume(cmd.value);
+		else if (cmd.type == Command::kSetBalance)
+			_channels[index]->setBalance(cmd.value);
+		else
+			_channels[index]->pause(cmd.value != 0);
+		break;
+		}
+
+	case Command::kPauseAll:
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0)
+				_channels[i]->pause(cmd.value != 0);
+		}
+		break;
+
+	case Command::kPauseID:
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && _channels[i]->getId() == cmd.id) {
+				_channels[i]->pause(cmd.value != 0);
+				break;
+			}
+		}
+		break;
+	}
 }
 
 void MixerImpl::playStream(
@@ -228,6 +316,7 @@ void MixerImpl::playStream(
 			bool permanent,
 			bool reverseStereo) {
 	Common::StackLock lock(_mutex);
+	processCommands();
 
 	if (stream == 0) {
 		warning("stream is 0");
@@ -268,6 +357,7 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
 	Common::StackLock lock(_mutex);
+	processCommands();
 
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
@@ -285,8 +375,7 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
+				deleteChannel(i);
 			} else if (!_channels[i]->isPaused()) {
 				tmp = _channels[i]->mix(buf, len);
 
@@ -300,34 +389,32 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
+	processCommands();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && !_channels[i]->isPermanent())
+			deleteChannel(i);
 	}
 }
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
+	processCommands();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && _channels[i]->getId() == id)
+			deleteChannel(i);
 	}
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	processCommands();
 
 	// Simply ignore stop requests for handles of sounds that already terminated
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+	deleteChannel(index);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
@@ -346,39 +433,63 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
-	Common::StackLock lock(_mutex);
-
 	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
 
-	_channels[index]->setVolume(volume);
+	{
+		Common::StackLock lock(_commandMutex);
+		ChannelControl &control = _channelControls[index];
+		if (!control.active || control.handle != handle._val)
+			return;
+
+		control.volume = volume;
+	}
+
+	Command cmd;
+	cmd.type = Command::kSetVolume;
+	cmd.handle = handle._val;
+	cmd.id = -1;
+	cmd.value = volume;
+	pushCommand(cmd);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_commandMutex);
+
+	const ChannelControl &control = _channelControls[handle._val % NUM_CHANNELS];
+	if (!control.active || control.handle != handle._val)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return control.volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
-	Common::StackLock lock(_mutex);
-
 	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
 
-	_channels[index]->setBalance(balance);
+	{
+		Common::StackLock lock(_commandMutex);
+		ChannelControl &control = _channelControls[index];
+		if (!control.active || control.handle != handle._val)
+			return;
+
+		control.balance = balance;
+	}
+
+	Command cmd;
+	cmd.type = Command::kSetBalance;
+	cmd.handle = handle._val;
+	cmd.id = -1;
+	cmd.value = balance;
+	pushCommand(cmd);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_commandMutex);
+
+	const ChannelControl &control = _channelControls[handle._val % NUM_CHANNELS];
+	if (!control.active || control.handle != handle._val)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return control.balance;
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -396,33 +507,32 @@ Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 }
 
 void MixerImpl::pauseAll(bool paused) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0) {
-			_channels[i]->pause(paused);
-		}
-	}
+	Command cmd;
+	cmd.type = Command::kPauseAll;
+	cmd.handle = 0;
+	cmd.id = -1;
+	cmd.value = paused;
+	pushCommand(cmd);
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			_channels[i]->pause(paused);
-			return;
-		}
-	}
+	Command cmd;
+	cmd.type = Command::kPauseID;
+	cmd.handle = 0;
+	cmd.id = id;
+	cmd.value = paused;
+	pushCommand(cmd);
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
-	Common::StackLock lock(_mutex);
-
-	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	_channels[index]->pause(paused);
+	// Requests for sounds that already terminated are ignored when the
+	// command gets applied
+	Command cmd;
+	cmd.type = Command::kPauseHandle;
+	cmd.handle = handle._val;
+	cmd.id = -1;
+	cmd.value = paused;
+	pushCommand(cmd);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
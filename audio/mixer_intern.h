@@ -51,7 +51,8 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+		COMMAND_QUEUE_SIZE = 64
 	};
 
 	OSystem *_syst;
@@ -71,6 +72,52 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	/**
+	 * A deferred channel control request. Volume, balance and pause changes
+	 * are queued by the engine thread(s) and applied by mixCallback() at the
+	 * start of the next buffer, so that they never have to wait for _mutex
+	 * (which is held for the whole duration of a mix).
+	 */
+	struct Command {
+		enum Type {
+			kSetVolume,
+			kSetBalance,
+			kPauseAll,
+			kPauseID,
+			kPauseHandle
+		};
+
+		Type type;
+		uint32 handle;
+		int id;
+		int value;
+	};
+
+	/**
+	 * Engine side view of a channel's volume and balance. This is what
+	 * getChannelVolume() and getChannelBalance() report, so that a value
+	 * which was just set is visible before mixCallback() has picked it up.
+	 */
+	struct ChannelControl {
+		ChannelControl() : active(false), handle(0), volume(0), balance(0) {}
+
+		bool active;
+		uint32 handle;
+		byte volume;
+		int8 balance;
+	};
+
+	/**
+	 * Guards the command ring and _channelControls. It is only ever held for
+	 * a single push or for copying the pending commands out of the ring,
+	 * never while mixing. When both locks are needed, _mutex is taken first.
+	 */
+	Common::Mutex _commandMutex;
+	Command _commands[COMMAND_QUEUE_SIZE];
+	uint _commandHead;
+	uint _commandTail;
+	ChannelControl _channelControls[NUM_CHANNELS];
+
 
 public:
 
@@ -122,11 +169,31 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/**
+	 * Deletes the channel at the given index and marks its control slot
+	 * as unused. Must be called with _mutex held.
+	 */
+	void deleteChannel(int index);
+
+	/**
+	 * Queues a control command for the mixing thread. Should the queue be
+	 * full, the pending commands are applied right away instead.
+	 */
+	void pushCommand(const Command &cmd);
+
+	/**
+	 * Applies all queued control commands. Must be called with _mutex held.
+	 */
+	void processCommands();
+
+	void applyCommand(const Command &cmd);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
 	 * the backend (e.g. from an audio mixing thread). All the actual mixing
-	 * work is done from here.
+	 * work is done from here. Control requests queued since the last call
+	 * (volume, balance and pause changes) are applied before mixing.
 	 *
 	 * @param samples Sample buffer, in which stereo 16-bit samples will be stored.
 	 * @param len Length of the provided buffer to fill (in bytes, should be divisible by 4).
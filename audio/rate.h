@@ -80,6 +80,20 @@ public:
 
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
 
+/**
+ * Returns whether vectorized (SSE2 or NEON) mixing kernels can be used for
+ * rate conversion on the CPU ScummVM is running on.
+ */
+bool hasSIMDRateConversion();
+
+/**
+ * Enables or disables the vectorized mixing kernels for rate converters
+ * created afterwards. They are used by default whenever they are available;
+ * both paths produce identical output, so this is mostly useful to compare
+ * them against each other.
+ */
+void enableSIMDRateConversion(bool enable);
+
 } // End of namespace Audio
 
 #endif
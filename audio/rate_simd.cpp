@@ -0,0 +1,240 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/*
+ * Mixing kernels used by the rate converters in rate.cpp.
+ *
+ * The scalar kernels are the reference implementation. The SSE2 and NEON
+ * kernels produce bit-identical output: products are computed in 32 bits,
+ * divided by Mixer::kMaxMixerVolume rounding towards zero (like the C
+ * division in the scalar code) and added with signed saturation, which is
+ * what clampedAdd() does.
+ *
+ * SSE2 kernels are built with a function level target attribute on GCC, so
+ * 32 bit x86 builds pick them at runtime only on CPUs supporting SSE2.
+ */
+
+#include "audio/rate_simd.h"
+#include "audio/mixer.h"
+
+#include "common/simd.h"
+
+#if !defined(OUTPUT_UNSIGNED_AUDIO)
+#if defined(SCUMMVM_SIMD_SSE2)
+#define RATE_SIMD_SSE2
+#elif defined(SCUMMVM_SIMD_NEON)
+#define RATE_SIMD_NEON
+#endif
+#endif
+
+namespace Audio {
+
+static bool s_simdEnabled = true;
+
+#pragma mark -
+#pragma mark --- Scalar kernels ---
+#pragma mark -
+
+template<bool stereo, bool reverseStereo>
+static void mixScalar(st_sample_t *obuf, const st_sample_t *src, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; frames > 0; frames--) {
+		st_sample_t out0, out1;
+		out0 = *src++;
+		out1 = (stereo ? *src++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+	}
+}
+
+#ifdef RATE_SIMD_SSE2
+
+#pragma mark -
+#pragma mark --- SSE2 kernels ---
+#pragma mark -
+
+/**
+ * Scales eight samples by the per lane volumes and adds the result to
+ * eight output samples with saturation.
+ */
+SCUMMVM_SSE2_TARGET
+static inline __m128i mixLanesSSE2(__m128i out, __m128i in, __m128i vol) {
+	const __m128i lo = _mm_mullo_epi16(in, vol);
+	const __m128i hi = _mm_mulhi_epi16(in, vol);
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+
+	// Divide by kMaxMixerVolume (256), rounding towards zero
+	const __m128i round = _mm_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), round)), 8);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), round)), 8);
+
+	return _mm_adds_epi16(out, _mm_packs_epi32(p0, p1));
+}
+
+template<bool stereo, bool reverseStereo>
+SCUMMVM_SSE2_TARGET
+static void mixSSE2(st_sample_t *obuf, const st_sample_t *src, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	// When the output is reversed, the left volume applies to the right
+	// output sample and vice versa.
+	const int16 vol0 = (int16)(reverseStereo ? vol_r : vol_l);
+	const int16 vol1 = (int16)(reverseStereo ? vol_l : vol_r);
+	const __m128i vol = _mm_set_epi16(vol1, vol0, vol1, vol0, vol1, vol0, vol1, vol0);
+
+	for (; frames >= 4; frames -= 4) {
+		__m128i in;
+		if (stereo) {
+			in = _mm_loadu_si128((const __m128i *)src);
+			if (reverseStereo) {
+				in = _mm_shufflelo_epi16(in, _MM_SHUFFLE(2, 3, 0, 1));
+				in = _mm_shufflehi_epi16(in, _MM_SHUFFLE(2, 3, 0, 1));
+			}
+			src += 8;
+		} else {
+			in = _mm_loadl_epi64((const __m128i *)src);
+			in = _mm_unpacklo_epi16(in, in);
+			src += 4;
+		}
+
+		const __m128i out = _mm_loadu_si128((const __m128i *)obuf);
+		_mm_storeu_si128((__m128i *)obuf, mixLanesSSE2(out, in, vol));
+		obuf += 8;
+	}
+
+	mixScalar<stereo, reverseStereo>(obuf, src, frames, vol_l, vol_r);
+}
+
+#endif // RATE_SIMD_SSE2
+
+#ifdef RATE_SIMD_NEON
+
+#pragma mark -
+#pragma mark --- NEON kernels ---
+#pragma mark -
+
+static inline int16x4_t scaleLanesNEON(int16x4_t in, int16x4_t vol) {
+	int32x4_t p = vmull_s16(in, vol);
+
+	// Divide by kMaxMixerVolume (256), rounding towards zero
+	const int32x4_t round = vdupq_n_s32(Audio::Mixer::kMaxMixerVolume - 1);
+	p = vaddq_s32(p, vandq_s32(vshrq_n_s32(p, 31), round));
+	return vmovn_s32(vshrq_n_s32(p, 8));
+}
+
+template<bool stereo, bool reverseStereo>
+static void mixNEON(st_sample_t *obuf, const st_sample_t *src, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	// When the output is reversed, the left volume applies to the right
+	// output sample and vice versa.
+	const int16 vol0 = (int16)(reverseStereo ? vol_r : vol_l);
+	const int16 vol1 = (int16)(reverseStereo ? vol_l : vol_r);
+	const int16 volLanes[4] = { vol0, vol1, vol0, vol1 };
+	const int16x4_t vol = vld1_s16(volLanes);
+
+	for (; frames >= 4; frames -= 4) {
+		int16x8_t in;
+		if (stereo) {
+			in = vld1q_s16(src);
+			if (reverseStereo)
+				in = vrev32q_s16(in);
+			src += 8;
+		} else {
+			const int16x4_t mono = vld1_s16(src);
+			const int16x4x2_t pairs = vzip_s16(mono, mono);
+			in = vcombine_s16(pairs.val[0], pairs.val[1]);
+			src += 4;
+		}
+
+		const int16x8_t scaled = vcombine_s16(scaleLanesNEON(vget_low_s16(in), vol), scaleLanesNEON(vget_high_s16(in), vol));
+		vst1q_s16(obuf, vqaddq_s16(vld1q_s16(obuf), scaled));
+		obuf += 8;
+	}
+
+	mixScalar<stereo, reverseStereo>(obuf, src, frames, vol_l, vol_r);
+}
+
+#endif // RATE_SIMD_NEON
+
+#pragma mark -
+
+bool hasSIMDRateConversion() {
+#if defined(RATE_SIMD_SSE2)
+	static const bool sse2 = Common::hasSSE2();
+	return sse2;
+#elif defined(RATE_SIMD_NEON)
+	return true;
+#else
+	return false;
+#endif
+}
+
+void enableSIMDRateConversion(bool enable) {
+	s_simdEnabled = enable;
+}
+
+template<bool stereo, bool reverseStereo>
+static RateMixFunc getRateMixFunc() {
+	if (s_simdEnabled && hasSIMDRateConversion()) {
+#if defined(RATE_SIMD_SSE2)
+		return &mixSSE2<stereo, reverseStereo>;
+#elif defined(RATE_SIMD_NEON)
+		return &mixNEON<stereo, reverseStereo>;
+#endif
+	}
+
+	return &mixScalar<stereo, reverseStereo>;
+}
+
+RateMixFunc getRateMixFunc(bool stereo, bool reverseStereo) {
+	if (stereo) {
+		if (reverseStereo)
+			return getRateMixFunc<true, true>();
+		else
+			return getRateMixFunc<true, false>();
+	} else {
+		if (reverseStereo)
+			return getRateMixFunc<false, true>();
+		else
+			return getRateMixFunc<false, false>();
+	}
+}
+
+RateMixFunc getCopyRateMixFunc(bool stereo, bool reverseStereo) {
+#if defined(RATE_SIMD_SSE2)
+	// Without resampling, the unaligned loads and shuffles of the stereo
+	// SSE2 kernel cost more than they save
+	if (stereo) {
+		if (reverseStereo)
+			return &mixScalar<true, true>;
+		else
+			return &mixScalar<true, false>;
+	}
+#endif
+
+	return getRateMixFunc(stereo, reverseStereo);
+}
+
+} // End of namespace Audio
@@ -0,0 +1,57 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_RATE_SIMD_H
+#define AUDIO_RATE_SIMD_H
+
+#include "audio/rate.h"
+
+namespace Audio {
+
+/**
+ * Mixes a block of converted samples into an output buffer.
+ *
+ * The source holds 'frames' sample frames, either interleaved left/right
+ * pairs or single mono samples, depending on the kernel. Every sample is
+ * scaled by its channel volume (divided by Mixer::kMaxMixerVolume, rounding
+ * towards zero) and added to the stereo output with saturation, exactly
+ * like clampedAdd() does.
+ */
+typedef void (*RateMixFunc)(st_sample_t *obuf, const st_sample_t *src, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r);
+
+/**
+ * Returns the mixing kernel for the given channel layout. The vectorized
+ * kernel is picked when the CPU supports it and SIMD mixing is enabled,
+ * otherwise the scalar reference implementation is returned.
+ */
+RateMixFunc getRateMixFunc(bool stereo, bool reverseStereo);
+
+/**
+ * Returns the mixing kernel for converters which copy the samples without
+ * resampling. Like getRateMixFunc(), except that stereo input is always
+ * mixed by the scalar kernel on SSE2, which benchmarks faster there.
+ */
+RateMixFunc getCopyRateMixFunc(bool stereo, bool reverseStereo);
+
+} // End of namespace Audio
+
+#endif
@@ -25,9 +25,11 @@
 #if defined(SDL_BACKEND)
 
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
 #include "backends/events/sdl/sdl-events.h"
 #include "backends/platform/sdl/sdl.h"
 #include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/mutex.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
@@ -134,7 +136,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_currentShakePos(0), _newShakePos(0),
 	_paletteDirtyStart(0), _paletteDirtyEnd(0),
 	_screenIsLocked(false),
-	_graphicsMutex(0),
+	_graphicsMutex(0), _scalerPool(0),
 #ifdef USE_SDL_DEBUG_FOCUSRECT
 	_enableFocusRectDebugCode(false), _enableFocusRect(false), _focusRect(),
 #endif
@@ -158,6 +160,11 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 
 	_graphicsMutex = g_system->createMutex();
 
+	if (ConfMan.hasKey("scaler_threads") && ConfMan.getInt("scaler_threads") > 1) {
+		_scalerPool = new SdlScalerPool(ConfMan.getInt("scaler_threads"));
+		debug(1, "Scaling with %d threads", _scalerPool->getThreadCount());
+	}
+
 #ifdef USE_SDL_DEBUG_FOCUSRECT
 	if (ConfMan.hasKey("use_sdl_debug_focusrect"))
 		_enableFocusRectDebugCode = ConfMan.getBool("use_sdl_debug_focusrect");
@@ -203,6 +210,7 @@ SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 		SDL_FreeSurface(_mouseOrigSurface);
 	_mouseOrigSurface = 0;
 	g_system->deleteMutex(_graphicsMutex);
+	delete _scalerPool;
 
 	free(_currentPalette);
 	free(_cursorPalette);
@@ -1050,6 +1058,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		uint32 srcPitch, dstPitch;
 		SDL_Rect *lastRect = _dirtyRectList + _numDirtyRects;
 
+		_dirtyRectStats = DirtyRectStats();
+
 		for (r = _dirtyRectList; r != lastRect; ++r) {
 			dst = *r;
 			dst.x++;	// Shift rect by one since 2xSai needs to access the data around
@@ -1083,8 +1093,22 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				ScalerJob job;
+				job.proc = scalerProc;
+				job.srcPtr = (byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch;
+				job.srcPitch = srcPitch;
+				job.dstPtr = (byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch;
+				job.dstPitch = dstPitch;
+				job.width = r->w;
+				job.height = dst_h;
+
+				if (_scalerPool)
+					_scalerPool->run(job, scale1);
+				else
+					job.run();
+
+				_dirtyRectStats.rectsScaled++;
+				_dirtyRectStats.pixelsScaled += r->w * dst_h;
 			}
 
 			r->x = rx1;
@@ -1189,6 +1213,14 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 
 		// Finally, blit all our changes to the screen
 		SDL_UpdateRects(_hwscreen, _numDirtyRects, _dirtyRectList);
+
+		_dirtyRectStats.rectsUploaded = _numDirtyRects;
+		for (r = _dirtyRectList; r != _dirtyRectList + _numDirtyRects; ++r)
+			_dirtyRectStats.pixelsUploaded += r->w * r->h;
+
+		debug(9, "SurfaceSdlGraphicsManager: scaled %d pixels in %d rects, uploaded %d pixels in %d rects",
+			_dirtyRectStats.pixelsScaled, _dirtyRectStats.rectsScaled,
+			_dirtyRectStats.pixelsUploaded, _dirtyRectStats.rectsUploaded);
 	}
 
 	_numDirtyRects = 0;
@@ -1334,11 +1366,6 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	if (_forceFull)
 		return;
 
-	if (_numDirtyRects == NUM_DIRTY_RECT) {
-		_forceFull = true;
-		return;
-	}
-
 	int height, width;
 
 	if (!_overlayVisible && !realCoordinates) {
@@ -1389,12 +1416,145 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	}
 
 	if (w > 0 && h > 0) {
-		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
+		SDL_Rect r;
+
+		r.x = x;
+		r.y = y;
+		r.w = w;
+		r.h = h;
 
-		r->x = x;
-		r->y = y;
-		r->w = w;
-		r->h = h;
+		// Rects which still have to be stretched must keep the line
+		// alignment makeRectStretchable() gave them, so don't split those.
+		mergeDirtyRect(r, !(_videoMode.aspectRatioCorrection && !_overlayVisible && !realCoordinates));
+	}
+}
+
+/**
+ * The cost of handling one more dirty rect (scaler setup, blitting and
+ * uploading overhead), expressed in pixels. Two rects get merged into their
+ * bounding box whenever that adds fewer extra pixels than this.
+ */
+#define DIRTY_RECT_COST 1024
+
+static inline int rectArea(const SDL_Rect &r) {
+	return r.w * r.h;
+}
+
+static inline bool rectContains(const SDL_Rect &outer, const SDL_Rect &inner) {
+	return inner.x >= outer.x && inner.y >= outer.y &&
+		inner.x + inner.w <= outer.x + outer.w && inner.y + inner.h <= outer.y + outer.h;
+}
+
+static inline int rectIntersectionArea(const SDL_Rect &a, const SDL_Rect &b) {
+	const int w = MIN(a.x + a.w, b.x + b.w) - MAX(a.x, b.x);
+	const int h = MIN(a.y + a.h, b.y + b.h) - MAX(a.y, b.y);
+	return (w > 0 && h > 0) ? w * h : 0;
+}
+
+static inline SDL_Rect rectUnion(const SDL_Rect &a, const SDL_Rect &b) {
+	SDL_Rect u;
+	u.x = MIN(a.x, b.x);
+	u.y = MIN(a.y, b.y);
+	u.w = MAX(a.x + a.w, b.x + b.w) - u.x;
+	u.h = MAX(a.y + a.h, b.y + b.h) - u.y;
+	return u;
+}
+
+/** Number of pixels the bounding box of both rects covers in excess of the rects. */
+static inline int rectMergeWaste(const SDL_Rect &a, const SDL_Rect &b) {
+	return rectArea(rectUnion(a, b)) - rectArea(a) - rectArea(b) + rectIntersectionArea(a, b);
+}
+
+void SurfaceSdlGraphicsManager::mergeDirtyRect(const SDL_Rect &rect, bool allowSplit) {
+	// Rects (or parts of rects) which still have to be inserted
+	SDL_Rect pending[NUM_DIRTY_RECT * 4];
+	int numPending = 0;
+	pending[numPending++] = rect;
+
+	// Merging always reduces the number of rects, but splitting may keep
+	// producing pieces which get merged again. Only merge after a while, so
+	// that this always terminates.
+	int splitsLeft = NUM_DIRTY_RECT * 2;
+
+	while (numPending > 0) {
+		const SDL_Rect cur = pending[--numPending];
+		bool handled = false;
+
+		for (int i = 0; i < _numDirtyRects && !handled; ++i) {
+			const SDL_Rect e = _dirtyRectList[i];
+
+			if (rectContains(e, cur)) {
+				// Already dirty
+				handled = true;
+			} else if (rectContains(cur, e)) {
+				// Drop the covered rect and check the next one
+				_dirtyRectList[i--] = _dirtyRectList[--_numDirtyRects];
+			} else if (rectMergeWaste(e, cur) <= DIRTY_RECT_COST || (rectIntersectionArea(e, cur) > 0 &&
+			           (!allowSplit || splitsLeft <= 0 || numPending + 4 > (int)ARRAYSIZE(pending)))) {
+				// Replace both by their bounding box, which may in turn
+				// overlap other rects, so it is inserted from scratch.
+				_dirtyRectList[i] = _dirtyRectList[--_numDirtyRects];
+				pending[numPending++] = rectUnion(e, cur);
+				handled = true;
+			} else if (rectIntersectionArea(e, cur) > 0) {
+				// Only keep the parts of cur outside of e: full width bands
+				// above and below e, and the parts left and right of it.
+				const int top = MAX(cur.y, e.y);
+				const int bottom = MIN(cur.y + cur.h, e.y + e.h);
+				SDL_Rect part;
+
+				if (cur.y < e.y) {
+					part = cur;
+					part.h = e.y - cur.y;
+					pending[numPending++] = part;
+				}
+				if (cur.y + cur.h > e.y + e.h) {
+					part = cur;
+					part.y = e.y + e.h;
+					part.h = cur.y + cur.h - part.y;
+					pending[numPending++] = part;
+				}
+				if (cur.x < e.x) {
+					part.x = cur.x;
+					part.y = top;
+					part.w = e.x - cur.x;
+					part.h = bottom - top;
+					pending[numPending++] = part;
+				}
+				if (cur.x + cur.w > e.x + e.w) {
+					part.x = e.x + e.w;
+					part.y = top;
+					part.w = cur.x + cur.w - part.x;
+					part.h = bottom - top;
+					pending[numPending++] = part;
+				}
+
+				splitsLeft--;
+				handled = true;
+			}
+		}
+
+		if (handled)
+			continue;
+
+		if (_numDirtyRects < NUM_DIRTY_RECT) {
+			_dirtyRectList[_numDirtyRects++] = cur;
+		} else {
+			// The list is full, so merge with the rect where this wastes
+			// the fewest pixels.
+			int best = 0;
+			int bestWaste = rectMergeWaste(_dirtyRectList[0], cur);
+			for (int i = 1; i < _numDirtyRects; ++i) {
+				const int waste = rectMergeWaste(_dirtyRectList[i], cur);
+				if (waste < bestWaste) {
+					best = i;
+					bestWaste = waste;
+				}
+			}
+
+			pending[numPending++] = rectUnion(_dirtyRectList[best], cur);
+			_dirtyRectList[best] = _dirtyRectList[--_numDirtyRects];
+		}
 	}
 }
 
@@ -59,6 +59,7 @@ enum {
 	GFX_DOTMATRIX = 11
 };
 
+class SdlScalerPool;
 
 class AspectRatio {
 	int _kw, _kh;
@@ -105,6 +106,24 @@ public:
 	virtual int16 getHeight();
 	virtual int16 getWidth();
 
+	/**
+	 * Per frame statistics of the dirty rect handling. They are gathered by
+	 * internUpdateScreen() and describe the last frame which was drawn.
+	 */
+	struct DirtyRectStats {
+		DirtyRectStats() : rectsScaled(0), pixelsScaled(0), rectsUploaded(0), pixelsUploaded(0) {}
+
+		/** Number of rects and source pixels passed to the scaler */
+		uint32 rectsScaled, pixelsScaled;
+		/** Number of rects and screen pixels passed to SDL_UpdateRects() */
+		uint32 rectsUploaded, pixelsUploaded;
+	};
+
+	/**
+	 * Returns the dirty rect statistics of the last drawn frame.
+	 */
+	const DirtyRectStats &getDirtyRectStats() const { return _dirtyRectStats; }
+
 protected:
 	// PaletteManager API
 	virtual void setPalette(const byte *colors, uint start, uint num);
@@ -246,6 +265,8 @@ protected:
 	SDL_Rect _dirtyRectList[NUM_DIRTY_RECT];
 	int _numDirtyRects;
 
+	DirtyRectStats _dirtyRectStats;
+
 	struct MousePos {
 		// The mouse position, using either virtual (game) or real
 		// (overlay) coordinates.
@@ -306,6 +327,9 @@ protected:
 	 */
 	OSystem::MutexRef _graphicsMutex;
 
+	/** Runs the scalers on several threads, 0 when scaling serially */
+	SdlScalerPool *_scalerPool;
+
 #ifdef USE_SDL_DEBUG_FOCUSRECT
 	bool _enableFocusRectDebugCode;
 	bool _enableFocusRect;
@@ -314,6 +338,16 @@ protected:
 
 	virtual void addDirtyRect(int x, int y, int w, int h, bool realCoordinates = false);
 
+	/**
+	 * Inserts an already clipped rect into the dirty rect list, keeping the
+	 * list free of overlaps. Rects are merged with their neighbors when the
+	 * bounding box wastes fewer pixels than handling an extra rect costs.
+	 * Overlapping rects which are not worth merging are split, unless
+	 * allowSplit is false, which is required for rects that still have to go
+	 * through the aspect ratio stretcher.
+	 */
+	void mergeDirtyRect(const SDL_Rect &rect, bool allowSplit);
+
 	virtual void drawMouse();
 	virtual void undrawMouse();
 	virtual void blitCursor();
@@ -0,0 +1,73 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
+#include "common/util.h"
+#include "common/worker.h"
+
+SdlScalerPool::SdlScalerPool(int numThreads) : _numWorkers(0) {
+	numThreads = CLIP<int>(numThreads, 1, kMaxThreads);
+	for (int i = 0; i < numThreads - 1; ++i) {
+		Common::Worker *worker = new Common::Worker();
+		if (!worker->isThreaded()) {
+			delete worker;
+			break;
+		}
+		_workers[_numWorkers++] = worker;
+	}
+}
+
+SdlScalerPool::~SdlScalerPool() {
+	for (int i = 0; i < _numWorkers; ++i)
+		delete _workers[i];
+}
+
+void SdlScalerPool::run(const ScalerJob &job, int scaleFactor) {
+	if (_numWorkers == 0 || !isScalerReentrant(job.proc)) {
+		job.run();
+		return;
+	}
+
+	const int numBands = splitScalerJob(job, scaleFactor, _numWorkers + 1, kMinBandHeight, _bands);
+
+	// Bands never overlap in the destination, so they can be scaled at the
+	// same time. The calling thread scales the first one.
+	for (int i = 1; i < numBands; ++i)
+		_workers[i - 1]->start(runBand, &_bands[i]);
+
+	_bands[0].run();
+
+	for (int i = 1; i < numBands; ++i)
+		_workers[i - 1]->wait();
+}
+
+void SdlScalerPool::runBand(void *arg) {
+	const ScalerJob *band = (const ScalerJob *)arg;
+	assert(band);
+	band->run();
+}
+
+#endif
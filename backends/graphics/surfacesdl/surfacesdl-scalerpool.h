@@ -0,0 +1,73 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+#define BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+
+#include "graphics/scaler.h"
+
+namespace Common {
+class Worker;
+}
+
+/**
+ * A small pool of worker threads which runs scalers on several horizontal
+ * bands of a dirty rect at the same time. See splitScalerJob() for how the
+ * work is divided; the output is identical to a serial scaler call. The
+ * threads are the backend's worker threads (see Common::Worker).
+ *
+ * The calling thread processes a band as well, and run() only returns once
+ * all bands are done, so callers can treat it like a plain scaler call.
+ */
+class SdlScalerPool {
+public:
+	enum {
+		kMaxThreads = 8,
+		/** Rects lower than twice this many lines are scaled serially */
+		kMinBandHeight = 16
+	};
+
+	/**
+	 * Creates a pool using numThreads threads in total, including the
+	 * calling thread.
+	 */
+	explicit SdlScalerPool(int numThreads);
+	~SdlScalerPool();
+
+	int getThreadCount() const { return _numWorkers + 1; }
+
+	/**
+	 * Runs the given scaler job, split over the pool threads if the
+	 * scaler allows it and the job is large enough.
+	 */
+	void run(const ScalerJob &job, int scaleFactor);
+
+private:
+	Common::Worker *_workers[kMaxThreads - 1];
+	int _numWorkers;
+
+	ScalerJob _bands[kMaxThreads];
+
+	static void runBand(void *arg);
+};
+
+#endif
@@ -0,0 +1,166 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/mixer/lookaheadsdl/lookaheadsdl-mixer.h"
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/util.h"
+
+LookAheadSDLMixerManager::LookAheadSDLMixerManager()
+	:
+	_soundMutex(0), _soundCond(0), _soundThread(0),
+	_soundThreadIsRunning(false), _soundThreadShouldQuit(false),
+	_numBuffers(0), _soundBufSize(0), _readBuffer(0), _filledBuffers(0),
+	_underruns(0), _buffersMixed(0) {
+
+	for (int i = 0; i < kMaxBuffers; i++)
+		_soundBuffers[i] = 0;
+}
+
+LookAheadSDLMixerManager::~LookAheadSDLMixerManager() {
+	deinitThreadedMixer();
+}
+
+void LookAheadSDLMixerManager::startAudio() {
+	_soundThreadIsRunning = false;
+	_soundThreadShouldQuit = false;
+
+	_numBuffers = CLIP<int>(ConfMan.getInt("audio_lookahead_buffers"), kMinBuffers, kMaxBuffers);
+
+	// Create mutex and condition variable
+	_soundMutex = SDL_CreateMutex();
+	_soundCond = SDL_CreateCond();
+
+	// Create the sound buffers
+	_soundBufSize = _obtained.samples * 4;
+	for (uint i = 0; i < _numBuffers; i++)
+		_soundBuffers[i] = (byte *)calloc(1, _soundBufSize);
+
+	_readBuffer = 0;
+	_filledBuffers = 0;
+	_underruns = 0;
+	_buffersMixed = 0;
+
+	debug(1, "Mixing %d buffers ahead of the audio callback", _numBuffers);
+
+	_soundThreadIsRunning = true;
+
+	// Start the thread, it immediately fills the whole ring
+	_soundThread = SDL_CreateThread(mixerProducerThreadEntry, this);
+
+	SdlMixerManager::startAudio();
+}
+
+void LookAheadSDLMixerManager::mixerProducerThread() {
+	SDL_LockMutex(_soundMutex);
+	while (true) {
+		// Wait till there is a free buffer to produce data into
+		while (_filledBuffers == _numBuffers && !_soundThreadShouldQuit)
+			SDL_CondWait(_soundCond, _soundMutex);
+
+		if (_soundThreadShouldQuit)
+			break;
+
+		const uint nextSoundBuffer = (_readBuffer + _filledBuffers) % _numBuffers;
+
+		// The callback never touches buffers which have not been filled yet,
+		// so we can mix without holding the lock.
+		SDL_UnlockMutex(_soundMutex);
+		_mixer->mixCallback(_soundBuffers[nextSoundBuffer], _soundBufSize);
+		SDL_LockMutex(_soundMutex);
+
+		_filledBuffers++;
+		_buffersMixed++;
+	}
+	SDL_UnlockMutex(_soundMutex);
+}
+
+int SDLCALL LookAheadSDLMixerManager::mixerProducerThreadEntry(void *arg) {
+	LookAheadSDLMixerManager *mixer = (LookAheadSDLMixerManager *)arg;
+	assert(mixer);
+	mixer->mixerProducerThread();
+	return 0;
+}
+
+void LookAheadSDLMixerManager::deinitThreadedMixer() {
+	if (_soundThreadIsRunning) {
+		// Stop the audio callback first, it uses the state freed below.
+		// SDL_CloseAudio() waits for a running callback to return.
+		SDL_CloseAudio();
+
+		// Signal the producer thread to end, and wait for it to actually finish.
+		SDL_LockMutex(_soundMutex);
+		_soundThreadShouldQuit = true;
+		SDL_CondBroadcast(_soundCond);
+		SDL_UnlockMutex(_soundMutex);
+		SDL_WaitThread(_soundThread, NULL);
+
+		// Kill the mutex & cond variables.
+		SDL_DestroyMutex(_soundMutex);
+		SDL_DestroyCond(_soundCond);
+
+		_soundThreadIsRunning = false;
+
+		debug(1, "Audio look-ahead: %d buffers mixed, %d underruns", _buffersMixed, _underruns);
+
+		for (uint i = 0; i < _numBuffers; i++) {
+			free(_soundBuffers[i]);
+			_soundBuffers[i] = 0;
+		}
+	}
+}
+
+void LookAheadSDLMixerManager::callbackHandler(byte *samples, int len) {
+	assert(_mixer);
+	assert((int)_soundBufSize == len);
+
+	SDL_LockMutex(_soundMutex);
+	const bool ready = (_filledBuffers > 0);
+	const uint readBuffer = _readBuffer;
+	SDL_UnlockMutex(_soundMutex);
+
+	if (!ready) {
+		// The producer thread could not keep up; play silence rather than
+		// waiting for it.
+		memset(samples, 0, len);
+		_underruns++;
+		debug(5, "Audio look-ahead underrun (%d so far)", _underruns);
+		return;
+	}
+
+	// The producer thread never writes into a filled buffer, so the
+	// data can be copied without holding the lock.
+	memcpy(samples, _soundBuffers[readBuffer], len);
+
+	// Release the buffer and wake up the producer thread
+	SDL_LockMutex(_soundMutex);
+	_readBuffer = (_readBuffer + 1) % _numBuffers;
+	_filledBuffers--;
+	SDL_UnlockMutex(_soundMutex);
+	SDL_CondSignal(_soundCond);
+}
+
+#endif
@@ -0,0 +1,103 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_MIXER_LOOKAHEADSDL_H
+#define BACKENDS_MIXER_LOOKAHEADSDL_H
+
+#include "backends/mixer/sdl/sdl-mixer.h"
+
+/**
+ * SDL mixer manager which mixes ahead of the SDL audio callback.
+ *
+ * A producer thread keeps a ring of mixed buffers filled, so expensive
+ * sound sources (e.g. the MT-32 emulator or FluidSynth) have several
+ * buffers worth of time to produce their data. The SDL callback only
+ * copies the oldest buffer. Should the ring run empty, silence is played
+ * and the underrun is counted.
+ *
+ * The ring depth is taken from the "audio_lookahead_buffers" config key,
+ * which OSystem_SDL requires to be set before using this mixer manager.
+ */
+class LookAheadSDLMixerManager : public SdlMixerManager {
+public:
+	enum {
+		kMinBuffers = 2,
+		kMaxBuffers = 16
+	};
+
+	LookAheadSDLMixerManager();
+	virtual ~LookAheadSDLMixerManager();
+
+	/**
+	 * Returns how often the SDL callback found no mixed buffer ready.
+	 */
+	uint32 getUnderrunCount() const { return _underruns; }
+
+	/**
+	 * Returns how many buffers have been mixed by the producer thread.
+	 */
+	uint32 getMixedBufferCount() const { return _buffersMixed; }
+
+	/**
+	 * Returns the number of buffers in the look-ahead ring.
+	 */
+	uint getBufferCount() const { return _numBuffers; }
+
+protected:
+	SDL_mutex *_soundMutex;
+	SDL_cond *_soundCond;
+	SDL_Thread *_soundThread;
+	bool _soundThreadIsRunning;
+	bool _soundThreadShouldQuit;
+
+	uint _numBuffers;
+	uint _soundBufSize;
+	byte *_soundBuffers[kMaxBuffers];
+
+	/** Index of the next buffer to be played by the SDL callback */
+	uint _readBuffer;
+	/** Number of mixed buffers waiting to be played */
+	uint _filledBuffers;
+
+	uint32 _underruns;
+	uint32 _buffersMixed;
+
+	/**
+	 * Keeps the ring of sound buffers filled
+	 */
+	void mixerProducerThread();
+
+	/**
+	 * Finish the mixer manager
+	 */
+	void deinitThreadedMixer();
+
+	/**
+	 * Callback entry point for the sound thread
+	 */
+	static int SDLCALL mixerProducerThreadEntry(void *arg);
+
+	virtual void startAudio();
+	virtual void callbackHandler(byte *samples, int len);
+};
+
+#endif
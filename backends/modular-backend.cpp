@@ -26,6 +26,7 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/mutex/mutex.h"
+#include "backends/worker/worker.h"
 
 #include "audio/mixer.h"
 #include "graphics/pixelformat.h"
@@ -33,6 +34,7 @@
 ModularBackend::ModularBackend()
 	:
 	_mutexManager(0),
+	_workerManager(0),
 	_graphicsManager(0),
 	_mixer(0) {
 
@@ -43,6 +45,8 @@ ModularBackend::~ModularBackend() {
 	_graphicsManager = 0;
 	delete _mixer;
 	_mixer = 0;
+	delete _workerManager;
+	_workerManager = 0;
 	delete _mutexManager;
 	_mutexManager = 0;
 }
@@ -223,6 +227,28 @@ void ModularBackend::deleteMutex(MutexRef mutex) {
 	_mutexManager->deleteMutex(mutex);
 }
 
+OSystem::WorkerRef ModularBackend::createWorker() {
+	// Backends without a worker manager run all work on the calling thread
+	if (!_workerManager)
+		return 0;
+	return _workerManager->createWorker();
+}
+
+void ModularBackend::startWorker(WorkerRef worker, WorkerProc proc, void *arg) {
+	assert(_workerManager);
+	_workerManager->startWorker(worker, proc, arg);
+}
+
+void ModularBackend::waitWorker(WorkerRef worker) {
+	assert(_workerManager);
+	_workerManager->waitWorker(worker);
+}
+
+void ModularBackend::deleteWorker(WorkerRef worker) {
+	assert(_workerManager);
+	_workerManager->deleteWorker(worker);
+}
+
 Audio::Mixer *ModularBackend::getMixer() {
 	assert(_mixer);
 	return (Audio::Mixer *)_mixer;
@@ -27,6 +27,7 @@
 
 class GraphicsManager;
 class MutexManager;
+class WorkerManager;
 
 /**
  * Base class for modular backends.
@@ -115,6 +116,16 @@ public:
 
 	//@}
 
+	/** @name Worker threads */
+	//@{
+
+	virtual WorkerRef createWorker();
+	virtual void startWorker(WorkerRef worker, WorkerProc proc, void *arg);
+	virtual void waitWorker(WorkerRef worker);
+	virtual void deleteWorker(WorkerRef worker);
+
+	//@}
+
 	/** @name Sound */
 	//@{
 
@@ -135,6 +146,7 @@ protected:
 	//@{
 
 	MutexManager *_mutexManager;
+	WorkerManager *_workerManager;
 	GraphicsManager *_graphicsManager;
 	Audio::Mixer *_mixer;
 
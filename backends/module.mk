@@ -65,11 +65,14 @@ MODULE_OBJS += \
 	events/sdl/sdl-events.o \
 	graphics/sdl/sdl-graphics.o \
 	graphics/surfacesdl/surfacesdl-graphics.o \
+	graphics/surfacesdl/surfacesdl-scalerpool.o \
 	mixer/doublebuffersdl/doublebuffersdl-mixer.o \
+	mixer/lookaheadsdl/lookaheadsdl-mixer.o \
 	mixer/sdl/sdl-mixer.o \
 	mutex/sdl/sdl-mutex.o \
 	plugins/sdl/sdl-provider.o \
-	timer/sdl/sdl-timer.o
+	timer/sdl/sdl-timer.o \
+	worker/sdl/sdl-worker.o
 	
 # SDL 1.3 removed audio CD support
 ifndef USE_SDL13
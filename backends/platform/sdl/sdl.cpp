@@ -44,8 +44,10 @@
 #endif
 
 #include "backends/events/sdl/sdl-events.h"
+#include "backends/mixer/lookaheadsdl/lookaheadsdl-mixer.h"
 #include "backends/mutex/sdl/sdl-mutex.h"
 #include "backends/timer/sdl/sdl-timer.h"
+#include "backends/worker/sdl/sdl-worker.h"
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
 #ifdef USE_OPENGL
 #include "backends/graphics/openglsdl/openglsdl-graphics.h"
@@ -99,6 +101,8 @@ OSystem_SDL::~OSystem_SDL() {
 	_mixerManager = 0;
 	delete _timerManager;
 	_timerManager = 0;
+	delete _workerManager;
+	_workerManager = 0;
 	delete _mutexManager;
 	_mutexManager = 0;
 
@@ -131,6 +135,9 @@ void OSystem_SDL::init() {
 	if (_mutexManager == 0)
 		_mutexManager = new SdlMutexManager();
 
+	if (_workerManager == 0)
+		_workerManager = new SdlWorkerManager();
+
 	if (_timerManager == 0)
 		_timerManager = new SdlTimerManager();
 
@@ -190,7 +197,11 @@ void OSystem_SDL::initBackend() {
 		_savefileManager = new DefaultSaveFileManager();
 
 	if (_mixerManager == 0) {
-		_mixerManager = new SdlMixerManager();
+		// Mix on a separate thread, ahead of the audio callback, if requested
+		if (ConfMan.hasKey("audio_lookahead_buffers") && ConfMan.getInt("audio_lookahead_buffers") > 0)
+			_mixerManager = new LookAheadSDLMixerManager();
+		else
+			_mixerManager = new SdlMixerManager();
 
 		// Setup and start mixer
 		_mixerManager->init();
@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/worker/sdl/sdl-worker.h"
+#include "backends/platform/sdl/sdl-sys.h"
+#include "common/textconsole.h"
+
+namespace {
+
+struct SdlWorker {
+	SDL_mutex *mutex;
+	SDL_cond *cond;
+	SDL_Thread *thread;
+
+	/** The work to run, 0 when idle */
+	OSystem::WorkerProc proc;
+	void *arg;
+	bool quit;
+};
+
+int SDLCALL workerThreadEntry(void *arg) {
+	SdlWorker *worker = (SdlWorker *)arg;
+	assert(worker);
+
+	SDL_LockMutex(worker->mutex);
+	while (true) {
+		while (!worker->proc && !worker->quit)
+			SDL_CondWait(worker->cond, worker->mutex);
+
+		if (!worker->proc)
+			break;
+
+		OSystem::WorkerProc proc = worker->proc;
+		void *procArg = worker->arg;
+
+		SDL_UnlockMutex(worker->mutex);
+		proc(procArg);
+		SDL_LockMutex(worker->mutex);
+
+		worker->proc = 0;
+		SDL_CondBroadcast(worker->cond);
+	}
+	SDL_UnlockMutex(worker->mutex);
+
+	return 0;
+}
+
+} // End of anonymous namespace
+
+OSystem::WorkerRef SdlWorkerManager::createWorker() {
+	SdlWorker *worker = new SdlWorker();
+	worker->mutex = SDL_CreateMutex();
+	worker->cond = SDL_CreateCond();
+	worker->proc = 0;
+	worker->arg = 0;
+	worker->quit = false;
+
+	worker->thread = SDL_CreateThread(workerThreadEntry, worker);
+	if (!worker->thread) {
+		warning("Could not create worker thread: %s", SDL_GetError());
+		SDL_DestroyCond(worker->cond);
+		SDL_DestroyMutex(worker->mutex);
+		delete worker;
+		return 0;
+	}
+
+	return (OSystem::WorkerRef)worker;
+}
+
+void SdlWorkerManager::startWorker(OSystem::WorkerRef ref, OSystem::WorkerProc proc, void *arg) {
+	SdlWorker *worker = (SdlWorker *)ref;
+
+	SDL_LockMutex(worker->mutex);
+	assert(!worker->proc);
+	worker->proc = proc;
+	worker->arg = arg;
+	SDL_CondBroadcast(worker->cond);
+	SDL_UnlockMutex(worker->mutex);
+}
+
+void SdlWorkerManager::waitWorker(OSystem::WorkerRef ref) {
+	SdlWorker *worker = (SdlWorker *)ref;
+
+	SDL_LockMutex(worker->mutex);
+	while (worker->proc)
+		SDL_CondWait(worker->cond, worker->mutex);
+	SDL_UnlockMutex(worker->mutex);
+}
+
+void SdlWorkerManager::deleteWorker(OSystem::WorkerRef ref) {
+	SdlWorker *worker = (SdlWorker *)ref;
+
+	// The thread finishes its work before quitting
+	SDL_LockMutex(worker->mutex);
+	worker->quit = true;
+	SDL_CondBroadcast(worker->cond);
+	SDL_UnlockMutex(worker->mutex);
+
+	SDL_WaitThread(worker->thread, NULL);
+
+	SDL_DestroyCond(worker->cond);
+	SDL_DestroyMutex(worker->mutex);
+	delete worker;
+}
+
+#endif
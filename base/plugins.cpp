@@ -445,6 +445,7 @@ void PluginManager::addToPluginsInMemList(Plugin *plugin) {
 // Engine plugins
 
 #include "engines/metaengine.h"
+#include "engines/advancedDetector.h"
 
 namespace Common {
 DECLARE_SINGLETON(EngineManager);
@@ -518,6 +519,11 @@ GameList EngineManager::detectGames(const Common::FSList &fslist) const {
 	GameList candidates;
 	EnginePlugin::List plugins;
 	EnginePlugin::List::const_iterator iter;
+
+	// Many engines check the same files, so let them share the MD5s
+	// computed by the advanced detector for this directory
+	AdvancedMetaEngine::enableFilePropertiesCache(true);
+
 	PluginManager::instance().loadFirstPlugin();
 	do {
 		plugins = getPlugins();
@@ -527,6 +533,8 @@ GameList EngineManager::detectGames(const Common::FSList &fslist) const {
 			candidates.push_back((**iter)->detectGames(fslist));
 		}
 	} while (PluginManager::instance().loadNextPlugin());
+
+	AdvancedMetaEngine::enableFilePropertiesCache(false);
 	return candidates;
 }
 
@@ -28,6 +28,9 @@
 #include "common/scummsys.h"
 #include "common/textconsole.h"
 #include "common/stream.h"
+#include "common/memstream.h"
+#include "common/endian.h"
+#include "common/util.h"
 
 namespace Common {
 
@@ -61,12 +64,18 @@ public:
 	/** Read a bit from the bit stream, without changing the stream's position. */
 	virtual uint32 peekBit() = 0;
 
-	/** Read a multi-bit value from the bit stream, without changing the stream's position. */
+	/**
+	 * Read a multi-bit value from the bit stream, without changing the stream's position.
+	 * Bits past the end of the stream are read as 0.
+	 */
 	virtual uint32 peekBits(uint8 n) = 0;
 
 	/** Add a bit to the value x, making it an n+1-bit value. */
 	virtual void addBit(uint32 &x, uint32 n) = 0;
 
+	/** Are the bits handed out from MSB to LSB? */
+	virtual bool isMSB2LSB() const = 0;
+
 protected:
 	BitStream() {
 	}
@@ -79,69 +88,143 @@ protected:
  * gives access to their bits, one at a time.
  *
  * For example, a bit stream with the layout parameters 32, true, false
- * for valueBits, isLE and isMSB2LSB, reads 32bit little-endian values
+ * for valueBits, isLE and MSB2LSB, reads 32bit little-endian values
  * from the data stream and hands out the bits in the order of LSB to MSB.
+ *
+ * The values are read ahead into a 64-bit cache, so that most reads,
+ * peeks and skips of up to 32 bits only shift the cache. A bit stream
+ * created on a MemoryReadStream reads the values directly from its
+ * memory, and leaves the position of the MemoryReadStream alone.
  */
-template<int valueBits, bool isLE, bool isMSB2LSB>
+template<int valueBits, bool isLE, bool MSB2LSB>
 class BitStreamImpl : public BitStream {
 private:
+	static const uint32 kValueBytes = valueBits / 8;
+
 	SeekableReadStream *_stream; ///< The input stream.
 	bool _disposeAfterUse;       ///< Should we delete the stream on destruction?
 
-	uint32 _value;   ///< Current value.
-	uint8  _inValue; ///< Position within the current value.
+	const byte *_data; ///< The memory of a MemoryReadStream, or 0.
+
+	uint32 _size;   ///< The size of the input stream, in whole values, in bytes.
+	uint32 _offset; ///< Offset of the next value to read into the cache, in bytes.
+
+	/**
+	 * The bits read ahead. The next bit is the MSB of the cache for MSB2LSB
+	 * streams, or the LSB of the cache otherwise. All other bits are 0.
+	 */
+	uint64 _cache;
+	uint8  _cacheBits; ///< The number of bits in the cache.
 
 	/** Read a data value. */
 	inline uint32 readData() {
+		if (_data) {
+			const byte *data = _data + _offset;
+			_offset += kValueBytes;
+
+			if (valueBits == 8)
+				return *data;
+			if (valueBits == 16)
+				return isLE ? READ_LE_UINT16(data) : READ_BE_UINT16(data);
+			if (valueBits == 32)
+				return isLE ? READ_LE_UINT32(data) : READ_BE_UINT32(data);
+		}
+
+		_offset += kValueBytes;
+
+		uint32 value = 0;
 		if (isLE) {
 			if (valueBits ==  8)
-				return _stream->readByte();
+				value = _stream->readByte();
 			if (valueBits == 16)
-				return _stream->readUint16LE();
+				value = _stream->readUint16LE();
 			if (valueBits == 32)
-				return _stream->readUint32LE();
+				value = _stream->readUint32LE();
 		} else {
 			if (valueBits ==  8)
-				return _stream->readByte();
+				value = _stream->readByte();
 			if (valueBits == 16)
-				return _stream->readUint16BE();
+				value = _stream->readUint16BE();
 			if (valueBits == 32)
-				return _stream->readUint32BE();
+				value = _stream->readUint32BE();
 		}
 
-		assert(false);
-		return 0;
+		if (_stream->err() || _stream->eos())
+			error("BitStreamImpl::readData(): Read error");
+
+		return value;
 	}
 
-	/** Read the next data value. */
-	inline void readValue() {
-		if ((size() - pos()) < valueBits)
-			error("BitStreamImpl::readValue(): End of bit stream reached");
+	/** Read as many values into the cache as fit, until the end of the stream. */
+	inline void fillCache() {
+		while (_cacheBits <= 64 - valueBits && _offset + kValueBytes <= _size) {
+			const uint64 value = readData();
 
-		_value = readData();
-		if (_stream->err() || _stream->eos())
-			error("BitStreamImpl::readValue(): Read error");
+			if (MSB2LSB)
+				_cache |= value << (64 - valueBits - _cacheBits);
+			else
+				_cache |= value << _cacheBits;
 
-		// If we're reading the bits MSB first, we need to shift the value to that position
-		if (isMSB2LSB)
-			_value <<= 32 - valueBits;
+			_cacheBits += valueBits;
 		}
+	}
+
+	/** Return the next n bits in the cache, 1 <= n <= 32. */
+	inline uint32 peekCache(uint8 n) const {
+		if (MSB2LSB)
+			return (uint32)(_cache >> (64 - n));
+		else
+			return (uint32)_cache & (0xFFFFFFFF >> (32 - n));
+	}
+
+	/** Remove the next n bits from the cache, n <= _cacheBits and n < 64. */
+	inline void skipCache(uint8 n) {
+		if (MSB2LSB)
+			_cache <<= n;
+		else
+			_cache >>= n;
+
+		_cacheBits -= n;
+	}
+
+	void init() {
+		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32))
+			error("BitStreamImpl: Invalid memory layout %d, %d, %d", valueBits, isLE, MSB2LSB);
+
+		_size   = _stream->size() & ~(kValueBytes - 1);
+		_offset = _stream->pos();
+
+		_cache     = 0;
+		_cacheBits = 0;
+	}
 
 public:
 	/** Create a bit stream using this input data stream and optionally delete it on destruction. */
 	BitStreamImpl(SeekableReadStream *stream, bool disposeAfterUse = false) :
-		_stream(stream), _disposeAfterUse(disposeAfterUse), _value(0), _inValue(0) {
+		_stream(stream), _disposeAfterUse(disposeAfterUse), _data(0) {
 
-		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32))
-			error("BitStreamImpl: Invalid memory layout %d, %d, %d", valueBits, isLE, isMSB2LSB);
+		init();
 	}
 
 	/** Create a bit stream using this input data stream. */
 	BitStreamImpl(SeekableReadStream &stream) :
-		_stream(&stream), _disposeAfterUse(false), _value(0), _inValue(0) {
+		_stream(&stream), _disposeAfterUse(false), _data(0) {
 
-		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32))
-			error("BitStreamImpl: Invalid memory layout %d, %d, %d", valueBits, isLE, isMSB2LSB);
+		init();
+	}
+
+	/** Create a bit stream reading directly from the memory of this stream, and optionally delete it on destruction. */
+	BitStreamImpl(MemoryReadStream *stream, bool disposeAfterUse = false) :
+		_stream(stream), _disposeAfterUse(disposeAfterUse), _data(stream->getData()) {
+
+		init();
+	}
+
+	/** Create a bit stream reading directly from the memory of this stream. */
+	BitStreamImpl(MemoryReadStream &stream) :
+		_stream(&stream), _disposeAfterUse(false), _data(stream.getData()) {
+
+		init();
 	}
 
 	~BitStreamImpl() {
@@ -151,25 +234,14 @@ public:
 
 	/** Read a bit from the bit stream. */
 	uint32 getBit() {
-		// Check if we need the next value
-		if (_inValue == 0)
-			readValue();
-
-		// Get the current bit
-		int b = 0;
-		if (isMSB2LSB)
-			b = ((_value & 0x80000000) == 0) ? 0 : 1;
-		else
-			b = ((_value & 1) == 0) ? 0 : 1;
-
-		// Shift to the next bit
-		if (isMSB2LSB)
-			_value <<= 1;
-		else
-			_value >>= 1;
+		if (_cacheBits == 0) {
+			fillCache();
+			if (_cacheBits == 0)
+				error("BitStreamImpl::getBit(): End of bit stream reached");
+		}
 
-		// Increase the position within the current value
-		_inValue = (_inValue + 1) % valueBits;
+		const uint32 b = peekCache(1);
+		skipCache(1);
 
 		return b;
 	}
@@ -191,54 +263,40 @@ public:
 		if (n > 32)
 			error("BitStreamImpl::getBits(): Too many bits requested to be read");
 
-		// Read the number of bits
-		uint32 v = 0;
-
-		if (isMSB2LSB) {
-			while (n-- > 0)
-				v = (v << 1) | getBit();
-		} else {
-			for (uint32 i = 0; i < n; i++)
-				v = (v >> 1) | (((uint32) getBit()) << 31);
-
-			v >>= (32 - n);
+		if (_cacheBits < n) {
+			fillCache();
+			if (_cacheBits < n)
+				error("BitStreamImpl::getBits(): End of bit stream reached");
 		}
 
+		const uint32 v = peekCache(n);
+		skipCache(n);
+
 		return v;
 	}
 
 	/** Read a bit from the bit stream, without changing the stream's position. */
 	uint32 peekBit() {
-		uint32 value   = _value;
-		uint8  inValue = _inValue;
-		uint32 curPos  = _stream->pos();
-
-		uint32 v = getBit();
-
-		_stream->seek(curPos);
-		_inValue = inValue;
-		_value   = value;
-
-		return v;
+		return peekBits(1);
 	}
 
 	/**
 	 * Read a multi-bit value from the bit stream, without changing the stream's position.
 	 *
-	 * The bit order is the same as in getBits().
+	 * The bit order is the same as in getBits(). Bits past the end of the
+	 * stream are read as 0.
 	 */
 	uint32 peekBits(uint8 n) {
-		uint32 value   = _value;
-		uint8  inValue = _inValue;
-		uint32 curPos  = _stream->pos();
+		if (n == 0)
+			return 0;
 
-		uint32 v = getBits(n);
+		if (n > 32)
+			error("BitStreamImpl::peekBits(): Too many bits requested to be read");
 
-		_stream->seek(curPos);
-		_inValue = inValue;
-		_value   = value;
+		if (_cacheBits < n)
+			fillCache();
 
-		return v;
+		return peekCache(n);
 	}
 
 	/**
@@ -256,7 +314,7 @@ public:
 		if (n >= 32)
 			error("BitStreamImpl::addBit(): Too many bits requested to be read");
 
-		if (isMSB2LSB)
+		if (MSB2LSB)
 			x = (x << 1) | getBit();
 		else
 			x = (x & ~(1 << n)) | (getBit() << n);
@@ -266,32 +324,54 @@ public:
 	void rewind() {
 		_stream->seek(0);
 
-		_value   = 0;
-		_inValue = 0;
+		_offset    = 0;
+		_cache     = 0;
+		_cacheBits = 0;
 	}
 
 	/** Skip the specified amount of bits. */
 	void skip(uint32 n) {
-		while (n-- > 0)
-			getBit();
+		// Skipping a full cache is not done here, shifting the 64 bit cache
+		// by 64 bits is undefined
+		if (n < _cacheBits) {
+			skipCache(n);
+			return;
+		}
+
+		// Drop the cache and skip whole values without reading them
+		n -= _cacheBits;
+		_cache     = 0;
+		_cacheBits = 0;
+
+		const uint32 values = n / valueBits;
+		if (values > 0) {
+			if (_offset + values * kValueBytes > _size)
+				error("BitStreamImpl::skip(): End of bit stream reached");
+
+			_offset += values * kValueBytes;
+			if (!_data)
+				_stream->seek(_offset);
+		}
+
+		getBits(n % valueBits);
 	}
 
 	/** Return the stream position in bits. */
 	uint32 pos() const {
-		if (_stream->pos() == 0)
-			return 0;
-
-		uint32 p = (_inValue == 0) ? _stream->pos() : ((_stream->pos() - 1) & ~((uint32) ((valueBits >> 3) - 1)));
-		return p * 8 + _inValue;
+		return _offset * 8 - _cacheBits;
 	}
 
 	/** Return the stream size in bits. */
 	uint32 size() const {
-		return (_stream->size() & ~((uint32) ((valueBits >> 3) - 1))) * 8;
+		return _size * 8;
 	}
 
 	bool eos() const {
-		return _stream->eos() || (pos() >= size());
+		return pos() >= size();
+	}
+
+	bool isMSB2LSB() const {
+		return MSB2LSB;
 	}
 };
 
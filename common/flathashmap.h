@@ -0,0 +1,466 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_FLATHASHMAP_H
+#define COMMON_FLATHASHMAP_H
+
+#include "common/func.h"
+
+namespace Common {
+
+/**
+ * FlatHashMap<Key,Val> is a drop-in replacement for the commonly used subset
+ * of HashMap<Key,Val>. Unlike HashMap, which keeps a table of pointers to
+ * separately allocated nodes, it stores the key/value pairs directly in its
+ * table and resolves collisions by linear probing. Lookups thus touch a
+ * single, contiguous run of memory, which makes it the better choice for
+ * small keys and values looked up on hot paths.
+ *
+ * Erased entries do not leave tombstones behind; instead, the following
+ * entries of the probe run are shifted back. The price for this is that
+ * erasing an entry invalidates all iterators, so unlike with HashMap, one
+ * cannot erase entries while iterating over the map. Adding new keys
+ * invalidates iterators as well.
+ *
+ * Hash and equality functors follow the same rules as for HashMap. The hash
+ * value is scrambled before use, so the trivial hash functions used for
+ * integer keys work well.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+	struct Node {
+		Key _key;
+		Val _value;
+		Node() : _key(), _value() {}
+	};
+
+private:
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> FHM_t;
+
+	enum {
+		FLATHASHMAP_MIN_CAPACITY = 16,
+
+		// The quotient of the next two constants controls how much the
+		// table may fill up before being grown. Linear probing degrades
+		// quickly above 3/4.
+		FLATHASHMAP_LOADFACTOR_NUMERATOR = 3,
+		FLATHASHMAP_LOADFACTOR_DENOMINATOR = 4
+	};
+
+	Node *_storage;     ///< hashtable of size _mask + 1
+	byte *_used;        ///< whether the corresponding entry in _storage is in use
+	size_type _mask;    ///< Capacity minus one; the capacity is a power of two
+	uint _shift;        ///< 32 - log2(capacity), used to scramble hash values
+	size_type _size;
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	/** Default value, returned by the const getVal. */
+	const Val _defaultVal;
+
+	size_type bucket(const Key &key) const {
+		// Fibonacci hashing: take the upper bits of the product, so that
+		// all bits of the hash value contribute to the bucket index.
+		return (size_type)(((uint32)_hash(key) * 2654435769U) >> _shift);
+	}
+
+	void allocStorage(size_type capacity);
+	void assign(const FHM_t &map);
+	size_type lookup(const Key &key) const;
+	size_type lookupAndCreateIfMissing(const Key &key);
+	void expandStorage(size_type newCapacity);
+	void eraseAt(size_type ctr);
+
+	/**
+	 * Simple FlatHashMap iterator implementation.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(size_type idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != 0);
+			assert(_idx <= _hashmap->_mask);
+			assert(_hashmap->_used[_idx]);
+			return &_hashmap->_storage[_idx];
+		}
+
+		void skipUnused() {
+			while (_idx <= _hashmap->_mask && !_hashmap->_used[_idx])
+				_idx++;
+			if (_idx > _hashmap->_mask)
+				_idx = (size_type)-1;
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(0) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			_idx++;
+			skipUnused();
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const FHM_t &map);
+	~FlatHashMap();
+
+	FHM_t &operator=(const FHM_t &map) {
+		if (this == &map)
+			return *this;
+
+		delete[] _storage;
+		delete[] _used;
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const;
+
+	Val &operator[](const Key &key);
+	const Val &operator[](const Key &key) const;
+
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getVal(const Key &key, const Val &defaultVal) const;
+	void setVal(const Key &key, const Val &val);
+
+	/**
+	 * Makes sure that at least the given number of elements can be stored
+	 * without the table being grown.
+	 */
+	void reserve(size_type count);
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry);
+	void erase(const Key &key);
+
+	size_type size() const { return _size; }
+
+	iterator	begin() {
+		iterator it(0, this);
+		it.skipUnused();
+		return it;
+	}
+	iterator	end() {
+		return iterator((size_type)-1, this);
+	}
+
+	const_iterator	begin() const {
+		const_iterator it(0, this);
+		it.skipUnused();
+		return it;
+	}
+	const_iterator	end() const {
+		return const_iterator((size_type)-1, this);
+	}
+
+	iterator	find(const Key &key) {
+		size_type ctr = lookup(key);
+		if (_used[ctr])
+			return iterator(ctr, this);
+		return end();
+	}
+
+	const_iterator	find(const Key &key) const {
+		size_type ctr = lookup(key);
+		if (_used[ctr])
+			return const_iterator(ctr, this);
+		return end();
+	}
+
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal() {
+	allocStorage(FLATHASHMAP_MIN_CAPACITY);
+	_size = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const FHM_t &map) : _defaultVal() {
+	assign(map);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	delete[] _storage;
+	delete[] _used;
+}
+
+/**
+ * Internal method for allocating an empty table of the given capacity,
+ * which must be a power of two.
+ *
+ * @note We do *not* deallocate the previous storage here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(size_type capacity) {
+	assert(capacity >= FLATHASHMAP_MIN_CAPACITY && (capacity & (capacity - 1)) == 0);
+
+	_mask = capacity - 1;
+	_shift = 32;
+	for (size_type c = capacity; c > 1; c >>= 1)
+		_shift--;
+
+	_storage = new Node[capacity];
+	_used = new byte[capacity];
+	assert(_storage != NULL && _used != NULL);
+	memset(_used, 0, capacity);
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one.
+ *
+ * @note We do *not* deallocate the previous storage here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const FHM_t &map) {
+	allocStorage(map._mask + 1);
+
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (map._used[ctr]) {
+			_storage[ctr] = map._storage[ctr];
+			_used[ctr] = 1;
+		}
+	}
+	_size = map._size;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	if (shrinkArray && _mask >= FLATHASHMAP_MIN_CAPACITY) {
+		delete[] _storage;
+		delete[] _used;
+		allocStorage(FLATHASHMAP_MIN_CAPACITY);
+	} else {
+		// Reset the values, so they do not keep any resources alive
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (_used[ctr]) {
+				_storage[ctr] = Node();
+				_used[ctr] = 0;
+			}
+		}
+	}
+
+	_size = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::reserve(size_type count) {
+	size_type capacity = _mask + 1;
+	while (count * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+		capacity *= 2;
+
+	if (capacity > _mask + 1)
+		expandStorage(capacity);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(size_type newCapacity) {
+	assert(newCapacity > _mask + 1);
+
+	const size_type old_mask = _mask;
+	Node *old_storage = _storage;
+	byte *old_used = _used;
+
+	allocStorage(newCapacity);
+
+	// rehash all the old elements
+	for (size_type ctr = 0; ctr <= old_mask; ++ctr) {
+		if (!old_used[ctr])
+			continue;
+
+		// Since we know that no key exists twice in the old table, we
+		// can simply take the first free entry without calling _equal().
+		size_type idx = bucket(old_storage[ctr]._key);
+		while (_used[idx])
+			idx = (idx + 1) & _mask;
+
+		_storage[idx] = old_storage[ctr];
+		_used[idx] = 1;
+	}
+
+	delete[] old_storage;
+	delete[] old_used;
+}
+
+/**
+ * Returns the index of the entry holding the given key or, if the key is
+ * not contained, the index of the free entry ending its probe run.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key) const {
+	size_type ctr = bucket(key);
+	while (_used[ctr] && !_equal(_storage[ctr]._key, key))
+		ctr = (ctr + 1) & _mask;
+
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	size_type ctr = lookup(key);
+	if (_used[ctr])
+		return ctr;
+
+	// Keep the load factor below a certain threshold.
+	const size_type capacity = _mask + 1;
+	if ((_size + 1) * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR) {
+		expandStorage(capacity < 500 ? (capacity * 4) : (capacity * 2));
+		ctr = lookup(key);
+		assert(!_used[ctr]);
+	}
+
+	_storage[ctr]._key = key;
+	_used[ctr] = 1;
+	_size++;
+
+	return ctr;
+}
+
+/**
+ * Removes the entry at the given index, and shifts the following entries of
+ * its probe run back, so that lookups never see a gap in the run.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseAt(size_type ctr) {
+	assert(ctr <= _mask && _used[ctr]);
+
+	size_type hole = ctr;
+	for (size_type next = (hole + 1) & _mask; _used[next]; next = (next + 1) & _mask) {
+		// An entry may only be moved into the hole if the hole lies
+		// between its home bucket and its current position (cyclically).
+		const size_type home = bucket(_storage[next]._key);
+		if (((next - home) & _mask) >= ((next - hole) & _mask)) {
+			_storage[hole] = _storage[next];
+			hole = next;
+		}
+	}
+
+	_storage[hole] = Node();
+	_used[hole] = 0;
+	_size--;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
+	return _used[lookup(key)] != 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) const {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	// Note: the lookup may reallocate _storage, so it has to happen first
+	const size_type ctr = lookupAndCreateIfMissing(key);
+	return _storage[ctr]._value;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	return getVal(key, _defaultVal);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key, const Val &defaultVal) const {
+	size_type ctr = lookup(key);
+	if (_used[ctr])
+		return _storage[ctr]._value;
+	else
+		return defaultVal;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	const size_type ctr = lookupAndCreateIfMissing(key);
+	_storage[ctr]._value = val;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	eraseAt(entry._idx);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	size_type ctr = lookup(key);
+	if (_used[ctr])
+		eraseAt(ctr);
+}
+
+}	// End of namespace Common
+
+#endif
@@ -58,6 +58,9 @@ Huffman::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const u
 		// And put the pointer to the symbol/code struct into the symbol list.
 		_symbols[i] = &_codes[lengths[i] - 1].back();
 	}
+
+	_prefixTableBits = MIN<uint8>(maxLength, kPrefixTableBits);
+	buildPrefixTables();
 }
 
 Huffman::~Huffman() {
@@ -66,9 +69,65 @@ Huffman::~Huffman() {
 void Huffman::setSymbols(const uint32 *symbols) {
 	for (uint32 i = 0; i < _symbols.size(); i++)
 		_symbols[i]->symbol = symbols ? *symbols++ : i;
+
+	buildPrefixTables();
+}
+
+void Huffman::buildPrefixTables() {
+	const uint32 tableSize = 1 << _prefixTableBits;
+
+	_prefixTableMSB.resize(tableSize);
+	_prefixTableLSB.resize(tableSize);
+
+	for (uint32 i = 0; i < tableSize; i++) {
+		_prefixTableMSB[i].length = 0;
+		_prefixTableLSB[i].length = 0;
+	}
+
+	// Fill in the shortest codes first, and don't overwrite entries that are
+	// already taken, so that the tables find the same code as getSymbolSlow()
+	for (uint8 length = 1; length <= _prefixTableBits; length++) {
+		const uint32 fillBits = _prefixTableBits - length;
+
+		for (CodeList::const_iterator cCode = _codes[length - 1].begin(); cCode != _codes[length - 1].end(); ++cCode) {
+			// A code with bits set past its length can never be read
+			if (cCode->code >> length)
+				continue;
+
+			// The code is the first bits of the index, followed by all
+			// possible values of the remaining bits
+			for (uint32 fill = 0; fill < (1u << fillBits); fill++) {
+				PrefixEntry &msb = _prefixTableMSB[(cCode->code << fillBits) | fill];
+				if (msb.length == 0) {
+					msb.symbol = cCode->symbol;
+					msb.length = length;
+				}
+
+				PrefixEntry &lsb = _prefixTableLSB[cCode->code | (fill << length)];
+				if (lsb.length == 0) {
+					lsb.symbol = cCode->symbol;
+					lsb.length = length;
+				}
+			}
+		}
+	}
 }
 
 uint32 Huffman::getSymbol(BitStream &bits) const {
+	// Look up the next bits. If the stream ends before, they are padded with
+	// 0 bits. In that case, skip() errors out if the code found is too long.
+	const uint32 prefix = bits.peekBits(_prefixTableBits);
+	const PrefixEntry &entry = bits.isMSB2LSB() ? _prefixTableMSB[prefix] : _prefixTableLSB[prefix];
+
+	if (entry.length > 0) {
+		bits.skip(entry.length);
+		return entry.symbol;
+	}
+
+	return getSymbolSlow(bits);
+}
+
+uint32 Huffman::getSymbolSlow(BitStream &bits) const {
 	uint32 code = 0;
 
 	for (uint32 i = 0; i < _codes.size(); i++) {
@@ -36,6 +36,10 @@ class BitStream;
 /**
  * Huffman bitstream decoding
  *
+ * Codes of up to kPrefixTableBits bits are resolved with a single lookup
+ * into a table indexed by the next bits of the stream. Longer codes are
+ * read bit by bit.
+ *
  * Used in engines:
  *  - scumm
  */
@@ -58,6 +62,9 @@ public:
 	/** Return the next symbol in the bitstream. */
 	uint32 getSymbol(BitStream &bits) const;
 
+	/** The maximal number of bits looked up at once. */
+	static const uint8 kPrefixTableBits = 9;
+
 private:
 	struct Symbol {
 		uint32 code;
@@ -75,6 +82,29 @@ private:
 
 	/** Sorted list of pointers to the symbols. */
 	SymbolList _symbols;
+
+	struct PrefixEntry {
+		uint32 symbol;
+		uint8 length; ///< 0 if the prefix belongs to a longer code, or to no code at all.
+	};
+
+	typedef Array<PrefixEntry> PrefixTable;
+
+	/** Number of bits the prefix tables are indexed with. */
+	uint8 _prefixTableBits;
+
+	/**
+	 * The code and symbol for each value of the next _prefixTableBits bits,
+	 * for bit streams handing out the bits from MSB to LSB and from LSB to MSB.
+	 */
+	PrefixTable _prefixTableMSB;
+	PrefixTable _prefixTableLSB;
+
+	/** Fill the prefix tables from the code lists. */
+	void buildPrefixTables();
+
+	/** Read the next symbol bit by bit. */
+	uint32 getSymbolSlow(BitStream &bits) const;
 };
 
 } // End of namespace Common
@@ -40,6 +40,7 @@ MODULE_OBJS := \
 	winexe.o \
 	winexe_ne.o \
 	winexe_pe.o \
+	worker.o \
 	xmlparser.o \
 	zlib.o
 
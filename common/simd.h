@@ -0,0 +1,82 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_SIMD_H
+#define COMMON_SIMD_H
+
+#include "common/scummsys.h"
+
+/**
+ * @file
+ * Detection of the SIMD instruction sets which kernels can be built for.
+ *
+ * SCUMMVM_SIMD_SSE2 is defined when SSE2 kernels can be built. Functions
+ * using SSE2 intrinsics must be marked with SCUMMVM_SSE2_TARGET. On GCC
+ * this is a function level target attribute, so 32 bit x86 builds must
+ * check Common::hasSSE2() at runtime before calling them.
+ *
+ * SCUMMVM_SIMD_NEON is defined when NEON kernels can be built.
+ */
+
+// GCC_ATLEAST() can't be used here, its use of defined() is not portable
+// in #if expressions.
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define SCUMMVM_GCC_TARGET_ATTRIBUTE
+#endif
+
+#if defined(SCUMMVM_GCC_TARGET_ATTRIBUTE) && (defined(__i386__) || defined(__x86_64__))
+#define SCUMMVM_SIMD_SSE2
+#define SCUMMVM_SSE2_TARGET __attribute__((target("sse2")))
+#include <emmintrin.h>
+#if defined(__i386__)
+#include <cpuid.h>
+#endif
+#elif defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SCUMMVM_SIMD_SSE2
+#define SCUMMVM_SSE2_TARGET
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define SCUMMVM_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef SCUMMVM_SIMD_SSE2
+
+namespace Common {
+
+/** Check whether the CPU supports SSE2. Always true on x86-64. */
+inline bool hasSSE2() {
+#if defined(__i386__) && defined(__GNUC__)
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return false;
+	return (edx & bit_SSE2) != 0;
+#else
+	return true;
+#endif
+}
+
+} // End of namespace Common
+
+#endif
+
+#endif
@@ -1014,6 +1014,50 @@ public:
 
 
 
+	/**
+	 * @name Worker threads
+	 * Backends may offer worker threads, on which ScummVM code can run CPU
+	 * heavy work, like decoding the next video frame, in the background.
+	 * The work must neither call OSystem methods other than the mutex ones
+	 * nor touch any state the engine uses meanwhile.
+	 *
+	 * Worker threads are optional. Backends which do not offer them keep
+	 * the default implementation, where createWorker() returns 0; callers
+	 * then simply do the work themselves (see Common::Worker).
+	 */
+	//@{
+
+	typedef struct OpaqueWorker *WorkerRef;
+	typedef void (*WorkerProc)(void *arg);
+
+	/**
+	 * Create a new worker thread.
+	 * @return the newly created worker, or 0 if the backend does not
+	 *         offer worker threads or an error occurred.
+	 */
+	virtual WorkerRef createWorker() { return 0; }
+
+	/**
+	 * Run proc(arg) on the given worker. The worker must be idle, that is
+	 * the previous work must have been waited for with waitWorker().
+	 */
+	virtual void startWorker(WorkerRef worker, WorkerProc proc, void *arg) {}
+
+	/**
+	 * Wait until the work started on the given worker is done. Returns
+	 * right away if the worker is idle.
+	 */
+	virtual void waitWorker(WorkerRef worker) {}
+
+	/**
+	 * Delete the given worker, after waiting for its work to be done.
+	 */
+	virtual void deleteWorker(WorkerRef worker) {}
+
+	//@}
+
+
+
 	/** @name Sound */
 	//@{
 
@@ -105,6 +105,8 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/substream.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -370,6 +372,8 @@ typedef struct {
 	uLong current_file_ok;			/* flag about the usability of the current file*/
 	unz_file_info cur_file_info;					/* public info about the current file in zip*/
 	unz_file_info_internal cur_file_info_internal;	/* private info about it*/
+	uLong offset_data;				/* offset of the file data in the zipfile, 0 until
+									   the local header has been checked */
 } cached_file_in_zip;
 
 typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_Hash,
@@ -379,6 +383,8 @@ typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_H
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _streamRef;	/* owns _stream, shared with
+																   the streams of stored files */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -541,6 +547,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	int err=UNZ_OK;
 
 	us->_stream = stream;
+	us->_streamRef = Common::SharedPtr<Common::SeekableReadStream>(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -592,7 +599,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return NULL;
 	}
@@ -617,6 +623,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		fe.current_file_ok = us->current_file_ok;
 		fe.cur_file_info = us->cur_file_info;
 		fe.cur_file_info_internal = us->cur_file_info_internal;
+		fe.offset_data = 0;
 
 		us->_hash[Common::String(szCurrentFileName)] = fe;
 
@@ -641,7 +648,6 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != NULL)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
 	delete s;
 	return UNZ_OK;
 }
@@ -1450,6 +1456,21 @@ public:
 };
 */
 
+/**
+ * Stream for a stored (uncompressed) file in a zip archive. It reads from the
+ * zipfile stream directly and seeks it before every read, so any number of
+ * these can be used independently. The zipfile stream is kept alive for as
+ * long as any of them exists, even after the archive has been closed.
+ */
+class ZipStoredFileStream : public SafeSeekableSubReadStream {
+	SharedPtr<SeekableReadStream> _zipStream;
+
+public:
+	ZipStoredFileStream(const SharedPtr<SeekableReadStream> &zipStream, uint32 begin, uint32 end)
+		: SafeSeekableSubReadStream(zipStream.get(), begin, end, DisposeAfterUse::NO), _zipStream(zipStream) {
+	}
+};
+
 ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile) {
 	assert(_zipFile);
 }
@@ -1459,7 +1480,8 @@ ZipArchive::~ZipArchive() {
 }
 
 bool ZipArchive::hasFile(const String &name) const {
-	return (unzLocateFile(_zipFile, name.c_str(), 2) == UNZ_OK);
+	const unz_s *const archive = (const unz_s *)_zipFile;
+	return archive->_hash.contains(name);
 }
 
 int ZipArchive::listMembers(ArchiveMemberList &list) const {
@@ -1483,6 +1505,36 @@ const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 }
 
 SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) const {
+	unz_s *const archive = (unz_s *)_zipFile;
+	ZipHash::iterator i = archive->_hash.find(name);
+	if (i == archive->_hash.end())
+		return 0;
+
+	cached_file_in_zip &fe = i->_value;
+	if (fe.cur_file_info.compression_method == 0 &&
+	    fe.cur_file_info.compressed_size == fe.cur_file_info.uncompressed_size) {
+		// Stored files are read straight from the zipfile, there is no need
+		// to copy them into memory first. The local header only needs to be
+		// checked once, afterwards the data offset is known.
+		if (!fe.offset_data) {
+			if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
+				return 0;
+
+			uInt iSizeVar;
+			uLong offset_local_extrafield;
+			uInt size_local_extrafield;
+			if (unzlocal_CheckCurrentFileCoherencyHeader(archive, &iSizeVar,
+						&offset_local_extrafield, &size_local_extrafield) != UNZ_OK)
+				return 0;
+
+			fe.offset_data = fe.cur_file_info_internal.offset_curfile + archive->byte_before_the_zipfile +
+			                 SIZEZIPLOCALHEADER + iSizeVar;
+		}
+
+		return new ZipStoredFileStream(archive->_streamRef, fe.offset_data,
+		                               fe.offset_data + fe.cur_file_info.uncompressed_size);
+	}
+
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return 0;
 
@@ -1508,10 +1560,10 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 
 	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
 
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+	// FIXME: instead of reading all of a compressed file into a memory
+	// stream, we could instead create a new ZipStream class. But then we
+	// have to be careful to handle the case where the client code opens
+	// multiple files in the archive and tries to use them independently.
 }
 
 Archive *makeZipArchive(const String &name) {
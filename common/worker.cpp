@@ -0,0 +1,56 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/worker.h"
+
+namespace Common {
+
+Worker::Worker() : _busy(false) {
+	assert(g_system);
+	_worker = g_system->createWorker();
+}
+
+Worker::~Worker() {
+	if (_worker)
+		g_system->deleteWorker(_worker);
+}
+
+void Worker::start(Proc proc, void *arg) {
+	if (!_worker) {
+		proc(arg);
+		return;
+	}
+
+	wait();
+	g_system->startWorker(_worker, proc, arg);
+	_busy = true;
+}
+
+void Worker::wait() {
+	if (!_busy)
+		return;
+
+	g_system->waitWorker(_worker);
+	_busy = false;
+}
+
+} // End of namespace Common
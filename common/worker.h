@@ -0,0 +1,59 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_WORKER_H
+#define COMMON_WORKER_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+#include "common/system.h"
+
+namespace Common {
+
+/**
+ * Wrapper class around the OSystem worker functions. When the backend
+ * does not offer worker threads, start() simply does the work right away.
+ */
+class Worker : NonCopyable {
+public:
+	typedef OSystem::WorkerProc Proc;
+
+	Worker();
+	~Worker();
+
+	/** Check whether the work runs on a thread of its own. */
+	bool isThreaded() const { return _worker != 0; }
+
+	/** Start running proc(arg). Any previous work is waited for first. */
+	void start(Proc proc, void *arg);
+
+	/** Wait until the work passed to start() is done. */
+	void wait();
+
+private:
+	OSystem::WorkerRef _worker;
+	bool _busy;
+};
+
+} // End of namespace Common
+
+#endif
@@ -367,11 +367,40 @@ void AdvancedMetaEngine::composeFileHashMap(FileMap &allFiles, const Common::FSL
 	}
 }
 
+/**
+ * File properties computed so far, keyed by the path of the file, the number
+ * of bytes hashed and whether the resource fork was used. Only allocated
+ * while the cache is enabled.
+ */
+typedef Common::HashMap<Common::String, ADFileProperties> FilePropertiesCache;
+static FilePropertiesCache *s_filePropertiesCache = 0;
+
+void AdvancedMetaEngine::enableFilePropertiesCache(bool enable) {
+	delete s_filePropertiesCache;
+	s_filePropertiesCache = enable ? new FilePropertiesCache() : 0;
+}
+
 bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, ADFileProperties &fileProps) const {
 	// FIXME/TODO: We don't handle the case that a file is listed as a regular
 	// file and as one with resource fork.
 
-	if (game.flags & ADGF_MACRESFORK) {
+	const bool resFork = (game.flags & ADGF_MACRESFORK) != 0;
+	if (!resFork && !allFiles.contains(fname))
+		return false;
+
+	Common::String cacheKey;
+	if (s_filePropertiesCache) {
+		const Common::String path = resFork ? parent.getChild(fname).getPath() : allFiles[fname].getPath();
+		cacheKey = Common::String::format("%s:%d:%d", path.c_str(), _md5Bytes, resFork);
+
+		FilePropertiesCache::const_iterator cached = s_filePropertiesCache->find(cacheKey);
+		if (cached != s_filePropertiesCache->end()) {
+			fileProps = cached->_value;
+			return true;
+		}
+	}
+
+	if (resFork) {
 		Common::MacResManager macResMan;
 
 		if (!macResMan.open(parent, fname))
@@ -379,19 +408,19 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 
 		fileProps.md5 = macResMan.computeResForkMD5AsString(_md5Bytes);
 		fileProps.size = macResMan.getResForkDataSize();
-		return true;
-	}
+	} else {
+		Common::File testFile;
 
-	if (!allFiles.contains(fname))
-		return false;
+		if (!testFile.open(allFiles[fname]))
+			return false;
 
-	Common::File testFile;
+		fileProps.size = (int32)testFile.size();
+		fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+	}
 
-	if (!testFile.open(allFiles[fname]))
-		return false;
+	if (s_filePropertiesCache)
+		(*s_filePropertiesCache)[cacheKey] = fileProps;
 
-	fileProps.size = (int32)testFile.size();
-	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
 	return true;
 }
 
@@ -252,6 +252,15 @@ protected:
 public:
 	AdvancedMetaEngine(const void *descs, uint descItemSize, const PlainGameDescriptor *gameids, const ADExtraGuiOptionsMap *extraGuiOptions = 0);
 
+	/**
+	 * Enables or disables sharing of computed file properties (sizes and
+	 * MD5s) between the detection runs of all engines. While enabled, every
+	 * file is only hashed once, no matter how many engines look at it.
+	 * Disabling the cache also clears it, so that files which change on
+	 * disk are hashed again in the next run.
+	 */
+	static void enableFilePropertiesCache(bool enable);
+
 	/**
 	 * Returns list of targets supported by the engine.
 	 * Distinguishes engines with single ID
@@ -435,6 +435,7 @@ bool ROQPlayer::processBlockStill(ROQBlockHeader &blockHeader) {
 	warning("Groovie::ROQ: JPEG frame (unfinished)");
 
 	Graphics::JPEGDecoder *jpg = new Graphics::JPEGDecoder();
+	jpg->setOutputColorSpace(Graphics::JPEGDecoder::kColorSpaceYUV);
 	jpg->loadStream(*_file);
 	const byte *y = (const byte *)jpg->getComponent(1)->getBasePtr(0, 0);
 	const byte *u = (const byte *)jpg->getComponent(2)->getBasePtr(0, 0);
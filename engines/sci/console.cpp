@@ -63,6 +63,8 @@
 
 #include "engines/util.h"
 
+#include <limits.h>
+
 namespace Sci {
 
 int g_debug_sleeptime_factor = 1;
@@ -94,6 +96,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("selectors",			WRAP_METHOD(Console, cmdSelectors));
 	DCmd_Register("functions",			WRAP_METHOD(Console, cmdKernelFunctions));
 	DCmd_Register("class_table",		WRAP_METHOD(Console, cmdClassTable));
+	DCmd_Register("selector_cache",		WRAP_METHOD(Console, cmdSelectorCache));
+	DCmd_Register("avoidpath_bench",	WRAP_METHOD(Console, cmdAvoidPathBench));
 	// Parser
 	DCmd_Register("suffixes",			WRAP_METHOD(Console, cmdSuffixes));
 	DCmd_Register("parse_grammar",		WRAP_METHOD(Console, cmdParseGrammar));
@@ -112,6 +116,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("list",				WRAP_METHOD(Console, cmdList));
 	DCmd_Register("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	DCmd_Register("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
+	DCmd_Register("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	// Game
 	DCmd_Register("save_game",			WRAP_METHOD(Console, cmdSaveGame));
 	DCmd_Register("restore_game",		WRAP_METHOD(Console, cmdRestoreGame));
@@ -151,6 +156,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	DCmd_Register("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	DCmd_Register("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	DCmd_Register("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
 	// Music/SFX
 	DCmd_Register("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	DCmd_Register("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -330,6 +336,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" selector - Attempts to find the requested selector by name\n");
 	DebugPrintf(" functions - Lists the kernel functions\n");
 	DebugPrintf(" class_table - Shows the available classes\n");
+	DebugPrintf(" selector_cache - Shows the selector lookup cache counters, or records and replays VM sends\n");
+	DebugPrintf(" avoidpath_bench - Records pathfinding calls and replays them\n");
 	DebugPrintf("\n");
 	DebugPrintf("Parser:\n");
 	DebugPrintf(" suffixes - Lists the vocabulary suffixes\n");
@@ -350,6 +358,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" list - Lists all the resources of a given type\n");
 	DebugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	DebugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
+	DebugPrintf(" resource_cache - Shows the resource cache counters, or changes its memory budget\n");
 	DebugPrintf("\n");
 	DebugPrintf("Game:\n");
 	DebugPrintf(" save_game - Saves the current game state to the hard disk\n");
@@ -386,6 +395,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	DebugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	DebugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	DebugPrintf(" gc_stats - Shows how long the garbage collector paused the game\n");
 	DebugPrintf("\n");
 	DebugPrintf("Music/SFX:\n");
 	DebugPrintf(" songlib - Shows the song library\n");
@@ -582,6 +592,107 @@ bool Console::cmdSelectors(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdSelectorCache(int argc, const char **argv) {
+	SegManager *segMan = _engine->_gamestate->_segMan;
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+
+	if (argc < 2) {
+		const SelectorLookupCache::Stats &stats = cache.getStats();
+		DebugPrintf("Selector lookup cache is %s, %d entries\n", cache.isEnabled() ? "on" : "off", cache.getEntryCount());
+		DebugPrintf("Lookups: %d, hits: %d (%d%%), invalidations: %d\n", stats.lookups, stats.hits,
+		            stats.lookups ? (int)((uint64)stats.hits * 100 / stats.lookups) : 0, stats.invalidations);
+		DebugPrintf("Recorded sends: %d, still to record: %d\n", cache.getTrace().size(), cache.getTraceRemaining());
+		DebugPrintf("Usage: %s [on | off | reset | record <sends> | bench [<passes>]]\n", argv[0]);
+		return true;
+	}
+
+	if (!scumm_stricmp(argv[1], "on")) {
+		cache.setEnabled(true);
+	} else if (!scumm_stricmp(argv[1], "off")) {
+		cache.setEnabled(false);
+		cache.invalidate();
+	} else if (!scumm_stricmp(argv[1], "reset")) {
+		cache.resetStats();
+	} else if (!scumm_stricmp(argv[1], "record") && argc == 3) {
+		cache.startTrace(atoi(argv[2]));
+		DebugPrintf("Recording the next %d sends, run %s bench afterwards to replay them\n", atoi(argv[2]), argv[0]);
+	} else if (!scumm_stricmp(argv[1], "bench")) {
+		const int passes = (argc == 3) ? MAX(atoi(argv[2]), 1) : 100;
+
+		// Objects may have been freed since the sends were recorded
+		Common::Array<SelectorLookupCache::TraceEntry> trace;
+		for (uint i = 0; i < cache.getTrace().size(); i++) {
+			const SelectorLookupCache::TraceEntry &entry = cache.getTrace()[i];
+			const Object *obj = segMan->getObject(entry.object);
+			if (obj && !obj->isFreed())
+				trace.push_back(entry);
+		}
+
+		if (trace.empty()) {
+			DebugPrintf("No sends recorded, use %s record <sends> first\n", argv[0]);
+			return true;
+		}
+
+		const bool wasEnabled = cache.isEnabled();
+		uint32 time[2];
+
+		for (int cached = 0; cached < 2; cached++) {
+			cache.setEnabled(cached != 0);
+			const uint32 start = g_system->getMillis();
+			for (int pass = 0; pass < passes; pass++) {
+				for (uint i = 0; i < trace.size(); i++) {
+					ObjVarRef varp;
+					reg_t funcp;
+					lookupSelector(segMan, trace[i].object, trace[i].selector, &varp, &funcp);
+				}
+			}
+			time[cached] = MAX<uint32>(g_system->getMillis() - start, 1);
+		}
+
+		// The replayed lookups would skew the counters
+		cache.setEnabled(wasEnabled);
+		cache.resetStats();
+
+		const uint64 sends = (uint64)trace.size() * passes;
+		DebugPrintf("Replayed %d sends %d times\n", trace.size(), passes);
+		DebugPrintf("Uncached: %d ms, %d sends per second\n", time[0], (int)(sends * 1000 / time[0]));
+		DebugPrintf("Cached: %d ms, %d sends per second\n", time[1], (int)(sends * 1000 / time[1]));
+	} else {
+		DebugPrintf("Usage: %s [on | off | reset | record <sends> | bench [<passes>]]\n", argv[0]);
+	}
+
+	return true;
+}
+
+bool Console::cmdAvoidPathBench(int argc, const char **argv) {
+	if (argc == 3 && !scumm_stricmp(argv[1], "record")) {
+		recordAvoidPathCalls(atoi(argv[2]));
+		DebugPrintf("Recording the next %d pathfinding calls, run %s afterwards to replay them\n", atoi(argv[2]), argv[0]);
+		return true;
+	}
+
+	if (argc > 2) {
+		DebugPrintf("Records pathfinding calls done by the game, and replays them with and without the visibility graph cache\n");
+		DebugPrintf("Usage: %s [record <calls> | <passes>]\n", argv[0]);
+		return true;
+	}
+
+	const int passes = (argc == 2) ? MAX(atoi(argv[1]), 1) : 100;
+	uint32 uncachedTime, cachedTime;
+
+	if (!benchmarkAvoidPath(_engine->_gamestate, passes, uncachedTime, cachedTime)) {
+		DebugPrintf("No pathfinding calls recorded, use %s record <calls> first\n", argv[0]);
+		return true;
+	}
+
+	const uint32 calls = getRecordedAvoidPathCallCount() * passes;
+	DebugPrintf("Replayed %d pathfinding calls %d times\n", getRecordedAvoidPathCallCount(), passes);
+	DebugPrintf("Uncached: %d ms, %d calls per second\n", uncachedTime, calls * 1000 / MAX<uint32>(uncachedTime, 1));
+	DebugPrintf("Cached: %d ms, %d calls per second\n", cachedTime, calls * 1000 / MAX<uint32>(cachedTime, 1));
+
+	return true;
+}
+
 bool Console::cmdKernelFunctions(int argc, const char **argv) {
 	DebugPrintf("Kernel function names in numeric order:\n");
 	for (uint seeker = 0; seeker <  _engine->getKernel()->getKernelNamesSize(); seeker++) {
@@ -781,6 +892,46 @@ bool Console::cmdResourceInfo(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+
+	if (argc > 2) {
+		DebugPrintf("Shows the resource cache counters, or changes the memory budget for unlocked resources\n");
+		DebugPrintf("Usage: %s [<budget in KB> | reset]\n", argv[0]);
+		return true;
+	}
+
+	if (argc == 2) {
+		if (!scumm_stricmp(argv[1], "reset")) {
+			resMan->resetCacheStats();
+			DebugPrintf("Resource cache counters reset\n");
+		} else {
+			char *endptr;
+			const long budget = strtol(argv[1], &endptr, 10);
+			if (*endptr || budget <= 0 || budget > INT_MAX / 1024) {
+				DebugPrintf("Invalid budget '%s', it must be between 1 and %d KB\n", argv[1], INT_MAX / 1024);
+				DebugPrintf("Usage: %s [<budget in KB> | reset]\n", argv[0]);
+				return true;
+			}
+
+			resMan->setMaxMemory(budget * 1024);
+		}
+	}
+
+	const ResourceManager::CacheStats &stats = resMan->getCacheStats();
+	const uint32 lookups = stats.hits + stats.misses;
+
+	DebugPrintf("Memory budget: %d KB\n", resMan->getMaxMemory() / 1024);
+	DebugPrintf("Unlocked resources: %d KB, locked resources: %d KB\n",
+	            resMan->getMemoryLRU() / 1024, resMan->getMemoryLocked() / 1024);
+	DebugPrintf("Lookups: %d, hits: %d (%d%%), misses: %d\n", lookups, stats.hits,
+	            lookups ? stats.hits * 100 / lookups : 0, stats.misses);
+	DebugPrintf("Evictions: %d, time spent loading: %d ms, prefetched: %d\n",
+	            stats.evictions, stats.loadTime, stats.prefetched);
+
+	return true;
+}
+
 bool Console::cmdResourceTypes(int argc, const char **argv) {
 	DebugPrintf("The %d valid resource types are:\n", kResourceTypeInvalid);
 	for (int i = 0; i < kResourceTypeInvalid; i++) {
@@ -2341,6 +2492,28 @@ bool Console::cmdGCNormalize(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCStats(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && scumm_stricmp(argv[1], "reset"))) {
+		DebugPrintf("Shows the number of garbage collections and the pauses they caused\n");
+		DebugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	if (argc == 2) {
+		resetGCStats();
+		DebugPrintf("Garbage collector counters reset\n");
+	}
+
+	const GCStats &stats = getGCStats();
+	DebugPrintf("Collections: %d (%d while waiting for a frame, %d forced), pending: %s\n",
+	            stats.runs, stats.idleRuns, stats.forcedRuns, _engine->_gamestate->gcPending ? "yes" : "no");
+	DebugPrintf("Pause: last %d ms, longest %d ms, average %d ms, total %d ms\n", stats.lastPause,
+	            stats.maxPause, stats.runs ? stats.totalPause / stats.runs : 0, stats.totalPause);
+	DebugPrintf("Objects freed: last %d, total %d\n", stats.lastFreed, stats.totalFreed);
+
+	return true;
+}
+
 bool Console::cmdVMVarlist(int argc, const char **argv) {
 	EngineState *s = _engine->_gamestate;
 	const char *varnames[] = {"global", "local", "temp", "param"};
@@ -22,6 +22,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 namespace Sci {
@@ -46,6 +47,14 @@ const char *segmentTypeNames[] = {
 };
 #endif
 
+static GCStats s_gcStats;
+
+/**
+ * Number of references found by the last marking phase. The address sets
+ * of the next collection are sized for this many entries up front.
+ */
+static uint s_lastActiveRefCount = 0;
+
 void WorklistManager::push(reg_t reg) {
 	if (!reg.getSegment()) // No numbers
 		return;
@@ -66,6 +75,7 @@ void WorklistManager::pushArray(const Common::Array<reg_t> &tmp) {
 
 static AddrSet *normalizeAddresses(SegManager *segMan, const AddrSet &nonnormal_map) {
 	AddrSet *normal_map = new AddrSet();
+	normal_map->reserve(nonnormal_map.size());
 
 	for (AddrSet::const_iterator i = nonnormal_map.begin(); i != nonnormal_map.end(); ++i) {
 		reg_t reg = i->_key;
@@ -99,6 +109,7 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	assert(!s->_executionStack.empty());
 
 	WorklistManager wm;
+	wm._map.reserve(s_lastActiveRefCount);
 
 	// Initialize registers
 	wm.push(s->r_acc);
@@ -157,11 +168,17 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->processEngineHunkList(wm);
 
+	s_lastActiveRefCount = wm._map.size();
+
 	return normalizeAddresses(s->_segMan, wm._map);
 }
 
 void run_gc(EngineState *s) {
 	SegManager *segMan = s->_segMan;
+	const uint32 startTime = g_system->getMillis();
+	uint32 freed = 0;
+
+	s->gcPending = false;
 
 	// Some debug stuff
 	debugC(kDebugLevelGC, "[GC] Running...");
@@ -195,6 +212,7 @@ void run_gc(EngineState *s) {
 				if (!activeRefs->contains(addr)) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
+					freed++;
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
@@ -207,6 +225,15 @@ void run_gc(EngineState *s) {
 
 	delete activeRefs;
 
+	const uint32 pause = g_system->getMillis() - startTime;
+	s_gcStats.runs++;
+	s_gcStats.lastPause = pause;
+	s_gcStats.maxPause = MAX(s_gcStats.maxPause, pause);
+	s_gcStats.totalPause += pause;
+	s_gcStats.lastFreed = freed;
+	s_gcStats.totalFreed += freed;
+	debugC(kDebugLevelGC, "[GC] Freed %d objects in %d ms", freed, pause);
+
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
@@ -216,4 +243,30 @@ void run_gc(EngineState *s) {
 #endif
 }
 
+void scheduleGC(EngineState *s) {
+	if (s->gcPending) {
+		// The game did not wait for a frame since the last collection was
+		// scheduled, don't let the garbage pile up any further
+		s_gcStats.forcedRuns++;
+		run_gc(s);
+	} else {
+		s->gcPending = true;
+	}
+}
+
+void runPendingGC(EngineState *s) {
+	if (s->gcPending) {
+		s_gcStats.idleRuns++;
+		run_gc(s);
+	}
+}
+
+const GCStats &getGCStats() {
+	return s_gcStats;
+}
+
+void resetGCStats() {
+	memset(&s_gcStats, 0, sizeof(s_gcStats));
+}
+
 } // End of namespace Sci
@@ -24,7 +24,7 @@
 #ifndef SCI_ENGINE_GC_H
 #define SCI_ENGINE_GC_H
 
-#include "common/hashmap.h"
+#include "common/flathashmap.h"
 #include "sci/engine/vm_types.h"
 #include "sci/engine/state.h"
 
@@ -38,9 +38,26 @@ struct reg_t_Hash {
 
 /*
  * The AddrSet is a "set" of reg_t values.
- * We don't have a HashSet type, so we abuse a HashMap for this.
+ * We don't have a HashSet type, so we abuse a hash map for this. The
+ * marking phase does a lookup for every reference it follows, so we use
+ * the open addressing FlatHashMap, which avoids a node allocation for
+ * every reachable address.
  */
-typedef Common::HashMap<reg_t, bool, reg_t_Hash> AddrSet;
+typedef Common::FlatHashMap<reg_t, bool, reg_t_Hash> AddrSet;
+
+/**
+ * Counters describing the pauses caused by the garbage collector.
+ */
+struct GCStats {
+	uint32 runs;		///< Number of collections
+	uint32 idleRuns;	///< Collections done while the game waited for its next frame
+	uint32 forcedRuns;	///< Collections which could not wait for the next frame
+	uint32 lastPause;	///< Duration of the last collection, in milliseconds
+	uint32 maxPause;	///< Duration of the longest collection, in milliseconds
+	uint32 totalPause;	///< Time spent collecting, in milliseconds
+	uint32 lastFreed;	///< Objects freed by the last collection
+	uint32 totalFreed;	///< Objects freed by all collections
+};
 
 /**
  * Finds all used references and normalises them to their memory addresses
@@ -55,6 +72,28 @@ AddrSet *findAllActiveReferences(EngineState *s);
  */
 void run_gc(EngineState *s);
 
+/**
+ * Called by the VM every scriptGCInterval kernel calls. The collection is
+ * postponed to the next point where the game waits for its next frame, so
+ * its pause is hidden in the frame's idle time. If the previously
+ * scheduled collection is still pending, it is run right away.
+ * @param s The state in which we should gc
+ */
+void scheduleGC(EngineState *s);
+
+/**
+ * Runs a collection scheduled by scheduleGC(), if there is one. Called on
+ * entry of the kernel functions the games use to wait for their next frame
+ * (kWait, kGameIsRestarting and kFrameOut). Only there it is safe: the
+ * marking phase does not see the arguments of the running kernel call, nor
+ * any references held by C++ code in the middle of a kernel call.
+ * @param s The state in which we should gc
+ */
+void runPendingGC(EngineState *s);
+
+const GCStats &getGCStats();
+void resetGCStats();
+
 struct WorklistManager {
 	Common::Array<reg_t> _worklist;
 	AddrSet _map;	// used for 2 contains() calls, inside push() and run_gc()
@@ -547,6 +547,28 @@ reg_t kFileIOIsValidDirectory(EngineState *s, int argc, reg_t *argv);
 
 //@}
 
+/******************** Pathfinding helpers ********************/
+
+/**
+ * Frees the visibility graphs cached by kAvoidPath and the recorded calls.
+ */
+void freeAvoidPathCache();
+
+/**
+ * Records the input of the next 'count' pathfinding calls of kAvoidPath,
+ * replacing the previously recorded calls.
+ */
+void recordAvoidPathCalls(uint count);
+
+uint getRecordedAvoidPathCallCount();
+
+/**
+ * Replays the recorded pathfinding calls 'passes' times, first without and
+ * then with the visibility graph cache.
+ * @return false if no calls have been recorded
+ */
+bool benchmarkAvoidPath(EngineState *s, int passes, uint32 &uncachedTime, uint32 &cachedTime);
+
 } // End of namespace Sci
 
 #endif // SCI_ENGINE_KERNEL_H
@@ -32,6 +32,7 @@
 #include "sci/event.h"
 #include "sci/resource.h"
 #include "sci/engine/features.h"
+#include "sci/engine/gc.h"
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
 #include "sci/engine/kernel.h"
@@ -392,7 +393,11 @@ reg_t kTextSize(EngineState *s, int argc, reg_t *argv) {
 reg_t kWait(EngineState *s, int argc, reg_t *argv) {
 	int sleep_time = argv[0].toUint16();
 
-	s->wait(sleep_time);
+	// No kernel call holds any references here, so collect the garbage
+	// while the game waits anyway, taking the time off the wait
+	const uint32 gcStart = g_system->getMillis();
+	runPendingGC(s);
+	s->wait(sleep_time, g_system->getMillis() - gcStart);
 
 	return s->r_acc;
 }
@@ -105,6 +105,10 @@ reg_t kGameIsRestarting(EngineState *s, int argc, reg_t *argv) {
 		break;
 	}
 
+	// The game is done with this frame, and no kernel call holds any
+	// references, so collect its garbage while the game is throttled anyway
+	runPendingGC(s);
+
 	s->speedThrottler(neededSleep);
 	return s->r_acc;
 }
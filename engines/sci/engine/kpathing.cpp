@@ -108,26 +108,29 @@ struct Vertex {
 	uint32 costF;
 	uint32 costG;
 
+	// Order in which the vertex entered the A* open set, 0 if it didn't yet
+	uint32 openOrder;
+
+	// Set once the shortest path to this vertex is known
+	bool closed;
+
 	// Previous vertex in shortest path
 	Vertex *path_prev;
 
+	// Index of the vertex in the visibility graph, -1 if it isn't part of it
+	int graphIndex;
+
 public:
 	Vertex(const Common::Point &p) : v(p) {
 		costG = HUGE_DISTANCE;
+		openOrder = 0;
+		closed = false;
 		path_prev = NULL;
+		graphIndex = -1;
 	}
 };
 
-class VertexList: public Common::List<Vertex *> {
-public:
-	bool contains(Vertex *v) {
-		for (iterator it = begin(); it != end(); ++it) {
-			if (v == *it)
-				return true;
-		}
-		return false;
-	}
-};
+typedef Common::List<Vertex *> VertexList;
 
 /* Circular list definitions. */
 
@@ -221,8 +224,11 @@ struct Polygon {
 	// Circular list of vertices
 	CircularVertexList vertices;
 
+	// Index of the polygon in the visibility graph, -1 if it isn't part of it
+	int graphIndex;
+
 public:
-	Polygon(int t) : type(t) {
+	Polygon(int t) : type(t), graphIndex(-1) {
 	}
 
 	~Polygon() {
@@ -236,6 +242,61 @@ public:
 
 typedef Common::List<Polygon *> PolygonList;
 
+/**
+ * A polygon as read from the game scripts, before the start and end points
+ * are merged into the polygon set.
+ */
+struct StoredPolygon {
+	int type;
+	Common::Array<Common::Point> points;
+
+	bool operator==(const StoredPolygon &p) const {
+		return type == p.type && points == p.points;
+	}
+
+	bool operator!=(const StoredPolygon &p) const {
+		return !(*this == p);
+	}
+};
+
+typedef Common::Array<StoredPolygon> StoredPolygonSet;
+
+#define VISIBILITY_GRAPH_MAX_POLYGONS 63
+#define VISIBILITY_GRAPH_MAX_VERTICES 256
+
+// Flags an entry of VisibilityGraph::blockers as computed
+#define VIS_KNOWN ((uint64)1 << 63)
+
+/**
+ * Visibility between the vertices of a polygon set. Games call kAvoidPath
+ * many times with the same polygons, only the start and end points differ.
+ *
+ * For every pair of polygon vertices, the graph stores the polygons which
+ * block the line between them, one bit per polygon. This does not depend on
+ * the start and end points, so all calls with the same polygon set share
+ * it. Two vertices are visible from each other if none of these polygons
+ * are left over after the start and end point fixups.
+ */
+struct VisibilityGraph {
+	struct GraphVertex {
+		Common::Point v, prev, next;
+		int polygon;
+		bool hasEdges;
+	};
+
+	StoredPolygonSet polygons;
+	Common::Array<GraphVertex> vertices;
+
+	// Visibility is symmetric, so only one entry is stored per pair
+	Common::Array<uint64> blockers;
+
+	uint64 &getBlockers(int a, int b) {
+		if (a < b)
+			SWAP(a, b);
+		return blockers[a * (a + 1) / 2 + b];
+	}
+};
+
 // Pathfinding state
 struct PathfindingState {
 	// List of all polygons
@@ -257,6 +318,12 @@ struct PathfindingState {
 	// Screen size
 	int _width, _height;
 
+	// Visibility graph of the polygon set, NULL if it can't be used
+	VisibilityGraph *_graph;
+
+	// Polygons of the visibility graph which are part of this state
+	uint64 _graphPolygons;
+
 	PathfindingState(int width, int height) : _width(width), _height(height) {
 		vertex_start = NULL;
 		vertex_end = NULL;
@@ -264,6 +331,8 @@ struct PathfindingState {
 		_prependPoint = NULL;
 		_appendPoint = NULL;
 		vertices = 0;
+		_graph = NULL;
+		_graphPolygons = 0;
 	}
 
 	~PathfindingState() {
@@ -628,6 +697,30 @@ static void fix_vertex_order(Polygon *polygon) {
 	}
 }
 
+/**
+ * Determines whether or not a line from a point to a vertex intersects the
+ * interior of the polygon, locally at that vertex
+ * Parameters: (Common::Point) p: The point
+ *             (Common::Point) prev, cur, next: The vertex and its neighbours
+ * Returns   : (int) 1 if the line (p, cur) intersects the interior of
+ *                   the polygon, locally at the vertex. 0 otherwise
+ */
+static int inside(const Common::Point &p, const Common::Point &prev, const Common::Point &cur, const Common::Point &next) {
+	if (left(prev, cur, next)) {
+		// Convex vertex, line (p, cur) intersects the inside
+		// if p is located left of both edges
+		if (left(cur, next, p) && left(prev, cur, p))
+			return 1;
+	} else {
+		// Non-convex vertex, line (p, cur) intersects the
+		// inside if p is located left of either edge
+		if (left(cur, next, p) || left(prev, cur, p))
+			return 1;
+	}
+
+	return 0;
+}
+
 /**
  * Determines whether or not a line from a point to a vertex intersects the
  * interior of the polygon, locally at that vertex
@@ -638,25 +731,90 @@ static void fix_vertex_order(Polygon *polygon) {
  */
 static int inside(const Common::Point &p, Vertex *vertex) {
 	// Check that it's not a single-vertex polygon
-	if (VERTEX_HAS_EDGES(vertex)) {
-		const Common::Point &prev = CLIST_PREV(vertex)->v;
-		const Common::Point &next = CLIST_NEXT(vertex)->v;
-		const Common::Point &cur = vertex->v;
-
-		if (left(prev, cur, next)) {
-			// Convex vertex, line (p, cur) intersects the inside
-			// if p is located left of both edges
-			if (left(cur, next, p) && left(prev, cur, p))
-				return 1;
-		} else {
-			// Non-convex vertex, line (p, cur) intersects the
-			// inside if p is located left of either edge
-			if (left(cur, next, p) || left(prev, cur, p))
-				return 1;
+	if (VERTEX_HAS_EDGES(vertex))
+		return inside(p, CLIST_PREV(vertex)->v, vertex->v, CLIST_NEXT(vertex)->v);
+
+	return 0;
+}
+
+static int inside(const Common::Point &p, const VisibilityGraph::GraphVertex &vertex) {
+	// Check that it's not a single-vertex polygon
+	if (vertex.hasEdges)
+		return inside(p, vertex.prev, vertex.v, vertex.next);
+
+	return 0;
+}
+
+/**
+ * Determines whether a vertex is visible from another one
+ * @param s				the pathfinding state
+ * @param vertex_cur	the vertex to look from
+ * @param vertex		the vertex to look at
+ * @return true if the line between the vertices is not blocked
+ */
+static bool vertex_visible(PathfindingState *s, Vertex *vertex_cur, Vertex *vertex) {
+	// Make sure we don't intersect a polygon locally at the vertices
+	if ((inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		return false;
+
+	// Check for intersecting edges
+	for (int j = 0; j < s->vertices; j++) {
+		Vertex *edge = s->vertex_index[j];
+		if (VERTEX_HAS_EDGES(edge)) {
+			if (between(vertex_cur->v, vertex->v, edge->v)) {
+				// If we hit a vertex, make sure we can pass through it without intersecting its polygon
+				if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
+					return false;
+
+				// This edge won't properly intersect, so we continue
+				continue;
+			}
+
+			if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
+				return false;
 		}
 	}
 
-	return 0;
+	return true;
+}
+
+/**
+ * Determines which polygons of a visibility graph block the line between
+ * two of its vertices. Does the same checks as vertex_visible(), but for
+ * all polygons of the graph.
+ * @param graph		the visibility graph
+ * @param cur		index of the vertex to look from
+ * @param other		index of the vertex to look at
+ * @return the blocking polygons, one bit per polygon
+ */
+static uint64 blocking_polygons(const VisibilityGraph *graph, int cur, int other) {
+	const VisibilityGraph::GraphVertex &vertex_cur = graph->vertices[cur];
+	const VisibilityGraph::GraphVertex &vertex = graph->vertices[other];
+
+	// The polygons of the vertices are always part of the pathfinding state
+	if ((inside(vertex.v, vertex_cur)) || (inside(vertex_cur.v, vertex)))
+		return ((uint64)1 << vertex_cur.polygon) | ((uint64)1 << vertex.polygon);
+
+	uint64 blockers = 0;
+
+	for (uint j = 0; j < graph->vertices.size(); j++) {
+		const VisibilityGraph::GraphVertex &edge = graph->vertices[j];
+		const uint64 polygon = (uint64)1 << edge.polygon;
+
+		if (!edge.hasEdges || (blockers & polygon))
+			continue;
+
+		if (between(vertex_cur.v, vertex.v, edge.v)) {
+			if ((inside(vertex_cur.v, edge)) || (inside(vertex.v, edge)))
+				blockers |= polygon;
+			continue;
+		}
+
+		if (intersect_proper(vertex_cur.v, vertex.v, edge.v, edge.next))
+			blockers |= polygon;
+	}
+
+	return blockers;
 }
 
 /**
@@ -667,34 +825,26 @@ static int inside(const Common::Point &p, Vertex *vertex) {
  */
 static VertexList *visible_vertices(PathfindingState *s, Vertex *vertex_cur) {
 	VertexList *visVerts = new VertexList();
+	VisibilityGraph *graph = (vertex_cur->graphIndex >= 0) ? s->_graph : NULL;
 
 	for (int i = 0; i < s->vertices; i++) {
 		Vertex *vertex = s->vertex_index[i];
 
-		// Make sure we don't intersect a polygon locally at the vertices
-		if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		if (vertex == vertex_cur)
 			continue;
 
-		// Check for intersecting edges
-		int j;
-		for (j = 0; j < s->vertices; j++) {
-			Vertex *edge = s->vertex_index[j];
-			if (VERTEX_HAS_EDGES(edge)) {
-				if (between(vertex_cur->v, vertex->v, edge->v)) {
-					// If we hit a vertex, make sure we can pass through it without intersecting its polygon
-					if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
-						break;
-
-					// This edge won't properly intersect, so we continue
-					continue;
-				}
+		bool visible;
 
-				if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
-					break;
-			}
+		if (graph && vertex->graphIndex >= 0) {
+			uint64 &blockers = graph->getBlockers(vertex_cur->graphIndex, vertex->graphIndex);
+			if (!(blockers & VIS_KNOWN))
+				blockers = blocking_polygons(graph, vertex_cur->graphIndex, vertex->graphIndex) | VIS_KNOWN;
+			visible = !(blockers & s->_graphPolygons);
+		} else {
+			visible = vertex_visible(s, vertex_cur, vertex);
 		}
 
-		if (j == s->vertices)
+		if (visible)
 			visVerts->push_front(vertex);
 	}
 
@@ -1081,8 +1231,10 @@ static Vertex *merge_point(PathfindingState *s, const Common::Point &v) {
 				Vertex *next = CLIST_NEXT(vertex);
 
 				if (between(vertex->v, next->v, v)) {
-					// Split edge by adding vertex
+					// Split edge by adding vertex. This changes the edges of
+					// the polygon, so the visibility graph can't be used.
 					polygon->vertices.insertAfter(vertex, v_new);
+					s->_graph = NULL;
 					return v_new;
 				}
 			}
@@ -1186,40 +1338,136 @@ static void change_polygons_opt_0(PathfindingState *s) {
 }
 
 /**
- * Converts the SCI input data for pathfinding
- * Parameters: (EngineState *) s: The game state
- *             (reg_t) poly_list: Polygon list
- *             (Common::Point) start: The start point
- *             (Common::Point) end: The end point
- *             (int) opt: Optimization level (0, 1 or 2)
- * Returns   : (PathfindingState *) On success a newly allocated pathfinding state,
- *                            NULL otherwise
+ * Copies the polygons of a polygon list, so they can be compared with or
+ * restored into the polygons of another pathfinding state
  */
-static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
-	SegManager *segMan = s->_segMan;
-	Polygon *polygon;
-	int count = 0;
-	PathfindingState *pf_s = new PathfindingState(width, height);
+static void store_polygons(const PolygonList &polygons, StoredPolygonSet &stored) {
+	stored.resize(polygons.size());
 
-	// Convert all polygons
-	if (poly_list.getSegment()) {
-		List *list = s->_segMan->lookupList(poly_list);
-		Node *node = s->_segMan->lookupNode(list->first);
+	uint i = 0;
+	for (PolygonList::const_iterator it = polygons.begin(); it != polygons.end(); ++it, ++i) {
+		Vertex *vertex;
+		stored[i].type = (*it)->type;
+		CLIST_FOREACH(vertex, &(*it)->vertices)
+			stored[i].points.push_back(vertex->v);
+	}
+}
 
-		while (node) {
-			// The node value might be null, in which case there's no polygon to parse.
-			// Happens in LB2 floppy - refer to bug #3041232
-			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : NULL;
+static void restore_polygons(const StoredPolygonSet &stored, PolygonList &polygons) {
+	for (uint i = 0; i < stored.size(); i++) {
+		Polygon *polygon = new Polygon(stored[i].type);
+		for (uint j = 0; j < stored[i].points.size(); j++)
+			polygon->vertices.insertAtEnd(new Vertex(stored[i].points[j]));
+		polygons.push_back(polygon);
+	}
+}
 
-			if (polygon) {
-				pf_s->polygons.push_back(polygon);
-				count += readSelectorValue(segMan, node->value, SELECTOR(size));
-			}
+#define VISIBILITY_GRAPHS 4
 
-			node = s->_segMan->lookupNode(node->succ);
+// Visibility graphs of the most recently used polygon sets, most recent first
+static VisibilityGraph *s_visibilityGraphs[VISIBILITY_GRAPHS];
+static bool s_visibilityGraphsEnabled = true;
+
+/**
+ * Returns the visibility graph of a polygon set, creating a new one if the
+ * polygon set hasn't been used recently
+ */
+static VisibilityGraph *lookup_visibility_graph(const StoredPolygonSet &polygons) {
+	int found = VISIBILITY_GRAPHS - 1;
+
+	for (int i = 0; i < VISIBILITY_GRAPHS; i++) {
+		if (s_visibilityGraphs[i] && s_visibilityGraphs[i]->polygons == polygons) {
+			found = i;
+			break;
 		}
 	}
 
+	VisibilityGraph *graph = s_visibilityGraphs[found];
+
+	if (!graph || graph->polygons != polygons) {
+		// Replace the least recently used graph
+		delete graph;
+		graph = new VisibilityGraph();
+		graph->polygons = polygons;
+
+		for (uint i = 0; i < polygons.size(); i++) {
+			const Common::Array<Common::Point> &points = polygons[i].points;
+
+			for (uint j = 0; j < points.size(); j++) {
+				VisibilityGraph::GraphVertex vertex;
+				vertex.v = points[j];
+				vertex.prev = points[(j + points.size() - 1) % points.size()];
+				vertex.next = points[(j + 1) % points.size()];
+				vertex.polygon = i;
+				vertex.hasEdges = points.size() > 1;
+				graph->vertices.push_back(vertex);
+			}
+		}
+
+		// Resizing zeroes the entries, which flags them as not computed
+		graph->blockers.resize(graph->vertices.size() * (graph->vertices.size() + 1) / 2);
+	}
+
+	for (int i = found; i > 0; i--)
+		s_visibilityGraphs[i] = s_visibilityGraphs[i - 1];
+	s_visibilityGraphs[0] = graph;
+
+	return graph;
+}
+
+/**
+ * Attaches the visibility graph of its polygon set to a pathfinding state
+ */
+static void attach_visibility_graph(PathfindingState *s, const StoredPolygonSet &polygons) {
+	uint vertices = 0;
+	for (uint i = 0; i < polygons.size(); i++)
+		vertices += polygons[i].points.size();
+
+	if (!s_visibilityGraphsEnabled || vertices > VISIBILITY_GRAPH_MAX_VERTICES || polygons.size() > VISIBILITY_GRAPH_MAX_POLYGONS)
+		return;
+
+	s->_graph = lookup_visibility_graph(polygons);
+
+	int polygonIndex = 0;
+	int vertexIndex = 0;
+
+	for (PolygonList::iterator it = s->polygons.begin(); it != s->polygons.end(); ++it) {
+		Vertex *vertex;
+		(*it)->graphIndex = polygonIndex++;
+		CLIST_FOREACH(vertex, &(*it)->vertices)
+			vertex->graphIndex = vertexIndex++;
+	}
+}
+
+/**
+ * A recorded call of kAvoidPath, used for benchmarking
+ */
+struct AvoidPathCall {
+	StoredPolygonSet polygons;
+	Common::Point start, end;
+	int width, height, opt;
+};
+
+static Common::Array<AvoidPathCall> *s_avoidPathCalls = NULL;
+static uint s_avoidPathCallsToRecord = 0;
+
+/**
+ * Prepares a pathfinding state containing the polygons of the SCI input
+ * data for pathfinding
+ * Parameters: (EngineState *) s: The game state
+ *             (PathfindingState *) pf_s: The pathfinding state
+ *             (StoredPolygonSet) polygons: Copy of the polygons of pf_s
+ *             (Common::Point) start: The start point
+ *             (Common::Point) end: The end point
+ *             (int) opt: Optimization level (0, 1 or 2)
+ * Returns   : (PathfindingState *) On success pf_s, NULL otherwise, in which
+ *                                  case pf_s has been freed
+ */
+static PathfindingState *init_pathfinding_state(EngineState *s, PathfindingState *pf_s, const StoredPolygonSet &polygons, Common::Point start, Common::Point end, int opt) {
+	Polygon *polygon;
+
+	attach_visibility_graph(pf_s, polygons);
+
 	if (opt == 0)
 		change_polygons_opt_0(pf_s);
 
@@ -1284,7 +1532,12 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	delete new_end;
 
 	// Allocate and build vertex index
-	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * (count + 2));
+	int count = 0;
+
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it)
+		count += (*it)->vertices.size();
+
+	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * count);
 
 	count = 0;
 
@@ -1299,9 +1552,135 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 
 	pf_s->vertices = count;
 
+	// Note which polygons of the visibility graph the fixups left over
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it) {
+		if ((*it)->graphIndex >= 0)
+			pf_s->_graphPolygons |= (uint64)1 << (*it)->graphIndex;
+	}
+
 	return pf_s;
 }
 
+/**
+ * Converts the SCI input data for pathfinding
+ * Parameters: (EngineState *) s: The game state
+ *             (reg_t) poly_list: Polygon list
+ *             (Common::Point) start: The start point
+ *             (Common::Point) end: The end point
+ *             (int) opt: Optimization level (0, 1 or 2)
+ * Returns   : (PathfindingState *) On success a newly allocated pathfinding state,
+ *                            NULL otherwise
+ */
+static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
+	Polygon *polygon;
+	PathfindingState *pf_s = new PathfindingState(width, height);
+
+	// Convert all polygons
+	if (poly_list.getSegment()) {
+		List *list = s->_segMan->lookupList(poly_list);
+		Node *node = s->_segMan->lookupNode(list->first);
+
+		while (node) {
+			// The node value might be null, in which case there's no polygon to parse.
+			// Happens in LB2 floppy - refer to bug #3041232
+			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : NULL;
+
+			if (polygon)
+				pf_s->polygons.push_back(polygon);
+
+			node = s->_segMan->lookupNode(node->succ);
+		}
+	}
+
+	StoredPolygonSet polygons;
+	store_polygons(pf_s->polygons, polygons);
+
+	if (s_avoidPathCallsToRecord) {
+		AvoidPathCall call;
+		call.polygons = polygons;
+		call.start = start;
+		call.end = end;
+		call.width = width;
+		call.height = height;
+		call.opt = opt;
+		s_avoidPathCalls->push_back(call);
+		s_avoidPathCallsToRecord--;
+	}
+
+	return init_pathfinding_state(s, pf_s, polygons, start, end, opt);
+}
+
+/**
+ * The open set of AStar(), a binary heap ordered by F cost. Of vertices
+ * with equal F cost, the one which entered the open set last comes first.
+ * When the F cost of a vertex in the open set decreases, it is pushed
+ * again, and its outdated entry is skipped when it comes up.
+ */
+class OpenSet {
+public:
+	OpenSet() : _order(0) {}
+
+	void push(Vertex *vertex) {
+		if (!vertex->openOrder)
+			vertex->openOrder = ++_order;
+
+		Entry entry = { vertex->costF, vertex->openOrder, vertex };
+		uint pos = _heap.size();
+		_heap.push_back(entry);
+
+		while (pos > 0 && before(entry, _heap[(pos - 1) / 2])) {
+			_heap[pos] = _heap[(pos - 1) / 2];
+			pos = (pos - 1) / 2;
+		}
+		_heap[pos] = entry;
+	}
+
+	/**
+	 * Removes the vertex with the lowest F cost from the open set
+	 * @return the vertex, or NULL if the open set is empty
+	 */
+	Vertex *pop() {
+		while (!_heap.empty()) {
+			const Entry top = _heap[0];
+			const Entry last = _heap.back();
+			_heap.pop_back();
+
+			if (!_heap.empty()) {
+				uint pos = 0;
+				uint child;
+				while ((child = pos * 2 + 1) < _heap.size()) {
+					if (child + 1 < _heap.size() && before(_heap[child + 1], _heap[child]))
+						child++;
+					if (!before(_heap[child], last))
+						break;
+					_heap[pos] = _heap[child];
+					pos = child;
+				}
+				_heap[pos] = last;
+			}
+
+			if (!top.vertex->closed && top.costF == top.vertex->costF)
+				return top.vertex;
+		}
+
+		return NULL;
+	}
+
+private:
+	struct Entry {
+		uint32 costF;
+		uint32 order;
+		Vertex *vertex;
+	};
+
+	static bool before(const Entry &a, const Entry &b) {
+		return a.costF < b.costF || (a.costF == b.costF && a.order > b.order);
+	}
+
+	Common::Array<Entry> _heap;
+	uint32 _order;
+};
+
 /**
  * Computes a shortest path from vertex_start to vertex_end. The caller can
  * construct the resulting path by following the path_prev links from
@@ -1310,40 +1689,23 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
  * Parameters: (PathfindingState *) s: The pathfinding state
  */
 static void AStar(PathfindingState *s) {
-	// Vertices of which the shortest path is known
-	VertexList closedSet;
-
 	// The remaining vertices
-	VertexList openSet;
+	OpenSet openSet;
 
-	openSet.push_front(s->vertex_start);
 	s->vertex_start->costG = 0;
 	s->vertex_start->costF = (uint32)sqrt((float)s->vertex_start->v.sqrDist(s->vertex_end->v));
+	openSet.push(s->vertex_start);
 
-	while (!openSet.empty()) {
-		// Find vertex in open set with lowest F cost
-		VertexList::iterator vertex_min_it = openSet.end();
-		Vertex *vertex_min = 0;
-		uint32 min = HUGE_DISTANCE;
-
-		for (VertexList::iterator it = openSet.begin(); it != openSet.end(); ++it) {
-			Vertex *vertex = *it;
-			if (vertex->costF < min) {
-				vertex_min_it = it;
-				vertex_min = *vertex_min_it;
-				min = vertex->costF;
-			}
-		}
-
-		assert(vertex_min != 0);	// the vertex cost should never be bigger than HUGE_DISTANCE
+	// Vertex in open set with lowest F cost
+	Vertex *vertex_min;
 
+	while ((vertex_min = openSet.pop())) {
 		// Check if we are done
 		if (vertex_min == s->vertex_end)
 			break;
 
 		// Move vertex from set open to set closed
-		closedSet.push_front(vertex_min);
-		openSet.erase(vertex_min_it);
+		vertex_min->closed = true;
 
 		VertexList *visVerts = visible_vertices(s, vertex_min);
 
@@ -1351,12 +1713,9 @@ static void AStar(PathfindingState *s) {
 			uint32 new_dist;
 			Vertex *vertex = *it;
 
-			if (closedSet.contains(vertex))
+			if (vertex->closed)
 				continue;
 
-			if (!openSet.contains(vertex))
-				openSet.push_front(vertex);
-
 			new_dist = vertex_min->costG + (uint32)sqrt((float)vertex_min->v.sqrDist(vertex->v));
 
 			// When travelling to a vertex on the screen edge, we
@@ -1382,13 +1741,14 @@ static void AStar(PathfindingState *s) {
 				vertex->costG = new_dist;
 				vertex->costF = vertex->costG + (uint32)sqrt((float)vertex->v.sqrDist(s->vertex_end->v));
 				vertex->path_prev = vertex_min;
+				openSet.push(vertex);
 			}
 		}
 
 		delete visVerts;
 	}
 
-	if (openSet.empty())
+	if (!vertex_min)
 		debugC(kDebugLevelAvoidPath, "AvoidPath: End point (%i, %i) is unreachable", s->vertex_end->v.x, s->vertex_end->v.y);
 }
 
@@ -1579,6 +1939,59 @@ reg_t kAvoidPath(EngineState *s, int argc, reg_t *argv) {
 	}
 }
 
+void freeAvoidPathCache() {
+	for (int i = 0; i < VISIBILITY_GRAPHS; i++) {
+		delete s_visibilityGraphs[i];
+		s_visibilityGraphs[i] = NULL;
+	}
+
+	delete s_avoidPathCalls;
+	s_avoidPathCalls = NULL;
+	s_avoidPathCallsToRecord = 0;
+}
+
+void recordAvoidPathCalls(uint count) {
+	if (!s_avoidPathCalls)
+		s_avoidPathCalls = new Common::Array<AvoidPathCall>();
+
+	s_avoidPathCalls->clear();
+	s_avoidPathCallsToRecord = count;
+}
+
+uint getRecordedAvoidPathCallCount() {
+	return s_avoidPathCalls ? s_avoidPathCalls->size() : 0;
+}
+
+bool benchmarkAvoidPath(EngineState *s, int passes, uint32 &uncachedTime, uint32 &cachedTime) {
+	if (!getRecordedAvoidPathCallCount())
+		return false;
+
+	for (int cached = 0; cached < 2; cached++) {
+		s_visibilityGraphsEnabled = (cached != 0);
+		const uint32 startTime = g_system->getMillis();
+
+		for (int pass = 0; pass < passes; pass++) {
+			for (uint i = 0; i < s_avoidPathCalls->size(); i++) {
+				const AvoidPathCall &call = (*s_avoidPathCalls)[i];
+				PathfindingState *p = new PathfindingState(call.width, call.height);
+
+				restore_polygons(call.polygons, p->polygons);
+				p = init_pathfinding_state(s, p, call.polygons, call.start, call.end, call.opt);
+
+				if (p) {
+					AStar(p);
+					delete p;
+				}
+			}
+		}
+
+		(cached ? cachedTime : uncachedTime) = g_system->getMillis() - startTime;
+	}
+
+	s_visibilityGraphsEnabled = true;
+	return true;
+}
+
 static bool PointInRect(const Common::Point &point, int16 rectX1, int16 rectY1, int16 rectX2, int16 rectY2) {
 	int16 top = MIN<int16>(rectY1, rectY2);
 	int16 left = MIN<int16>(rectX1, rectX2);
@@ -242,6 +242,11 @@ void SegManager::saveLoadWithSerializer(Common::Serializer &s) {
 			}
 		}
 	}
+
+	// Lookups done while the scripts were being restored may have been
+	// cached from incomplete objects
+	if (s.isLoading())
+		_selectorLookupCache.invalidate();
 }
 
 
@@ -894,6 +899,7 @@ void gamestate_restore(EngineState *s, Common::SeekableReadStream *fh) {
 	s->_segMan->reconstructClones();
 	s->initGlobals();
 	s->gcCountDown = GC_INTERVAL - 1;
+	s->gcPending = false;
 
 	// Time state:
 	s->lastWaitTime = g_system->getMillis();
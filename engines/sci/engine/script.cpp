@@ -75,6 +75,10 @@ void Script::load(int script_nr, ResourceManager *resMan) {
 	_nr = script_nr;
 	_bufSize = _scriptSize = script->size;
 
+	// Load the pics and views this script uses while the engine is idle,
+	// instead of when the game actually draws them
+	resMan->prefetchScriptDependencies(script);
+
 	if (getSciVersion() == SCI_VERSION_0_EARLY) {
 		_bufSize += READ_LE_UINT16(script->data) * 2;
 	} else if (getSciVersion() >= SCI_VERSION_1_1 && getSciVersion() <= SCI_VERSION_2_1) {
@@ -153,6 +153,7 @@ void SegManager::deallocate(SegmentId seg) {
 	if (mobj->getType() == SEG_TYPE_SCRIPT) {
 		Script *scr = (Script *)mobj;
 		_scriptSegMap.erase(scr->getScriptNumber());
+		_selectorLookupCache.invalidate();
 		if (scr->getLocalsSegment()) {
 			// Check if the locals segment has already been deallocated.
 			// If the locals block has been stored in a segment with an ID
@@ -979,6 +980,9 @@ int SegManager::instantiateScript(int scriptNum) {
 	scr->initializeClasses(this);
 	scr->initializeObjects(this, segmentId);
 
+	// The script may have been loaded at the address of another one
+	_selectorLookupCache.invalidate();
+
 	return segmentId;
 }
 
@@ -1009,6 +1013,7 @@ void SegManager::uninstantiateScript(int script_nr) {
 	if (!scr->getLockers()) {
 		// The actual script deletion seems to be done by SCI scripts themselves
 		scr->markDeleted();
+		_selectorLookupCache.invalidate();
 		debugC(kDebugLevelScripts, "Unloaded script 0x%x.", script_nr);
 	}
 }
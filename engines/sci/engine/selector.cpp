@@ -250,9 +250,81 @@ void invokeSelector(EngineState *s, reg_t object, int selectorId,
 	run_vm(s); // Start a new vm
 }
 
+SelectorLookupCache::SelectorLookupCache() : _enabled(true), _traceRemaining(0) {
+	resetStats();
+}
+
+SelectorLookupCache::Key SelectorLookupCache::makeKey(const Object *obj, Selector selectorId) {
+	Key key;
+	key.pos = obj->getPos();
+	key.superClass = obj->getSuperClassSelector();
+	key.selector = selectorId;
+	key.isClass = obj->isClass();
+	return key;
+}
+
+const SelectorLookupCache::Entry *SelectorLookupCache::find(const Object *obj, Selector selectorId) {
+	_stats.lookups++;
+
+	EntryMap::iterator i = _entries.find(makeKey(obj, selectorId));
+	if (i == _entries.end())
+		return 0;
+
+	_stats.hits++;
+	return &i->_value;
+}
+
+void SelectorLookupCache::store(const Object *obj, Selector selectorId, const Entry &entry) {
+	_entries.setVal(makeKey(obj, selectorId), entry);
+}
+
+void SelectorLookupCache::invalidate() {
+	if (!_entries.size())
+		return;
+
+	_entries.clear();
+	_stats.invalidations++;
+}
+
+void SelectorLookupCache::resetStats() {
+	_stats.lookups = 0;
+	_stats.hits = 0;
+	_stats.invalidations = 0;
+}
+
+void SelectorLookupCache::startTrace(uint count) {
+	_trace.clear();
+	_trace.reserve(count);
+	_traceRemaining = count;
+}
+
+static SelectorType lookupSelectorUncached(SegManager *segMan, const Object *obj, Selector selectorId, SelectorLookupCache::Entry &entry) {
+	entry.varIndex = obj->locateVarSelector(segMan, selectorId);
+	entry.function = NULL_REG;
+
+	if (entry.varIndex >= 0) {
+		// Found it as a variable
+		entry.type = kSelectorVariable;
+	} else {
+		// Check if it's a method, with recursive lookup in superclasses
+		entry.type = kSelectorNone;
+		while (obj) {
+			int index = obj->funcSelectorPosition(selectorId);
+			if (index >= 0) {
+				entry.function = obj->getFunction(index);
+				entry.type = kSelectorMethod;
+				break;
+			}
+
+			obj = segMan->getObject(obj->getSuperClassSelector());
+		}
+	}
+
+	return entry.type;
+}
+
 SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector selectorId, ObjVarRef *varp, reg_t *fptr) {
 	const Object *obj = segMan->getObject(obj_location);
-	int index;
 	bool oldScriptHeader = (getSciVersion() == SCI_VERSION_0_EARLY);
 
 	// Early SCI versions used the LSB in the selector ID as a read/write
@@ -265,34 +337,31 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 				PRINT_REG(obj_location));
 	}
 
-	index = obj->locateVarSelector(segMan, selectorId);
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+	SelectorLookupCache::Entry uncached;
+	const SelectorLookupCache::Entry *entry = 0;
 
-	if (index >= 0) {
-		// Found it as a variable
+	if (cache.isEnabled())
+		entry = cache.find(obj, selectorId);
+
+	if (!entry) {
+		lookupSelectorUncached(segMan, obj, selectorId, uncached);
+		if (cache.isEnabled())
+			cache.store(obj, selectorId, uncached);
+		entry = &uncached;
+	}
+
+	if (entry->type == kSelectorVariable) {
 		if (varp) {
 			varp->obj = obj_location;
-			varp->varindex = index;
+			varp->varindex = entry->varIndex;
 		}
-		return kSelectorVariable;
-	} else {
-		// Check if it's a method, with recursive lookup in superclasses
-		while (obj) {
-			index = obj->funcSelectorPosition(selectorId);
-			if (index >= 0) {
-				if (fptr)
-					*fptr = obj->getFunction(index);
-
-				return kSelectorMethod;
-			} else {
-				obj = segMan->getObject(obj->getSuperClassSelector());
-			}
-		}
-
-		return kSelectorNone;
+	} else if (entry->type == kSelectorMethod) {
+		if (fptr)
+			*fptr = entry->function;
 	}
 
-
-//	return _lookupSelector_function(segMan, obj, selectorId, fptr);
+	return entry->type;
 }
 
 } // End of namespace Sci
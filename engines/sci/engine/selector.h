@@ -24,6 +24,8 @@
 #define SCI_ENGINE_SELECTOR_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
+#include "common/flathashmap.h"
 
 #include "sci/engine/vm_types.h"	// for reg_t
 #include "sci/engine/vm.h"
@@ -156,6 +158,120 @@ struct SelectorCache {
 #endif
 };
 
+class Object;
+
+/**
+ * Caches the results of lookupSelector().
+ *
+ * Where a selector lives only depends on the script object an object was
+ * created from (its position, which clones share with their parent), on
+ * its superclass and on the selector itself. All instances and clones of
+ * an object therefore share their cache entries. The entries refer to
+ * script addresses, so the cache is invalidated whenever a script is
+ * loaded or unloaded.
+ *
+ * For benchmarking, the cache can also record a trace of the sends done
+ * by the VM, which can then be replayed with and without the cache.
+ */
+class SelectorLookupCache {
+public:
+	struct Entry {
+		SelectorType type;
+		int varIndex;
+		reg_t function;
+	};
+
+	struct Stats {
+		uint32 lookups;
+		uint32 hits;
+		uint32 invalidations;
+	};
+
+	struct TraceEntry {
+		reg_t object;
+		Selector selector;
+	};
+
+	SelectorLookupCache();
+
+	/**
+	 * Returns the cached lookup of the selector in the object, or 0 if the
+	 * lookup has not been cached yet.
+	 */
+	const Entry *find(const Object *obj, Selector selectorId);
+
+	/**
+	 * Stores the result of looking up the selector in the object.
+	 */
+	void store(const Object *obj, Selector selectorId, const Entry &entry);
+
+	/**
+	 * Drops all cached lookups. Has to be called whenever scripts are
+	 * loaded or unloaded.
+	 */
+	void invalidate();
+
+	void setEnabled(bool enabled) { _enabled = enabled; }
+	bool isEnabled() const { return _enabled; }
+
+	const Stats &getStats() const { return _stats; }
+	void resetStats();
+	uint getEntryCount() const { return _entries.size(); }
+
+	/**
+	 * Records the next 'count' sends done by the VM.
+	 */
+	void startTrace(uint count);
+
+	/**
+	 * Called by the VM for every send, adds the send to the trace if one is
+	 * being recorded.
+	 */
+	void traceSend(reg_t object, Selector selectorId) {
+		if (_traceRemaining) {
+			TraceEntry entry = { object, selectorId };
+			_trace.push_back(entry);
+			_traceRemaining--;
+		}
+	}
+
+	const Common::Array<TraceEntry> &getTrace() const { return _trace; }
+	uint getTraceRemaining() const { return _traceRemaining; }
+
+private:
+	struct Key {
+		reg_t pos;
+		reg_t superClass;
+		Selector selector;
+		bool isClass;
+
+		bool operator==(const Key &x) const {
+			return pos == x.pos && superClass == x.superClass && selector == x.selector && isClass == x.isClass;
+		}
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const {
+			uint hash = key.pos.getSegment();
+			hash = hash * 31 + key.pos.getOffset();
+			hash = hash * 31 + key.superClass.getSegment();
+			hash = hash * 31 + key.superClass.getOffset();
+			return hash * 31 + (uint16)key.selector + (key.isClass ? 1 : 0);
+		}
+	};
+
+	static Key makeKey(const Object *obj, Selector selectorId);
+
+	typedef Common::FlatHashMap<Key, Entry, KeyHash> EntryMap;
+
+	EntryMap _entries;
+	bool _enabled;
+	Stats _stats;
+
+	Common::Array<TraceEntry> _trace;
+	uint _traceRemaining;
+};
+
 /**
  * Map a selector name to a selector id. Shortcut for accessing the selector cache.
  */
@@ -104,6 +104,7 @@ void EngineState::reset(bool isRestoring) {
 	lastWaitTime = 0;
 
 	gcCountDown = 0;
+	gcPending = false;
 
 	_throttleCounter = 0;
 	_throttleLastTime = 0;
@@ -144,13 +145,15 @@ void EngineState::speedThrottler(uint32 neededSleep) {
 	}
 }
 
-void EngineState::wait(int16 ticks) {
+void EngineState::wait(int16 ticks, uint32 elapsed) {
 	uint32 time = g_system->getMillis();
 	r_acc = make_reg(0, ((long)time - (long)lastWaitTime) * 60 / 1000);
 	lastWaitTime = time;
 
 	ticks *= g_debug_sleeptime_factor;
-	g_sci->sleep(ticks * 1000 / 60);
+
+	const int32 sleepTime = ticks * 1000 / 60 - (int32)elapsed;
+	g_sci->sleep(MAX<int32>(sleepTime, 0));
 }
 
 void EngineState::initGlobals() {
@@ -111,7 +111,11 @@ public:
 	uint32 _screenUpdateTime;	/**< The last time the game updated the screen */
 
 	void speedThrottler(uint32 neededSleep);
-	void wait(int16 ticks);
+	/**
+	 * Sleeps for the given number of ticks, minus the elapsed milliseconds
+	 * which the caller already spent.
+	 */
+	void wait(int16 ticks, uint32 elapsed = 0);
 
 	uint32 _throttleCounter; /**< total times kAnimate was invoked */
 	uint32 _throttleLastTime; /**< last time kAnimate was invoked */
@@ -184,6 +188,7 @@ public:
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	bool gcPending; /**< A gc is due and waits for the game's next frame */
 
 	MessageState *_msgState;
 
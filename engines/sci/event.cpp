@@ -327,7 +327,10 @@ void SciEngine::sleep(uint32 msecs) {
 		_eventMan->getSciEvent(SCI_EVENT_PEEK);
 		time = g_system->getMillis();
 		if (time + 10 < wakeup_time) {
-			g_system->delayMillis(10);
+			// Use the idle time to load resources the game will need soon.
+			// Loading one large resource may overrun the wakeup time a bit.
+			if (!_resMan->processPrefetchQueue(wakeup_time - 10))
+				g_system->delayMillis(10);
 		} else {
 			if (time < wakeup_time)
 				g_system->delayMillis(wakeup_time - time);
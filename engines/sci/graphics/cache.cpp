@@ -30,6 +30,7 @@
 #include "sci/graphics/cache.h"
 #include "sci/graphics/font.h"
 #include "sci/graphics/fontsjis.h"
+#include "sci/graphics/screen.h"
 #include "sci/graphics/view.h"
 
 namespace Sci {
@@ -41,6 +42,7 @@ GfxCache::GfxCache(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palet
 GfxCache::~GfxCache() {
 	purgeFontCache();
 	purgeViewCache();
+	purgePictureCache();
 }
 
 void GfxCache::purgeFontCache() {
@@ -61,6 +63,13 @@ void GfxCache::purgeViewCache() {
 	_cachedViews.clear();
 }
 
+void GfxCache::purgePictureCache() {
+	for (PictureCache::iterator iter = _cachedPictures.begin(); iter != _cachedPictures.end(); ++iter)
+		delete[] iter->bits;
+
+	_cachedPictures.clear();
+}
+
 GfxFont *GfxCache::getFont(GuiResourceId fontId) {
 	if (_cachedFonts.size() >= MAX_CACHED_FONTS)
 		purgeFontCache();
@@ -106,4 +115,50 @@ byte GfxCache::kernelViewGetColorAtCoordinate(GuiResourceId viewId, int16 loopNo
 	return getView(viewId)->getColorAtCoordinate(loopNo, celNo, x, y);
 }
 
+bool GfxCache::restorePicture(GuiResourceId pictureId, bool mirrored, int16 EGApaletteNo, const Common::Rect &rect) {
+	bool undithered = _screen->isUnditheringEnabled();
+
+	for (PictureCache::iterator iter = _cachedPictures.begin(); iter != _cachedPictures.end(); ++iter) {
+		if (iter->pictureId == pictureId && iter->mirrored == mirrored && iter->EGApaletteNo == EGApaletteNo
+			&& iter->undithered == undithered && iter->rect == rect) {
+			_screen->bitsRestore(iter->bits);
+
+			// Move it to the front
+			if (iter != _cachedPictures.begin()) {
+				CachedPicture picture = *iter;
+				_cachedPictures.erase(iter);
+				_cachedPictures.push_front(picture);
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void GfxCache::cachePicture(GuiResourceId pictureId, bool mirrored, int16 EGApaletteNo, const Common::Rect &rect) {
+	CachedPicture picture;
+
+	if (_cachedPictures.size() >= MAX_CACHED_PICTURES) {
+		// Reuse the buffer of the least recently used picture, all of them
+		// cover the same screen area in practice
+		picture = _cachedPictures.back();
+		_cachedPictures.pop_back();
+		if (picture.rect != rect) {
+			delete[] picture.bits;
+			picture.bits = new byte[_screen->bitsGetDataSize(rect, GFX_SCREEN_MASK_ALL)];
+		}
+	} else {
+		picture.bits = new byte[_screen->bitsGetDataSize(rect, GFX_SCREEN_MASK_ALL)];
+	}
+
+	picture.pictureId = pictureId;
+	picture.mirrored = mirrored;
+	picture.EGApaletteNo = EGApaletteNo;
+	picture.undithered = _screen->isUnditheringEnabled();
+	picture.rect = rect;
+	_screen->bitsSave(rect, GFX_SCREEN_MASK_ALL, picture.bits);
+	_cachedPictures.push_front(picture);
+}
+
 } // End of namespace Sci
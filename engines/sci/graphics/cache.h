@@ -24,6 +24,8 @@
 #define SCI_GRAPHICS_CACHE_H
 
 #include "common/hashmap.h"
+#include "common/list.h"
+#include "common/rect.h"
 
 namespace Sci {
 
@@ -34,7 +36,21 @@ typedef Common::HashMap<int, GfxFont *> FontCache;
 typedef Common::HashMap<int, GfxView *> ViewCache;
 
 /**
- * Cache class, handles caching of views/fonts
+ * Screen contents of a vector picture, as drawn before EGA dithering
+ */
+struct CachedPicture {
+	GuiResourceId pictureId;
+	bool mirrored;
+	int16 EGApaletteNo;
+	bool undithered;
+	Common::Rect rect;
+	byte *bits;
+};
+
+typedef Common::List<CachedPicture> PictureCache;
+
+/**
+ * Cache class, handles caching of views/fonts/pictures
  */
 class GfxCache {
 public:
@@ -51,9 +67,23 @@ public:
 
 	byte kernelViewGetColorAtCoordinate(GuiResourceId viewId, int16 loopNo, int16 celNo, int16 x, int16 y);
 
+	/**
+	 * Restores the screen contents of a vector picture, if it got drawn
+	 * with the same parameters into the same screen area before.
+	 * @return false if the picture isn't cached
+	 */
+	bool restorePicture(GuiResourceId pictureId, bool mirrored, int16 EGApaletteNo, const Common::Rect &rect);
+
+	/**
+	 * Saves the screen contents of a freshly drawn vector picture, replacing
+	 * the least recently used picture when the cache is full.
+	 */
+	void cachePicture(GuiResourceId pictureId, bool mirrored, int16 EGApaletteNo, const Common::Rect &rect);
+
 private:
 	void purgeFontCache();
 	void purgeViewCache();
+	void purgePictureCache();
 
 	ResourceManager *_resMan;
 	GfxScreen *_screen;
@@ -61,6 +91,7 @@ private:
 
 	FontCache _cachedFonts;
 	ViewCache _cachedViews;
+	PictureCache _cachedPictures; // most recently used first
 };
 
 } // End of namespace Sci
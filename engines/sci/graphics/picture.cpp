@@ -25,6 +25,7 @@
 
 #include "sci/sci.h"
 #include "sci/engine/state.h"
+#include "sci/graphics/cache.h"
 #include "sci/graphics/screen.h"
 #include "sci/graphics/palette.h"
 #include "sci/graphics/coordadjuster.h"
@@ -35,8 +36,8 @@ namespace Sci {
 
 //#define DEBUG_PICTURE_DRAW
 
-GfxPicture::GfxPicture(ResourceManager *resMan, GfxCoordAdjuster *coordAdjuster, GfxPorts *ports, GfxScreen *screen, GfxPalette *palette, GuiResourceId resourceId, bool EGAdrawingVisualize)
-	: _resMan(resMan), _coordAdjuster(coordAdjuster), _ports(ports), _screen(screen), _palette(palette), _resourceId(resourceId), _EGAdrawingVisualize(EGAdrawingVisualize) {
+GfxPicture::GfxPicture(ResourceManager *resMan, GfxCoordAdjuster *coordAdjuster, GfxPorts *ports, GfxScreen *screen, GfxPalette *palette, GuiResourceId resourceId, bool EGAdrawingVisualize, GfxCache *cache)
+	: _resMan(resMan), _coordAdjuster(coordAdjuster), _ports(ports), _screen(screen), _palette(palette), _cache(cache), _resourceId(resourceId), _EGAdrawingVisualize(EGAdrawingVisualize), _skipVectorDrawing(false) {
 	assert(resourceId != -1);
 	initData(resourceId);
 }
@@ -87,6 +88,25 @@ void GfxPicture::draw(int16 animationNr, bool mirroredFlag, bool addToFlag, int1
 	}
 }
 
+/**
+ * Determines the screen area which may be cached after drawing vector data.
+ * Only pictures drawn into a freshly cleared port covering the screen
+ * below its top are cacheable, as their result doesn't depend on what was
+ * on the screen before.
+ */
+bool GfxPicture::getCacheRect(Common::Rect &rect) {
+	if (!_cache || !_ports || _addToFlag || _EGAdrawingVisualize)
+		return false;
+
+	Port *curPort = _ports->getPort();
+	if (curPort->penMode == 2) // clearing the port inverted it instead
+		return false;
+
+	rect = curPort->rect;
+	_ports->offsetRect(rect);
+	return (rect.left == 0) && (rect.right == _screen->getWidth()) && (rect.bottom == _screen->getHeight()) && (rect.top >= 0);
+}
+
 void GfxPicture::reset() {
 	int16 x, y;
 	for (y = _ports->getPort()->top; y < _screen->getHeight(); y++) {
@@ -522,6 +542,13 @@ void GfxPicture::drawVectorData(byte *data, int dataSize) {
 	if (_EGApaletteNo >= PIC_EGAPALETTE_COUNT)
 		_EGApaletteNo = 0;
 
+	// If we drew this picture before, we restore its screen contents from
+	// the cache. The vector data still gets decoded for palette and priority
+	// band changes, but nothing gets drawn.
+	Common::Rect cacheRect;
+	bool cacheable = getCacheRect(cacheRect);
+	_skipVectorDrawing = cacheable && _cache->restorePicture(_resourceId, _mirroredFlag, _EGApaletteNo, cacheRect);
+
 	if (_resMan->getViewType() == kViewEga) {
 		isEGA = true;
 		// setup default mapping tables
@@ -599,7 +626,8 @@ void GfxPicture::drawVectorData(byte *data, int dataSize) {
 				Common::Point startPoint(oldx, oldy);
 				Common::Point endPoint(x, y);
 				_ports->offsetLine(startPoint, endPoint);
-				_screen->drawLine(startPoint, endPoint, pic_color, pic_priority, pic_control);
+				if (!_skipVectorDrawing)
+					_screen->drawLine(startPoint, endPoint, pic_color, pic_priority, pic_control);
 			}
 			break;
 		case PIC_OP_MEDIUM_LINES: // medium line
@@ -619,7 +647,8 @@ void GfxPicture::drawVectorData(byte *data, int dataSize) {
 				Common::Point startPoint(oldx, oldy);
 				Common::Point endPoint(x, y);
 				_ports->offsetLine(startPoint, endPoint);
-				_screen->drawLine(startPoint, endPoint, pic_color, pic_priority, pic_control);
+				if (!_skipVectorDrawing)
+					_screen->drawLine(startPoint, endPoint, pic_color, pic_priority, pic_control);
 			}
 			break;
 		case PIC_OP_LONG_LINES: // long line
@@ -630,7 +659,8 @@ void GfxPicture::drawVectorData(byte *data, int dataSize) {
 				Common::Point startPoint(oldx, oldy);
 				Common::Point endPoint(x, y);
 				_ports->offsetLine(startPoint, endPoint);
-				_screen->drawLine(startPoint, endPoint, pic_color, pic_priority, pic_control);
+				if (!_skipVectorDrawing)
+					_screen->drawLine(startPoint, endPoint, pic_color, pic_priority, pic_control);
 			}
 			break;
 
@@ -738,7 +768,8 @@ void GfxPicture::drawVectorData(byte *data, int dataSize) {
 					vectorGetAbsCoordsNoMirror(data, curPos, x, y);
 					size = READ_LE_UINT16(data + curPos); curPos += 2;
 					_priority = pic_priority; // set global priority so the cel gets drawn using current priority as well
-					drawCelData(data, _resource->size, curPos, curPos + 8, 0, x, y, 0, 0);
+					if (!_skipVectorDrawing)
+						drawCelData(data, _resource->size, curPos, curPos + 8, 0, x, y, 0, 0);
 					curPos += size;
 					break;
 				case PIC_OPX_EGA_SET_PRIORITY_TABLE:
@@ -781,7 +812,8 @@ void GfxPicture::drawVectorData(byte *data, int dataSize) {
 					vectorGetAbsCoordsNoMirror(data, curPos, x, y);
 					size = READ_LE_UINT16(data + curPos); curPos += 2;
 					_priority = pic_priority; // set global priority so the cel gets drawn using current priority as well
-					drawCelData(data, _resource->size, curPos, curPos + 8, 0, x, y, 0, 0);
+					if (!_skipVectorDrawing)
+						drawCelData(data, _resource->size, curPos, curPos + 8, 0, x, y, 0, 0);
 					curPos += size;
 					break;
 				case PIC_OPX_VGA_PRIORITY_TABLE_EQDIST:
@@ -799,6 +831,9 @@ void GfxPicture::drawVectorData(byte *data, int dataSize) {
 			break;
 		case PIC_OP_TERMINATE:
 			_priority = pic_priority;
+			if (cacheable && !_skipVectorDrawing)
+				_cache->cachePicture(_resourceId, _mirroredFlag, _EGApaletteNo, cacheRect);
+			_skipVectorDrawing = false;
 			// Dithering EGA pictures
 			if (isEGA) {
 				_screen->dither(_addToFlag);
@@ -883,21 +918,34 @@ void GfxPicture::vectorGetPatternTexture(byte *data, int &curPos, int16 pattern_
 	}
 }
 
+/**
+ * A horizontal run of pixels still to be checked by the flood fill, lying
+ * next to a span which was filled on the line at y - dy
+ */
+struct FloodFillSpan {
+	int16 y, left, right, dy;
+
+	FloodFillSpan() : y(0), left(0), right(0), dy(0) {}
+	FloodFillSpan(int16 y_, int16 left_, int16 right_, int16 dy_) : y(y_), left(left_), right(right_), dy(dy_) {}
+};
+
 // WARNING: Do not replace the following code with something else, like generic
 // code. This algo really needs to behave exactly as the one from sierra.
 void GfxPicture::vectorFloodFill(int16 x, int16 y, byte color, byte priority, byte control) {
+	if (_skipVectorDrawing)
+		return;
+
 	Port *curPort = _ports->getPort();
-	Common::Stack<Common::Point> stack;
-	Common::Point p, p1;
+	Common::Stack<FloodFillSpan> stack;
+	Common::Point p;
 	byte screenMask = _screen->getDrawingMask(color, priority, control);
-	byte matchedMask, matchMask;
-	int16 w, e, a_set, b_set;
+	byte matchMask;
+	int16 w, e;
 
 	bool isEGA = (_resMan->getViewType() == kViewEga);
 
 	p.x = x + curPort->left;
 	p.y = y + curPort->top;
-	stack.push(p);
 
 	byte searchColor = _screen->getVisual(p.x, p.y);
 	byte searchPriority = _screen->getPriority(p.x, p.y);
@@ -952,41 +1000,62 @@ void GfxPicture::vectorFloodFill(int16 x, int16 y, byte color, byte priority, by
 	int t = curPort->rect.top + curPort->top;
 	int r = curPort->rect.right + curPort->left - 1;
 	int b = curPort->rect.bottom + curPort->top - 1;
-	while (stack.size()) {
-		p = stack.pop();
-		if ((matchedMask = _screen->isFillMatch(p.x, p.y, matchMask, searchColor, searchPriority, searchControl, isEGA)) == 0) // already filled
-			continue;
-		_screen->putPixel(p.x, p.y, screenMask, color, priority, control);
-		w = p.x;
-		e = p.x;
-		// moving west and east pointers as long as there is a matching color to fill
-		while (w > l && (matchedMask = _screen->isFillMatch(w - 1, p.y, matchMask, searchColor, searchPriority, searchControl, isEGA)))
-			_screen->putPixel(--w, p.y, screenMask, color, priority, control);
-		while (e < r && (matchedMask = _screen->isFillMatch(e + 1, p.y, matchMask, searchColor, searchPriority, searchControl, isEGA)))
-			_screen->putPixel(++e, p.y, screenMask, color, priority, control);
-		// checking lines above and below for possible flood targets
-		a_set = b_set = 0;
-		while (w <= e) {
-			if (p.y > t && (matchedMask = _screen->isFillMatch(w, p.y - 1, matchMask, searchColor, searchPriority, searchControl, isEGA))) { // one line above
-				if (a_set == 0) {
-					p1.x = w;
-					p1.y = p.y - 1;
-					stack.push(p1);
-					a_set = 1;
-				}
-			} else
-				a_set = 0;
-
-			if (p.y < b && (matchedMask = _screen->isFillMatch(w, p.y + 1, matchMask, searchColor, searchPriority, searchControl, isEGA))) { // one line below
-				if (b_set == 0) {
-					p1.x = w;
-					p1.y = p.y + 1;
-					stack.push(p1);
-					b_set = 1;
-				}
-			} else
-				b_set = 0;
-			w++;
+
+	if (!_screen->isFillMatch(p.x, p.y, matchMask, searchColor, searchPriority, searchControl, isEGA)) // already filled
+		return;
+
+	// Fill the line of the starting point, and continue with the lines
+	// above and below it
+	w = p.x;
+	e = p.x;
+	while (w > l && _screen->isFillMatch(w - 1, p.y, matchMask, searchColor, searchPriority, searchControl, isEGA))
+		w--;
+	while (e < r && _screen->isFillMatch(e + 1, p.y, matchMask, searchColor, searchPriority, searchControl, isEGA))
+		e++;
+	_screen->putPixelSpan(w, e, p.y, screenMask, color, priority, control);
+
+	if (p.y > t)
+		stack.push(FloodFillSpan(p.y - 1, w, e, -1));
+	if (p.y < b)
+		stack.push(FloodFillSpan(p.y + 1, w, e, 1));
+
+	// Each span on the stack covers the pixels below or above a filled span
+	// of the previous line. For starting points inside the port, this fills
+	// exactly the same pixels as the original algorithm, which pushed single
+	// pixels instead.
+	while (!stack.empty()) {
+		FloodFillSpan span = stack.pop();
+		int16 scanX = span.left;
+
+		while (scanX <= span.right) {
+			if (!_screen->isFillMatch(scanX, span.y, matchMask, searchColor, searchPriority, searchControl, isEGA)) {
+				scanX++;
+				continue;
+			}
+
+			// moving west and east pointers as long as there is a matching color to fill
+			w = scanX;
+			e = scanX;
+			while (w > l && _screen->isFillMatch(w - 1, span.y, matchMask, searchColor, searchPriority, searchControl, isEGA))
+				w--;
+			while (e < r && _screen->isFillMatch(e + 1, span.y, matchMask, searchColor, searchPriority, searchControl, isEGA))
+				e++;
+			_screen->putPixelSpan(w, e, span.y, screenMask, color, priority, control);
+
+			// Continue in the same direction
+			if (span.dy < 0 ? span.y > t : span.y < b)
+				stack.push(FloodFillSpan(span.y + span.dy, w, e, span.dy));
+
+			// Pixels of the previous line next to the span it came from
+			// haven't been checked yet
+			if (span.dy < 0 ? span.y < b : span.y > t) {
+				if (w < span.left - 1)
+					stack.push(FloodFillSpan(span.y - span.dy, w, span.left - 2, -span.dy));
+				if (e > span.right + 1)
+					stack.push(FloodFillSpan(span.y - span.dy, span.right + 2, e, -span.dy));
+			}
+
+			scanX = e + 1;
 		}
 	}
 }
@@ -1196,6 +1265,9 @@ void GfxPicture::vectorPattern(int16 x, int16 y, byte color, byte priority, byte
 	byte size = code & SCI_PATTERN_CODE_PENSIZE;
 	Common::Rect rect;
 
+	if (_skipVectorDrawing)
+		return;
+
 	// We need to adjust the given coordinates, because the ones given us do not define upper left but somewhat middle
 	y -= size; if (y < 0) y = 0;
 	x -= size; if (x < 0) x = 0;
@@ -35,6 +35,7 @@ enum {
 	SCI_PICTURE_TYPE_SCI32		= 2
 };
 
+class GfxCache;
 class GfxPorts;
 class GfxScreen;
 class GfxPalette;
@@ -45,7 +46,7 @@ class GfxPalette;
  */
 class GfxPicture {
 public:
-	GfxPicture(ResourceManager *resMan, GfxCoordAdjuster *coordAdjuster, GfxPorts *ports, GfxScreen *screen, GfxPalette *palette, GuiResourceId resourceId, bool EGAdrawingVisualize = false);
+	GfxPicture(ResourceManager *resMan, GfxCoordAdjuster *coordAdjuster, GfxPorts *ports, GfxScreen *screen, GfxPalette *palette, GuiResourceId resourceId, bool EGAdrawingVisualize = false, GfxCache *cache = 0);
 	~GfxPicture();
 
 	GuiResourceId getResourceId();
@@ -64,6 +65,7 @@ public:
 private:
 	void initData(GuiResourceId resourceId);
 	void reset();
+	bool getCacheRect(Common::Rect &rect);
 	void drawSci11Vga();
 	void drawCelData(byte *inbuffer, int size, int headerPos, int rlePos, int literalPos, int16 drawX, int16 drawY, int16 pictureX, int16 pictureY);
 	void drawVectorData(byte *data, int size);
@@ -85,6 +87,7 @@ private:
 	GfxPorts *_ports;
 	GfxScreen *_screen;
 	GfxPalette *_palette;
+	GfxCache *_cache;
 
 	int16 _resourceId;
 	Resource *_resource;
@@ -98,6 +101,9 @@ private:
 
 	// If true, we will show the whole EGA drawing process...
 	bool _EGAdrawingVisualize;
+
+	// If true, vector data is only decoded, as its drawing got restored from the cache
+	bool _skipVectorDrawing;
 };
 
 } // End of namespace Sci
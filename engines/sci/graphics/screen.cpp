@@ -242,6 +242,29 @@ void GfxScreen::putPixel(int x, int y, byte drawMask, byte color, byte priority,
 		_controlScreen[offset] = control;
 }
 
+/**
+ * Puts the pixels from left to right (inclusive) of a line, like putPixel()
+ * does for a single pixel.
+ */
+void GfxScreen::putPixelSpan(int left, int right, int y, byte drawMask, byte color, byte priority, byte control) {
+	int offset = y * _pitch + left;
+	int width = right - left + 1;
+
+	if (drawMask & GFX_SCREEN_MASK_VISUAL) {
+		if (!_upscaledHires) {
+			memset(_visualScreen + offset, color, width);
+			memset(_displayScreen + offset, color, width);
+		} else {
+			for (int x = left; x <= right; x++)
+				putPixel(x, y, GFX_SCREEN_MASK_VISUAL, color, 0, 0);
+		}
+	}
+	if (drawMask & GFX_SCREEN_MASK_PRIORITY)
+		memset(_priorityScreen + offset, priority, width);
+	if (drawMask & GFX_SCREEN_MASK_CONTROL)
+		memset(_controlScreen + offset, control, width);
+}
+
 /**
  * This is used to put font pixels onto the screen - we adjust differently, so that we won't
  *  do triple pixel lines in any case on upscaled hires. That way the font will not get distorted
@@ -22,14 +22,17 @@
 
 // Resource library
 
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 
 #include "sci/resource.h"
 #include "sci/resource_intern.h"
 #include "sci/util.h"
+#include "sci/engine/vm.h"	// for op_pushi
 
 namespace Sci {
 
@@ -188,6 +191,8 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : _resMan(resMan), _i
 	_fileOffset = 0;
 	_status = kResStatusNoMalloc;
 	_lockers = 0;
+	_loadCost = 0;
+	_lruCredits = 0;
 	_source = NULL;
 	_header = NULL;
 	_headerSize = 0;
@@ -367,7 +372,9 @@ Common::SeekableReadStream *ResourceManager::getVolumeFile(ResourceSource *sourc
 }
 
 void ResourceManager::loadResource(Resource *res) {
+	const uint32 startTime = g_system->getMillis();
 	res->_source->loadResource(this, res);
+	_cacheStats.loadTime += g_system->getMillis() - startTime;
 }
 
 
@@ -889,8 +896,11 @@ ResourceManager::ResourceManager() {
 void ResourceManager::init(bool initFromFallbackDetector) {
 	_memoryLocked = 0;
 	_memoryLRU = 0;
+	_maxMemoryLRU = MAX_MEMORY;
 	_LRU.clear();
 	_resMap.clear();
+	_prefetchQueue.clear();
+	resetCacheStats();
 	_audioMapSCI1 = NULL;
 
 	// FIXME: put this in an Init() function, so that we can error out if detection fails completely
@@ -941,6 +951,18 @@ void ResourceManager::init(bool initFromFallbackDetector) {
 
 	debugC(1, kDebugLevelResMan, "resMan: Detected %s", getSciVersionDesc(getSciVersion()));
 
+	// Later games have much larger resources, which would constantly get
+	// freed and decompressed again with the tiny budget of the early ones.
+#ifndef REDUCE_MEMORY_USAGE
+	if (getSciVersion() >= SCI_VERSION_2)
+		_maxMemoryLRU = MAX_MEMORY_SCI32;
+	else if (getSciVersion() >= SCI_VERSION_1_1)
+		_maxMemoryLRU = MAX_MEMORY_SCI11;
+#endif
+	if (ConfMan.hasKey("resource_cache_size"))
+		_maxMemoryLRU = MAX(ConfMan.getInt("resource_cache_size"), 0) * 1024;
+	debugC(1, kDebugLevelResMan, "resMan: Keeping up to %d KB of unlocked resources", _maxMemoryLRU / 1024);
+
 	switch (_viewType) {
 	case kViewEga:
 		debugC(1, kDebugLevelResMan, "resMan: Detected EGA graphic resources");
@@ -1004,6 +1026,7 @@ void ResourceManager::addToLRU(Resource *res) {
 	}
 	_LRU.push_front(res);
 	_memoryLRU += res->size;
+	res->_lruCredits = res->_loadCost;
 #if SCI_VERBOSE_RESMAN
 	debug("Adding %s.%03d (%d bytes) to lru control: %d bytes total",
 	      getResourceTypeName(res->type), res->number, res->size,
@@ -1030,17 +1053,107 @@ void ResourceManager::printLRU() {
 }
 
 void ResourceManager::freeOldResources() {
-	while (MAX_MEMORY < _memoryLRU) {
+	while ((int)_maxMemoryLRU < _memoryLRU) {
 		assert(!_LRU.empty());
 		Resource *goner = *_LRU.reverse_begin();
+
+		// Resources which are expensive to load again get sent back to the
+		// front of the queue a few times before actually being freed.
+		if (goner->_lruCredits > 0) {
+			goner->_lruCredits--;
+			_LRU.pop_back();
+			_LRU.push_front(goner);
+			continue;
+		}
+
 		removeFromLRU(goner);
 		goner->unalloc();
+		_cacheStats.evictions++;
 #ifdef SCI_VERBOSE_RESMAN
 		debug("resMan-debug: LRU: Freeing %s.%03d (%d bytes)", getResourceTypeName(goner->type), goner->number, goner->size);
 #endif
 	}
 }
 
+void ResourceManager::prefetchResource(ResourceId id) {
+	if (_prefetchQueue.size() >= MAX_PREFETCH_QUEUE)
+		return;
+
+	Resource *res = testResource(id);
+	if (res && res->_status == kResStatusNoMalloc)
+		_prefetchQueue.push_back(id);
+}
+
+void ResourceManager::prefetchScriptDependencies(const Resource *script) {
+	prefetchResource(ResourceId(kResourceTypePic, script->getNumber()));
+
+	// Look for pushi opcodes (both the word and the byte variant), without
+	// actually disassembling the script. Numbers which happen to be there
+	// just cost some idle time, as only existing resources are queued.
+	const uint16 opPushi = (op_pushi << 1);
+	for (uint32 i = 0; i + 1 < script->size; ++i) {
+		uint16 value;
+		if (script->data[i] == opPushi && i + 2 < script->size)
+			value = READ_SCI11ENDIAN_UINT16(script->data + i + 1);
+		else if (script->data[i] == (opPushi | 1))
+			value = script->data[i + 1];
+		else
+			continue;
+
+		// Small numbers are mostly constants
+		if (value < 10)
+			continue;
+
+		prefetchResource(ResourceId(kResourceTypeView, value));
+		prefetchResource(ResourceId(kResourceTypePic, value));
+	}
+}
+
+bool ResourceManager::processPrefetchQueue(uint32 deadline) {
+	bool loaded = false;
+
+	// The deadline is only checked between loads, a single load can't be
+	// interrupted
+	while (!_prefetchQueue.empty() && g_system->getMillis() < deadline) {
+		if ((uint32)_memoryLRU >= _maxMemoryLRU / 4 * 3) {
+			_prefetchQueue.clear();
+			break;
+		}
+
+		Resource *res = testResource(_prefetchQueue.front());
+		_prefetchQueue.pop_front();
+		if (!res || res->_status != kResStatusNoMalloc)
+			continue;
+
+		loadResource(res);
+		if (res->_status != kResStatusAllocated)
+			continue;
+
+		// Put the resource at the end of the LRU without any credits, so
+		// that it is the first one to go if it is not needed after all
+		addToLRU(res);
+		_LRU.pop_front();
+		_LRU.push_back(res);
+		res->_lruCredits = 0;
+		_cacheStats.prefetched++;
+		loaded = true;
+	}
+
+	if (loaded)
+		freeOldResources();
+
+	return loaded;
+}
+
+void ResourceManager::resetCacheStats() {
+	memset(&_cacheStats, 0, sizeof(_cacheStats));
+}
+
+void ResourceManager::setMaxMemory(uint32 maxMemory) {
+	_maxMemoryLRU = maxMemory;
+	freeOldResources();
+}
+
 Common::List<ResourceId> ResourceManager::listResources(ResourceType type, int mapNumber) {
 	Common::List<ResourceId> resources;
 
@@ -1060,10 +1173,14 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
+	if (retval->_status == kResStatusNoMalloc) {
+		_cacheStats.misses++;
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
-		removeFromLRU(retval);
+	} else {
+		_cacheStats.hits++;
+		if (retval->_status == kResStatusEnqueued)
+			removeFromLRU(retval);
+	}
 	// Unless an error occurred, the resource is now either
 	// locked or allocated, but never queued or freed.
 
@@ -2003,6 +2120,20 @@ int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file
 		return SCI_ERROR_UNKNOWN_COMPRESSION;
 	}
 
+	// Post-processing of LZW1 views and pics makes them the most expensive
+	// resources to load again
+	switch (compression) {
+	case kCompNone:
+		_loadCost = 0;
+		break;
+	case kCompLZW1View:
+	case kCompLZW1Pic:
+		_loadCost = 2;
+		break;
+	default:
+		_loadCost = 1;
+	}
+
 	data = new byte[size];
 	_status = kResStatusAllocated;
 	errorNum = data ? dec->unpack(file, data, szPacked, size) : SCI_ERROR_RESOURCE_TOO_BIG;
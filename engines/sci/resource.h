@@ -240,6 +240,8 @@ protected:
 	int32 _fileOffset; /**< Offset in file */
 	ResourceStatus _status;
 	uint16 _lockers; /**< Number of places where this resource was locked */
+	byte _loadCost; /**< Rough cost of reloading the resource, see ResourceManager::freeOldResources() */
+	byte _lruCredits; /**< Rounds the resource may still skip being freed by the LRU */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
@@ -302,6 +304,34 @@ public:
 	 */
 	void unlockResource(Resource *res);
 
+	/**
+	 * Queues a resource to be loaded ahead of time, see processPrefetchQueue().
+	 * @param id	Id of the resource to load
+	 */
+	void prefetchResource(ResourceId id);
+
+	/**
+	 * Queues the pics and views a script most likely needs: the pic with the
+	 * number of the script (rooms conventionally use their own number) and
+	 * any existing pic or view whose number is pushed as an immediate value
+	 * by the script code.
+	 * @param script	The script resource to scan
+	 */
+	void prefetchScriptDependencies(const Resource *script);
+
+	/**
+	 * Loads queued resources into the LRU until the queue is empty or the
+	 * given time is reached. Meant to be called while the engine is idle.
+	 * Prefetching stops when the LRU budget is mostly used up, so that it
+	 * never pushes out resources which are actually in use.
+	 * @note The deadline is soft: it is only checked before each resource
+	 *       is loaded, so loading a large resource may run past it.
+	 * @param deadline	Time (as returned by OSystem::getMillis()) after which
+	 *					no further resource is loaded
+	 * @return true if any resource was loaded
+	 */
+	bool processPrefetchQueue(uint32 deadline);
+
 	/**
 	 * Tests whether a resource exists.
 	 *
@@ -378,15 +408,47 @@ public:
 	 */
 	ResourceType convertResType(byte type);
 
+	/** Counters for the resource cache, shown by the resource_cache console command */
+	struct CacheStats {
+		uint32 hits;		///< Number of findResource() calls served from memory
+		uint32 misses;		///< Number of findResource() calls which had to load the resource
+		uint32 evictions;	///< Number of resources freed to stay within the memory budget
+		uint32 loadTime;	///< Total time spent loading and decompressing resources, in ms
+		uint32 prefetched;	///< Number of resources loaded ahead of time
+	};
+
+	const CacheStats &getCacheStats() const { return _cacheStats; }
+	void resetCacheStats();
+
+	/**
+	 * Sets the number of bytes which may be kept allocated for unlocked
+	 * resources, freeing resources if the new budget is exceeded.
+	 */
+	void setMaxMemory(uint32 maxMemory);
+	uint32 getMaxMemory() const { return _maxMemoryLRU; }
+	int getMemoryLRU() const { return _memoryLRU; }
+	int getMemoryLocked() const { return _memoryLocked; }
+
 protected:
-	// Maximum number of bytes to allow being allocated for resources
-	// Note: maxMemory will not be interpreted as a hard limit, only as a restriction
-	// for resources which are not explicitly locked. However, a warning will be
-	// issued whenever this limit is exceeded.
+	// Default number of bytes to allow being allocated for resources, which
+	// can be overridden with the "resource_cache_size" config key (in KB).
+	// Note: the budget will not be interpreted as a hard limit, only as a
+	// restriction for resources which are not explicitly locked.
 	enum {
-		MAX_MEMORY = 256 * 1024	// 256KB
+		MAX_MEMORY = 256 * 1024,	// 256KB, for SCI0 - SCI1 games
+		MAX_MEMORY_SCI11 = 4 * 1024 * 1024,	// 4MB
+		MAX_MEMORY_SCI32 = 16 * 1024 * 1024	// 16MB
 	};
 
+	uint32 _maxMemoryLRU;	///< Memory budget for resources under LRU control
+	CacheStats _cacheStats;
+
+	enum {
+		MAX_PREFETCH_QUEUE = 64
+	};
+
+	Common::List<ResourceId> _prefetchQueue;	///< Resources to be loaded ahead of time
+
 	ViewType _viewType; // Used to determine if the game has EGA or VGA graphics
 	Common::List<ResourceSource *> _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
@@ -177,6 +177,8 @@ SciEngine::~SciEngine() {
 	delete _features;
 	delete _gfxMacIconBar;
 
+	freeAvoidPathCache();
+
 	delete _eventMan;
 	delete _gamestate->_segMan;
 	delete _gamestate;
@@ -79,6 +79,7 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 	DCmd_Register("scr",       WRAP_METHOD(ScummDebugger, Cmd_Script));
 	DCmd_Register("scripts",   WRAP_METHOD(ScummDebugger, Cmd_PrintScript));
 	DCmd_Register("importres", WRAP_METHOD(ScummDebugger, Cmd_ImportRes));
+	DCmd_Register("resources", WRAP_METHOD(ScummDebugger, Cmd_Resources));
 
 	if (_vm->_game.id == GID_LOOM)
 		DCmd_Register("drafts",  WRAP_METHOD(ScummDebugger, Cmd_PrintDraft));
@@ -862,6 +863,48 @@ bool ScummDebugger::Cmd_Passcode(int argc, const char **argv) {
 	return false;
 }
 
+bool ScummDebugger::Cmd_Resources(int argc, const char **argv) {
+	ResourceManager *res = _vm->_res;
+
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		res->resetExpireStats();
+		DebugPrintf("Resource expiry statistics reset\n");
+		return true;
+	} else if (argc == 4 && !strcmp(argv[1], "threshold")) {
+		int min = atoi(argv[2]);
+		int max = atoi(argv[3]);
+		if (max <= 0 || min < 0 || min > max) {
+			DebugPrintf("Invalid heap thresholds\n");
+			return true;
+		}
+		res->setHeapThreshold(min, max);
+	} else if (argc != 1) {
+		DebugPrintf("Usage: %s [reset | threshold <min> <max>]\n", argv[0]);
+		return true;
+	}
+
+	uint32 loadedNum = 0, lockedNum = 0;
+	for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
+		for (ResId idx = 0; idx < res->_types[type].size(); idx++) {
+			if (res->_types[type][idx]._address) {
+				loadedNum++;
+				if (res->_types[type][idx].isLocked())
+					lockedNum++;
+			}
+		}
+	}
+
+	const ResourceManager::ExpireStats &stats = res->getExpireStats();
+
+	DebugPrintf("Allocated: %d bytes in %d resources, %d of them locked\n", res->getAllocatedSize(), loadedNum, lockedNum);
+	DebugPrintf("Heap thresholds: min %d, max %d\n", res->getMinHeapThreshold(), res->getMaxHeapThreshold());
+	DebugPrintf("Expired: %d resources, %d bytes in %d runs (%d of them could not free enough)\n", stats.resources, stats.size, stats.runs, stats.failedRuns);
+	if (stats.runs)
+		DebugPrintf("Candidates per run: %d\n", stats.candidates / stats.runs);
+
+	return true;
+}
+
 bool ScummDebugger::Cmd_ResetCursors(int argc, const char **argv) {
 	_vm->resetCursors();
 	detach();
@@ -361,6 +361,9 @@ void IMuseDigital::callback() {
 			}
 		}
 	}
+
+	// Prepare the data for the next callback in the background
+	_sound->startReadAhead();
 }
 
 void IMuseDigital::switchToNextRegion(Track *track) {
@@ -35,14 +35,12 @@ BundleDirCache::BundleDirCache() {
 		_budleDirCache[fileId].fileName[0] = 0;
 		_budleDirCache[fileId].numFiles = 0;
 		_budleDirCache[fileId].isCompressed = false;
-		_budleDirCache[fileId].indexTable = NULL;
 	}
 }
 
 BundleDirCache::~BundleDirCache() {
 	for (int fileId = 0; fileId < ARRAYSIZE(_budleDirCache); fileId++) {
 		free(_budleDirCache[fileId].bundleTable);
-		free(_budleDirCache[fileId].indexTable);
 	}
 }
 
@@ -54,8 +52,8 @@ int32 BundleDirCache::getNumFiles(int slot) {
 	return _budleDirCache[slot].numFiles;
 }
 
-BundleDirCache::IndexNode *BundleDirCache::getIndexTable(int slot) {
-	return _budleDirCache[slot].indexTable;
+const BundleDirCache::IndexMap *BundleDirCache::getIndexTable(int slot) {
+	return &_budleDirCache[slot].indexTable;
 }
 
 bool BundleDirCache::isSndDataExtComp(int slot) {
@@ -101,9 +99,7 @@ int BundleDirCache::matchFile(const char *filename) {
 
 		file.seek(offset, SEEK_SET);
 
-		_budleDirCache[freeSlot].indexTable =
-				(IndexNode *)calloc(_budleDirCache[freeSlot].numFiles, sizeof(IndexNode));
-		assert(_budleDirCache[freeSlot].indexTable);
+		_budleDirCache[freeSlot].indexTable.clear();
 
 		for (int32 i = 0; i < _budleDirCache[freeSlot].numFiles; i++) {
 			char name[24], c;
@@ -126,21 +122,19 @@ int BundleDirCache::matchFile(const char *filename) {
 			}
 			_budleDirCache[freeSlot].bundleTable[i].offset = file.readUint32BE();
 			_budleDirCache[freeSlot].bundleTable[i].size = file.readUint32BE();
-			strcpy(_budleDirCache[freeSlot].indexTable[i].filename,
-					_budleDirCache[freeSlot].bundleTable[i].filename);
-			_budleDirCache[freeSlot].indexTable[i].index = i;
+			if (!_budleDirCache[freeSlot].indexTable.contains(_budleDirCache[freeSlot].bundleTable[i].filename))
+				_budleDirCache[freeSlot].indexTable[_budleDirCache[freeSlot].bundleTable[i].filename] = i;
 		}
-		qsort(_budleDirCache[freeSlot].indexTable, _budleDirCache[freeSlot].numFiles,
-				sizeof(IndexNode), (int (*)(const void*, const void*))scumm_stricmp);
 		return freeSlot;
 	} else {
 		return fileId;
 	}
 }
 
-BundleMgr::BundleMgr(BundleDirCache *cache) {
+BundleMgr::BundleMgr(BundleDirCache *cache, bool readAhead) {
 	_cache = cache;
 	_bundleTable = NULL;
+	_indexTable = NULL;
 	_compTable = NULL;
 	_numFiles = 0;
 	_numCompItems = 0;
@@ -148,22 +142,24 @@ BundleMgr::BundleMgr(BundleDirCache *cache) {
 	_fileBundleId = -1;
 	_file = new ScummFile();
 	_compInputBuff = NULL;
+	_numCacheBlocks = readAhead ? kCacheBlocks : 1;
+	_blockCache = (byte *)malloc(_numCacheBlocks * kBlockSize);
+	assert(_blockCache);
+	flushBlockCache();
 }
 
 BundleMgr::~BundleMgr() {
 	close();
 	delete _file;
+	free(_blockCache);
 }
 
 Common::SeekableReadStream *BundleMgr::getFile(const char *filename, int32 &offset, int32 &size) {
-	BundleDirCache::IndexNode target;
-	strcpy(target.filename, filename);
-	BundleDirCache::IndexNode *found = (BundleDirCache::IndexNode *)bsearch(&target, _indexTable, _numFiles,
-			sizeof(BundleDirCache::IndexNode), (int (*)(const void*, const void*))scumm_stricmp);
-	if (found) {
-		_file->seek(_bundleTable[found->index].offset, SEEK_SET);
-		offset = _bundleTable[found->index].offset;
-		size = _bundleTable[found->index].size;
+	BundleDirCache::IndexMap::const_iterator found = _indexTable->find(filename);
+	if (found != _indexTable->end()) {
+		_file->seek(_bundleTable[found->_value].offset, SEEK_SET);
+		offset = _bundleTable[found->_value].offset;
+		size = _bundleTable[found->_value].size;
 		return _file;
 	}
 
@@ -192,8 +188,7 @@ bool BundleMgr::open(const char *filename, bool &compressed, bool errorFlag) {
 	_indexTable = _cache->getIndexTable(slot);
 	assert(_bundleTable);
 	_compTableLoaded = false;
-	_outputSize = 0;
-	_lastBlock = -1;
+	flushBlockCache();
 
 	return true;
 }
@@ -205,8 +200,7 @@ void BundleMgr::close() {
 		_numFiles = 0;
 		_numCompItems = 0;
 		_compTableLoaded = false;
-		_lastBlock = -1;
-		_outputSize = 0;
+		flushBlockCache();
 		_curSampleId = -1;
 		free(_compTable);
 		_compTable = NULL;
@@ -245,6 +239,74 @@ bool BundleMgr::loadCompTable(int32 index) {
 	return true;
 }
 
+void BundleMgr::flushBlockCache() {
+	for (int i = 0; i < _numCacheBlocks; i++)
+		_blockCacheId[i] = -1;
+	_blockCacheNext = 0;
+	_numReadAhead = 0;
+}
+
+int BundleMgr::findCachedBlock(int32 block) const {
+	for (int i = 0; i < _numCacheBlocks; i++) {
+		if (_blockCacheId[i] == block)
+			return i;
+	}
+
+	return -1;
+}
+
+int BundleMgr::decompressBlock(int32 block) {
+	int slot = _blockCacheNext;
+	_blockCacheNext = (_blockCacheNext + 1) % _numCacheBlocks;
+
+	// CMI hack: one more zero byte at the end of input buffer
+	_compInputBuff[_compTable[block].size] = 0;
+	_file->seek(_bundleTable[_curSampleId].offset + _compTable[block].offset, SEEK_SET);
+	_file->read(_compInputBuff, _compTable[block].size);
+	int32 outputSize = BundleCodecs::decompressCodec(_compTable[block].codec, _compInputBuff, _blockCache + slot * kBlockSize, _compTable[block].size);
+	if (outputSize > kBlockSize) {
+		error("_outputSize: %d", outputSize);
+	}
+
+	_blockCacheId[slot] = block;
+	_blockCacheSize[slot] = outputSize;
+
+	return slot;
+}
+
+void BundleMgr::requestReadAhead(int32 offset, int32 size) {
+	if (_numCacheBlocks == 1 || !_compTableLoaded || offset < 0 || size <= 0)
+		return;
+
+	int32 firstBlock = offset / kBlockSize;
+	int32 lastBlock = MIN<int32>((offset + size - 1) / kBlockSize, _numCompItems - 1);
+
+	for (int32 block = firstBlock; block <= lastBlock && _numReadAhead < kMaxReadAhead; block++) {
+		if (findCachedBlock(block) != -1)
+			continue;
+
+		bool requested = false;
+		for (int i = 0; i < _numReadAhead; i++) {
+			if (_readAheadBlocks[i] == block)
+				requested = true;
+		}
+
+		if (!requested)
+			_readAheadBlocks[_numReadAhead++] = block;
+	}
+}
+
+void BundleMgr::readAhead() {
+	if (_file->isOpen() && _compTableLoaded) {
+		for (int i = 0; i < _numReadAhead; i++) {
+			if (findCachedBlock(_readAheadBlocks[i]) == -1)
+				decompressBlock(_readAheadBlocks[i]);
+		}
+	}
+
+	_numReadAhead = 0;
+}
+
 int32 BundleMgr::decompressSampleByCurIndex(int32 offset, int32 size, byte **compFinal, int headerSize, bool headerOutside) {
 	return decompressSampleByIndex(_curSampleId, offset, size, compFinal, headerSize, headerOutside);
 }
@@ -286,19 +348,11 @@ int32 BundleMgr::decompressSampleByIndex(int32 index, int32 offset, int32 size,
 	skip = (offset + headerSize) % 0x2000;
 
 	for (i = firstBlock; i <= lastBlock; i++) {
-		if (_lastBlock != i) {
-			// CMI hack: one more zero byte at the end of input buffer
-			_compInputBuff[_compTable[i].size] = 0;
-			_file->seek(_bundleTable[index].offset + _compTable[i].offset, SEEK_SET);
-			_file->read(_compInputBuff, _compTable[i].size);
-			_outputSize = BundleCodecs::decompressCodec(_compTable[i].codec, _compInputBuff, _compOutputBuff, _compTable[i].size);
-			if (_outputSize > 0x2000) {
-				error("_outputSize: %d", _outputSize);
-			}
-			_lastBlock = i;
-		}
+		int slot = findCachedBlock(i);
+		if (slot == -1)
+			slot = decompressBlock(i);
 
-		outputSize = _outputSize;
+		outputSize = _blockCacheSize[slot];
 
 		if (headerOutside) {
 			outputSize -= skip;
@@ -315,7 +369,7 @@ int32 BundleMgr::decompressSampleByIndex(int32 index, int32 offset, int32 size,
 
 		assert(finalSize + outputSize <= blocksFinalSize);
 
-		memcpy(*compFinal + finalSize, _compOutputBuff + skip, outputSize);
+		memcpy(*compFinal + finalSize, _blockCache + slot * kBlockSize + skip, outputSize);
 		finalSize += outputSize;
 
 		size -= outputSize;
@@ -337,12 +391,9 @@ int32 BundleMgr::decompressSampleByName(const char *name, int32 offset, int32 si
 		return 0;
 	}
 
-	BundleDirCache::IndexNode target;
-	strcpy(target.filename, name);
-	BundleDirCache::IndexNode *found = (BundleDirCache::IndexNode *)bsearch(&target, _indexTable, _numFiles,
-			sizeof(BundleDirCache::IndexNode), (int (*)(const void*, const void*))scumm_stricmp);
-	if (found) {
-		final_size = decompressSampleByIndex(found->index, offset, size, comp_final, 0, header_outside);
+	BundleDirCache::IndexMap::const_iterator found = _indexTable->find(name);
+	if (found != _indexTable->end()) {
+		final_size = decompressSampleByIndex(found->_value, offset, size, comp_final, 0, header_outside);
 		return final_size;
 	}
 
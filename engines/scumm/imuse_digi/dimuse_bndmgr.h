@@ -24,6 +24,8 @@
 
 #include "common/scummsys.h"
 #include "common/file.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 
 namespace Scumm {
 
@@ -37,10 +39,8 @@ public:
 		int32 size;
 	};
 
-	struct IndexNode {
-		char filename[24];
-		int32 index;
-	};
+	/** Maps the file names in a bundle to their index in its table. */
+	typedef Common::HashMap<Common::String, int32, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> IndexMap;
 
 private:
 
@@ -49,7 +49,7 @@ private:
 		AudioTable *bundleTable;
 		int32 numFiles;
 		bool isCompressed;
-		IndexNode *indexTable;
+		IndexMap indexTable;
 	} _budleDirCache[4];
 
 public:
@@ -58,7 +58,7 @@ public:
 
 	int matchFile(const char *filename);
 	AudioTable *getTable(int slot);
-	IndexNode *getIndexTable(int slot);
+	const IndexMap *getIndexTable(int slot);
 	int32 getNumFiles(int slot);
 	bool isSndDataExtComp(int slot);
 };
@@ -73,9 +73,15 @@ private:
 		int32 codec;
 	};
 
+	enum {
+		kBlockSize = 0x2000,
+		kCacheBlocks = 16,    ///< Number of decompressed blocks kept for read ahead
+		kMaxReadAhead = 8     ///< Number of blocks a read ahead may decompress
+	};
+
 	BundleDirCache *_cache;
 	BundleDirCache::AudioTable *_bundleTable;
-	BundleDirCache::IndexNode *_indexTable;
+	const BundleDirCache::IndexMap *_indexTable;
 	CompTable *_compTable;
 
 	int _numFiles;
@@ -84,16 +90,32 @@ private:
 	BaseScummFile *_file;
 	bool _compTableLoaded;
 	int _fileBundleId;
-	byte _compOutputBuff[0x2000];
 	byte *_compInputBuff;
-	int _outputSize;
-	int _lastBlock;
+
+	// Ring of decompressed blocks, replaced oldest first. It only holds
+	// a single block unless read ahead is enabled.
+	byte *_blockCache;
+	int _numCacheBlocks;
+	int32 _blockCacheId[kCacheBlocks];
+	int32 _blockCacheSize[kCacheBlocks];
+	int _blockCacheNext;
+
+	// Blocks to decompress on the next readAhead()
+	int32 _readAheadBlocks[kMaxReadAhead];
+	int _numReadAhead;
 
 	bool loadCompTable(int32 index);
+	void flushBlockCache();
+	int findCachedBlock(int32 block) const;
+	int decompressBlock(int32 block);
 
 public:
 
-	BundleMgr(BundleDirCache *_cache);
+	/**
+	 * Create a bundle manager. With read ahead enabled, it keeps more
+	 * decompressed blocks, so that readAhead() can prepare them.
+	 */
+	BundleMgr(BundleDirCache *_cache, bool readAhead = false);
 	~BundleMgr();
 
 	bool open(const char *filename, bool &compressed, bool errorFlag = false);
@@ -102,6 +124,21 @@ public:
 	int32 decompressSampleByName(const char *name, int32 offset, int32 size, byte **compFinal, bool headerOutside);
 	int32 decompressSampleByIndex(int32 index, int32 offset, int32 size, byte **compFinal, int header_size, bool headerOutside);
 	int32 decompressSampleByCurIndex(int32 offset, int32 size, byte **compFinal, int headerSize, bool headerOutside);
+
+	/**
+	 * Request the blocks holding the given part of the current sample to
+	 * be decompressed by the next readAhead(). The offset is the one passed
+	 * to decompressSampleByCurIndex(), plus the header size. Only has an
+	 * effect if read ahead is enabled.
+	 */
+	void requestReadAhead(int32 offset, int32 size);
+	bool hasReadAhead() const { return _numReadAhead != 0; }
+
+	/**
+	 * Decompress the requested blocks into the block cache. This may run
+	 * on a worker thread, as long as no other method is called meanwhile.
+	 */
+	void readAhead();
 };
 
 } // End of namespace Scumm
@@ -22,6 +22,7 @@
 
 #include "common/scummsys.h"
 #include "common/util.h"
+#include "common/worker.h"
 
 #include "audio/decoders/flac.h"
 #include "audio/decoders/voc.h"
@@ -38,6 +39,12 @@
 
 namespace Scumm {
 
+// How much bundle data to decompress ahead of the position of a track, and
+// of the start of the regions which may follow once it reaches the end of
+// its region.
+static const int32 kReadAheadSize = 0x8000;
+static const int32 kReadAheadRegionSize = 0x2000;
+
 ImuseDigiSndMgr::ImuseDigiSndMgr(ScummEngine *scumm) {
 	for (int l = 0; l < MAX_IMUSE_SOUNDS; l++) {
 		memset(&_sounds[l], 0, sizeof(SoundDesc));
@@ -47,9 +54,21 @@ ImuseDigiSndMgr::ImuseDigiSndMgr(ScummEngine *scumm) {
 	_cacheBundleDir = new BundleDirCache();
 	assert(_cacheBundleDir);
 	BundleCodecs::initializeImcTables();
+
+	// Only read ahead if the backend offers worker threads; otherwise it
+	// would just add to the work done in the callback
+	_readAheadWorker = new Common::Worker();
+	if (!_readAheadWorker->isThreaded()) {
+		delete _readAheadWorker;
+		_readAheadWorker = NULL;
+	}
+	_readAheadPending = false;
 }
 
 ImuseDigiSndMgr::~ImuseDigiSndMgr() {
+	delete _readAheadWorker;
+	_readAheadWorker = NULL;
+
 	for (int l = 0; l < MAX_IMUSE_SOUNDS; l++) {
 		closeSound(&_sounds[l]);
 	}
@@ -320,7 +339,7 @@ ImuseDigiSndMgr::SoundDesc *ImuseDigiSndMgr::allocSlot() {
 bool ImuseDigiSndMgr::openMusicBundle(SoundDesc *sound, int &disk) {
 	bool result = false;
 
-	sound->bundle = new BundleMgr(_cacheBundleDir);
+	sound->bundle = new BundleMgr(_cacheBundleDir, _readAheadWorker != NULL);
 	assert(sound->bundle);
 	if (_vm->_game.id == GID_CMI) {
 		if (_vm->_game.features & GF_DEMO) {
@@ -355,7 +374,7 @@ bool ImuseDigiSndMgr::openMusicBundle(SoundDesc *sound, int &disk) {
 bool ImuseDigiSndMgr::openVoiceBundle(SoundDesc *sound, int &disk) {
 	bool result = false;
 
-	sound->bundle = new BundleMgr(_cacheBundleDir);
+	sound->bundle = new BundleMgr(_cacheBundleDir, _readAheadWorker != NULL);
 	assert(sound->bundle);
 	if (_vm->_game.id == GID_CMI) {
 		if (_vm->_game.features & GF_DEMO) {
@@ -391,6 +410,8 @@ ImuseDigiSndMgr::SoundDesc *ImuseDigiSndMgr::openSound(int32 soundId, const char
 	assert(soundId >= 0);
 	assert(soundType);
 
+	waitReadAhead();
+
 	SoundDesc *sound = allocSlot();
 	if (!sound) {
 		error("ImuseDigiSndMgr::openSound() can't alloc free sound slot");
@@ -472,6 +493,8 @@ ImuseDigiSndMgr::SoundDesc *ImuseDigiSndMgr::openSound(int32 soundId, const char
 void ImuseDigiSndMgr::closeSound(SoundDesc *soundDesc) {
 	assert(checkForProperHandle(soundDesc));
 
+	waitReadAhead();
+
 	if (soundDesc->resPtr) {
 		bool found = false;
 		for (int l = 0; l < MAX_IMUSE_SOUNDS; l++) {
@@ -638,6 +661,8 @@ int32 ImuseDigiSndMgr::getDataFromRegion(SoundDesc *soundDesc, int region, byte
 	assert(buf && offset >= 0 && size >= 0);
 	assert(region >= 0 && region < soundDesc->numRegions);
 
+	waitReadAhead();
+
 	int32 region_offset = soundDesc->region[region].offset;
 	int32 region_length = soundDesc->region[region].length;
 	int32 offset_data = soundDesc->offsetData;
@@ -654,6 +679,8 @@ int32 ImuseDigiSndMgr::getDataFromRegion(SoundDesc *soundDesc, int region, byte
 	bool header_outside = ((_vm->_game.id == GID_CMI) && !(_vm->_game.features & GF_DEMO));
 	if ((soundDesc->bundle) && (!soundDesc->compressed)) {
 		size = soundDesc->bundle->decompressSampleByCurIndex(start + offset, size, buf, header_size, header_outside);
+		if (_readAheadWorker)
+			requestReadAhead(soundDesc, region, offset + size);
 	} else if (soundDesc->resPtr) {
 		*buf = (byte *)malloc(size);
 		assert(*buf);
@@ -731,4 +758,52 @@ int32 ImuseDigiSndMgr::getDataFromRegion(SoundDesc *soundDesc, int region, byte
 	return size;
 }
 
+void ImuseDigiSndMgr::requestReadAhead(SoundDesc *soundDesc, int region, int32 offset) {
+	BundleMgr *bundle = soundDesc->bundle;
+
+	// Positions within the bundle sample, as decompressSampleByCurIndex() sees them
+	int32 pos = soundDesc->region[region].offset + offset;
+	int32 regionEnd = soundDesc->region[region].offset + soundDesc->region[region].length - soundDesc->offsetData;
+
+	bundle->requestReadAhead(pos, MIN(kReadAheadSize, regionEnd - pos));
+
+	// Near the end of the region, also prepare the next region and the
+	// destinations of the jumps taken when switching to it
+	if ((regionEnd - pos < kReadAheadSize) && (region + 1 < soundDesc->numRegions)) {
+		int32 nextOffset = soundDesc->region[region + 1].offset;
+		bundle->requestReadAhead(nextOffset, kReadAheadRegionSize);
+
+		for (int l = 0; l < soundDesc->numJumps; l++) {
+			if (soundDesc->jump[l].offset == nextOffset)
+				bundle->requestReadAhead(soundDesc->jump[l].dest, kReadAheadRegionSize);
+		}
+	}
+
+	if (bundle->hasReadAhead())
+		_readAheadPending = true;
+}
+
+void ImuseDigiSndMgr::readAheadProc(void *arg) {
+	ImuseDigiSndMgr *sndMgr = (ImuseDigiSndMgr *)arg;
+
+	for (int l = 0; l < MAX_IMUSE_SOUNDS; l++) {
+		BundleMgr *bundle = sndMgr->_sounds[l].bundle;
+		if (bundle && bundle->hasReadAhead())
+			bundle->readAhead();
+	}
+}
+
+void ImuseDigiSndMgr::startReadAhead() {
+	if (!_readAheadWorker || !_readAheadPending)
+		return;
+
+	_readAheadPending = false;
+	_readAheadWorker->start(readAheadProc, this);
+}
+
+void ImuseDigiSndMgr::waitReadAhead() {
+	if (_readAheadWorker)
+		_readAheadWorker->wait();
+}
+
 } // End of namespace Scumm
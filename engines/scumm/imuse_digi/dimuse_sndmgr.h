@@ -27,6 +27,10 @@
 #include "audio/audiostream.h"
 #include "scumm/imuse_digi/dimuse_bndmgr.h"
 
+namespace Common {
+class Worker;
+}
+
 namespace Scumm {
 
 class ScummEngine;
@@ -116,6 +120,13 @@ private:
 	byte _disk;
 	BundleDirCache *_cacheBundleDir;
 
+	/** Worker decompressing bundle data ahead of the callback, or 0. */
+	Common::Worker *_readAheadWorker;
+	bool _readAheadPending;
+
+	void requestReadAhead(SoundDesc *soundDesc, int region, int32 offset);
+	static void readAheadProc(void *arg);
+
 	bool openMusicBundle(SoundDesc *sound, int &disk);
 	bool openVoiceBundle(SoundDesc *sound, int &disk);
 
@@ -146,6 +157,15 @@ public:
 	void getSyncSizeAndPtrById(SoundDesc *soundDesc, int number, int32 &sync_size, byte **sync_ptr);
 
 	int32 getDataFromRegion(SoundDesc *soundDesc, int region, byte **buf, int32 offset, int32 size);
+
+	/**
+	 * Start decompressing the bundle data which the tracks will need next,
+	 * as requested by getDataFromRegion(). The work runs on a worker thread
+	 * until the next call touching the bundles.
+	 */
+	void startReadAhead();
+	/** Wait until the bundle data requested by startReadAhead() is ready. */
+	void waitReadAhead();
 };
 
 } // End of namespace Scumm
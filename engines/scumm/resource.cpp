@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/algorithm.h"
 #include "common/str.h"
 #ifndef MACOSX
 #include "common/config-manager.h"
@@ -872,6 +873,7 @@ ResourceManager::ResourceManager(ScummEngine *vm) : _vm(vm) {
 	_maxHeapThreshold = 0;
 	_minHeapThreshold = 0;
 	_expireCounter = 0;
+	resetExpireStats();
 }
 
 ResourceManager::~ResourceManager() {
@@ -885,6 +887,10 @@ void ResourceManager::setHeapThreshold(int min, int max) {
 	_minHeapThreshold = min;
 }
 
+void ResourceManager::resetExpireStats() {
+	memset(&_expireStats, 0, sizeof(_expireStats));
+}
+
 bool ResourceManager::validateResource(const char *str, ResType type, ResId idx) const {
 	if (type < rtFirst || type > rtLast || (uint)idx >= (uint)_types[type].size()) {
 		error("%s Illegal Glob type %s (%d) num %d", str, nameOfResType(type), type, idx);
@@ -1032,10 +1038,19 @@ void ResourceManager::Resource::setOnHeap() {
 	_status &= ~RF_OFFHEAP;
 }
 
+/**
+ * Orders expire candidates like the original interpreters picked them:
+ * the highest counter first, then the highest type and the lowest index.
+ */
+static bool expireCandidateLess(const ResourceManager::ExpireCandidate &a, const ResourceManager::ExpireCandidate &b) {
+	if (a.counter != b.counter)
+		return a.counter > b.counter;
+	if (a.type != b.type)
+		return a.type > b.type;
+	return a.idx < b.idx;
+}
+
 void ResourceManager::expireResources(uint32 size) {
-	byte best_counter;
-	ResType best_type;
-	int best_res = 0;
 	uint32 oldAllocatedSize;
 
 	if (_expireCounter != 0xFF) {
@@ -1048,30 +1063,51 @@ void ResourceManager::expireResources(uint32 size) {
 
 	oldAllocatedSize = _allocatedSize;
 
-	do {
-		best_type = rtInvalid;
-		best_counter = 2;
-
-		for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
-			if (_types[type]._mode != kDynamicResTypeMode) {
-				// Resources of this type can be reloaded from the data files,
-				// so we can potentially unload them to free memory.
-				ResId idx = _types[type].size();
-				while (idx-- > 0) {
-					Resource &tmp = _types[type][idx];
-					byte counter = tmp.getResourceCounter();
-					if (!tmp.isLocked() && counter >= best_counter && tmp._address && !_vm->isResourceInUse(type, idx) && !tmp.isOffHeap()) {
-						best_counter = counter;
-						best_type = type;
-						best_res = idx;
-					}
+	// Collect all resources which may be freed, and sort them by how good
+	// they are to free. Freeing one of them doesn't change whether the
+	// others may be freed, so they can then be freed in this order instead
+	// of scanning all resources again for each of them.
+	_expireCandidates.clear();
+
+	for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
+		if (_types[type]._mode != kDynamicResTypeMode) {
+			// Resources of this type can be reloaded from the data files,
+			// so we can potentially unload them to free memory.
+			ResId idx = _types[type].size();
+			while (idx-- > 0) {
+				Resource &tmp = _types[type][idx];
+				byte counter = tmp.getResourceCounter();
+				if (!tmp.isLocked() && counter >= 2 && tmp._address && !tmp.isOffHeap()) {
+					ExpireCandidate candidate;
+					candidate.type = type;
+					candidate.idx = idx;
+					candidate.counter = counter;
+					_expireCandidates.push_back(candidate);
 				}
 			}
 		}
+	}
+
+	Common::sort(_expireCandidates.begin(), _expireCandidates.end(), expireCandidateLess);
+
+	_expireStats.runs++;
+	_expireStats.candidates += _expireCandidates.size();
+
+	Common::Array<ExpireCandidate>::const_iterator candidate = _expireCandidates.begin();
 
-		if (!best_type)
+	do {
+		while (candidate != _expireCandidates.end() && _vm->isResourceInUse(candidate->type, candidate->idx))
+			++candidate;
+
+		if (candidate == _expireCandidates.end()) {
+			_expireStats.failedRuns++;
 			break;
-		nukeResource(best_type, best_res);
+		}
+
+		_expireStats.resources++;
+		_expireStats.size += _types[candidate->type][candidate->idx]._size;
+		nukeResource(candidate->type, candidate->idx);
+		++candidate;
 	} while (size + _allocatedSize > _minHeapThreshold);
 
 	increaseResourceCounters();
@@ -170,16 +170,50 @@ public:
 	};
 	ResTypeData _types[rtLast + 1];
 
+	/**
+	 * Statistics about freeing resources when the heap grows too large.
+	 */
+	struct ExpireStats {
+		uint32 runs;		///< number of times resources had to be freed
+		uint32 failedRuns;	///< number of times not enough resources could be freed
+		uint32 resources;	///< number of resources freed
+		uint32 size;		///< total size of the resources freed
+		uint32 candidates;	///< total number of resources which could have been freed
+	};
+
+	/**
+	 * A resource which may be freed by expireResources().
+	 */
+	struct ExpireCandidate {
+		ResType type;
+		ResId idx;
+		byte counter;
+	};
+
 protected:
 	uint32 _allocatedSize;
 	uint32 _maxHeapThreshold, _minHeapThreshold;
 	byte _expireCounter;
 
+	ExpireStats _expireStats;
+
+	/**
+	 * The expire candidates, ordered from the best one to free to the worst.
+	 * Only kept as a member to reuse its storage.
+	 */
+	Common::Array<ExpireCandidate> _expireCandidates;
+
 public:
 	ResourceManager(ScummEngine *vm);
 	~ResourceManager();
 
 	void setHeapThreshold(int min, int max);
+	uint32 getMinHeapThreshold() const { return _minHeapThreshold; }
+	uint32 getMaxHeapThreshold() const { return _maxHeapThreshold; }
+	uint32 getAllocatedSize() const { return _allocatedSize; }
+
+	const ExpireStats &getExpireStats() const { return _expireStats; }
+	void resetExpireStats();
 
 	void allocResTypeData(ResType type, uint32 tag, int num, ResTypeMode mode);
 	void freeResources();
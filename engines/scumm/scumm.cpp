@@ -1310,7 +1310,18 @@ void ScummEngine::setupScumm() {
 		maxHeapThreshold = 550000;
 	}
 
-	_res->setHeapThreshold(400000, maxHeapThreshold);
+	int minHeapThreshold = 400000;
+
+	// The thresholds can be tuned per game, e.g. to keep more resources
+	// loaded for HE games with lots of images and sounds
+	if (ConfMan.hasKey("heap_max_threshold"))
+		maxHeapThreshold = MAX(ConfMan.getInt("heap_max_threshold"), 1);
+	if (ConfMan.hasKey("heap_min_threshold"))
+		minHeapThreshold = CLIP(ConfMan.getInt("heap_min_threshold"), 0, maxHeapThreshold);
+	else
+		minHeapThreshold = MIN(minHeapThreshold, maxHeapThreshold);
+
+	_res->setHeapThreshold(minHeapThreshold, maxHeapThreshold);
 
 	free(_compositeBuf);
 	_compositeBuf = (byte *)malloc(_screenWidth * _textSurfaceMultiplier * _screenHeight * _textSurfaceMultiplier * _outputPixelFormat.bytesPerPixel);
@@ -58,6 +58,11 @@ public:
 		release();
 	}
 
+	virtual uint getSize() const {
+		// The frame bitmaps are resources of their own
+		return sizeof(AnimationResource) + _frames.size() * sizeof(Frame);
+	}
+
 	Animation::ANIMATION_TYPES getAnimationType() const {
 		return _animationType;
 	}
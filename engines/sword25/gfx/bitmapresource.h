@@ -60,6 +60,18 @@ public:
 					_pImage(pImage), Resource(filename, Resource::TYPE_BITMAP) {}
 	virtual ~BitmapResource() { delete _pImage; }
 
+	virtual uint getSize() const {
+		// Vector images are rendered to a 32 bpp buffer, too
+		if (!_pImage)
+			return sizeof(BitmapResource);
+		return sizeof(BitmapResource) + _pImage->getWidth() * _pImage->getHeight() * 4;
+	}
+
+	virtual bool isExpensiveToReload() const {
+		// Vector images need to be parsed and tessellated again
+		return getFileName().hasSuffix(".swf");
+	}
+
 	/**
 	    @brief Gibt zurck, ob das Objekt einen gltigen Zustand hat.
 	*/
@@ -61,6 +61,11 @@ public:
 		return _valid;
 	}
 
+	virtual uint getSize() const {
+		// The character bitmap is a resource of its own
+		return sizeof(FontResource);
+	}
+
 	/**
 	    @brief Gibt die Zeilenhhe des Fonts in Pixeln zurck.
 
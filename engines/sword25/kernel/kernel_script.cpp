@@ -29,6 +29,8 @@
  *
  */
 
+#include <limits.h>
+
 #include "sword25/kernel/common.h"
 #include "sword25/kernel/kernel.h"
 #include "sword25/kernel/filesystemutil.h"
@@ -129,9 +131,13 @@ static int getSubversionRevision(lua_State *L) {
 }
 
 static int getUsedMemory(lua_State *L) {
-	// It doesn't really matter what this call returns,
-	// as it's used in a debug function.
-	lua_pushnumber(L, 0);
+	// Only the memory used by the resource cache is tracked
+	Kernel *pKernel = Kernel::getInstance();
+	assert(pKernel);
+	ResourceManager *pResource = pKernel->getResourceManager();
+	assert(pResource);
+
+	lua_pushnumber(L, pResource->getUsedMemory());
 	return 1;
 }
 
@@ -339,9 +345,7 @@ static int getMaxMemoryUsage(lua_State *L) {
 	ResourceManager *pResource = pKernel->getResourceManager();
 	assert(pResource);
 
-	// This is used for debugging, so it doesn't really matter.
-	// The default value set by the scripts is 256000000 bytes
-	lua_pushnumber(L, 256000000);
+	lua_pushnumber(L, pResource->getMaxMemoryUsage());
 
 	return 1;
 }
@@ -352,8 +356,16 @@ static int setMaxMemoryUsage(lua_State *L) {
 	ResourceManager *pResource = pKernel->getResourceManager();
 	assert(pResource);
 
-	// This call is ignored, we set a limit on the number of
-	// simultaneous resources loaded instead.
+	// The scripts set this to 256000000 bytes, which is capped to
+	// the engine's own limit
+	// Clamp the value before converting it, the conversion of out of range
+	// values (including NaN) is undefined
+	lua_Number maxMemoryUsage = luaL_checknumber(L, 1);
+	if (!(maxMemoryUsage >= 1))
+		maxMemoryUsage = 1;
+	else if (maxMemoryUsage > UINT_MAX)
+		maxMemoryUsage = UINT_MAX;
+	pResource->setMaxMemoryUsage(static_cast<uint>(maxMemoryUsage));
 
 	return 0;
 }
@@ -369,6 +381,51 @@ static int emptyCache(lua_State *L) {
 	return 0;
 }
 
+static int isLogCacheMiss(lua_State *L) {
+	Kernel *pKernel = Kernel::getInstance();
+	assert(pKernel);
+	ResourceManager *pResource = pKernel->getResourceManager();
+	assert(pResource);
+
+	lua_pushbooleancpp(L, pResource->isLogCacheMiss());
+
+	return 1;
+}
+
+static int setLogCacheMiss(lua_State *L) {
+	Kernel *pKernel = Kernel::getInstance();
+	assert(pKernel);
+	ResourceManager *pResource = pKernel->getResourceManager();
+	assert(pResource);
+
+	pResource->setLogCacheMiss(lua_tobooleancpp(L, 1));
+
+	return 0;
+}
+
+static void setStatsField(lua_State *L, const char *name, uint value) {
+	lua_pushstring(L, name);
+	lua_pushnumber(L, value);
+	lua_settable(L, -3);
+}
+
+static int getCacheStats(lua_State *L) {
+	Kernel *pKernel = Kernel::getInstance();
+	assert(pKernel);
+	ResourceManager *pResource = pKernel->getResourceManager();
+	assert(pResource);
+
+	lua_newtable(L);
+	setStatsField(L, "ResourceCount", pResource->getResourceCount());
+	setStatsField(L, "UsedMemory", pResource->getUsedMemory());
+	setStatsField(L, "MaxMemoryUsage", pResource->getMaxMemoryUsage());
+	setStatsField(L, "Hits", pResource->getCacheHits());
+	setStatsField(L, "Misses", pResource->getCacheMisses());
+	setStatsField(L, "Evictions", pResource->getCacheEvictions());
+
+	return 1;
+}
+
 static int dumpLockedResources(lua_State *L) {
 	Kernel *pKernel = Kernel::getInstance();
 	assert(pKernel);
@@ -388,8 +445,9 @@ static const luaL_reg RESOURCE_FUNCTIONS[] = {
 	{"GetMaxMemoryUsage", getMaxMemoryUsage},
 	{"SetMaxMemoryUsage", setMaxMemoryUsage},
 	{"EmptyCache", emptyCache},
-	{"IsLogCacheMiss", dummyFuncError},
-	{"SetLogCacheMiss", dummyFuncError},
+	{"IsLogCacheMiss", isLogCacheMiss},
+	{"SetLogCacheMiss", setLogCacheMiss},
+	{"GetCacheStats", getCacheStats},
 	{"DumpLockedResources", dumpLockedResources},
 	{0, 0}
 };
@@ -37,16 +37,31 @@
 
 namespace Sword25 {
 
-// Sets the amount of resources that are simultaneously loaded.
-// This needs to be a relatively high number, as all the animation
-// frames in each scene are loaded as separate resources.
-// Also, George's walk states are all loaded here (150 files)
+// The maximum amount of memory used by the loaded resources. This needs to
+// be relatively high, as all the animation frames in each scene are loaded
+// as separate resources, and so are George's walk states (150 files).
+// Ports with little memory may define a lower limit. The game scripts can
+// lower it further, but not raise it.
+#ifndef SWORD25_RESOURCECACHE_SIZE
+#define SWORD25_RESOURCECACHE_SIZE (128 * 1024 * 1024)
+#endif
+
+// Loaded resources are forcibly unlocked once there are more than
+// SWORD25_RESOURCECACHE_MAX of them, until only SWORD25_RESOURCECACHE_MIN
+// remain. See deleteResourcesIfNecessary().
 #define SWORD25_RESOURCECACHE_MIN 400
-// The maximum number of loaded resources. If more than these resources
-// are loaded, the resource manager will start purging resources till it
-// hits the minimum limit above
 #define SWORD25_RESOURCECACHE_MAX 500
 
+ResourceManager::ResourceManager(Kernel *pKernel) :
+	_kernelPtr(pKernel),
+	_maxMemoryUsage(SWORD25_RESOURCECACHE_SIZE),
+	_usedMemory(0),
+	_cacheHits(0),
+	_cacheMisses(0),
+	_cacheEvictions(0),
+	_logCacheMiss(false) {
+}
+
 ResourceManager::~ResourceManager() {
 	// Clear all unlocked resources
 	emptyCache();
@@ -82,51 +97,98 @@ bool ResourceManager::registerResourceService(ResourceService *pService) {
 	return true;
 }
 
+void ResourceManager::setMaxMemoryUsage(uint maxMemoryUsage) {
+	_maxMemoryUsage = MIN<uint>(maxMemoryUsage, SWORD25_RESOURCECACHE_SIZE);
+	deleteResourcesIfNecessary();
+}
+
 /**
  * Deletes resources as necessary until the specified memory limit is not being exceeded.
+ * The most recently used resource is never deleted.
  */
 void ResourceManager::deleteResourcesIfNecessary() {
-	// If enough memory is available, or no resources are loaded, then the function can immediately end
+	if (_usedMemory > _maxMemoryUsage) {
+		// Release a bit more than necessary, so that the next few loaded resources
+		// don't need to release others again
+		const uint limit = _maxMemoryUsage - _maxMemoryUsage / 8;
+
+		// First release the resources that are cheap to reload, then all others
+		deleteUnlockedResources(limit, false);
+		deleteUnlockedResources(limit, true);
+	}
+
+	// FIXME: This code shouldn't be needed at all, but it seems like there is a bug
+	// in the resource lock code, and resources are not unlocked when changing rooms.
+	// Only image/animation resources are unlocked forcibly, thus this shouldn't have
+	// any impact on the game itself.
+	// This is still triggered by the number of loaded resources, not by the memory
+	// limit, so that going over the memory limit never unlocks resources which are
+	// still in use.
 	if (_resources.size() < SWORD25_RESOURCECACHE_MAX)
 		return;
 
-	// Keep deleting resources until the memory usage of the process falls below the set maximum limit.
-	// The list is processed backwards in order to first release those resources that have been
-	// not been accessed for the longest
+	// Release unlocked resources first
 	Common::List<Resource *>::iterator iter = _resources.end();
-	do {
+	--iter;
+	while (iter != _resources.begin() && _resources.size() >= SWORD25_RESOURCECACHE_MIN) {
+		Resource *pResource = *iter;
 		--iter;
 
-		// The resource may be released only if it isn't locked
-		if ((*iter)->getLockCount() == 0)
-			iter = deleteResource(*iter);
-	} while (iter != _resources.begin() && _resources.size() >= SWORD25_RESOURCECACHE_MIN);
+		if (pResource->getLockCount() == 0) {
+			deleteResource(pResource);
+			++_cacheEvictions;
+		}
+	}
 
 	// Are we still above the minimum? If yes, then start releasing locked resources
-	// FIXME: This code shouldn't be needed at all, but it seems like there is a bug
-	// in the resource lock code, and resources are not unlocked when changing rooms.
-	// Only image/animation resources are unlocked forcibly, thus this shouldn't have
-	// any impact on the game itself.
-	if (_resources.size() <= SWORD25_RESOURCECACHE_MIN)
+	if (_resources.size() < SWORD25_RESOURCECACHE_MIN)
 		return;
 
 	iter = _resources.end();
-	do {
+	--iter;
+	while (iter != _resources.begin() && _resources.size() >= SWORD25_RESOURCECACHE_MIN) {
+		Resource *pResource = *iter;
 		--iter;
 
 		// Only unlock image/animation resources
-		if ((*iter)->getFileName().hasSuffix(".swf") ||
-			(*iter)->getFileName().hasSuffix(".png")) {
+		if (pResource->getFileName().hasSuffix(".swf") ||
+			pResource->getFileName().hasSuffix(".png")) {
 
-			warning("Forcibly unlocking %s", (*iter)->getFileName().c_str());
+			warning("Forcibly unlocking %s", pResource->getFileName().c_str());
 
 			// Forcibly unlock the resource
-			while ((*iter)->getLockCount() > 0)
-				(*iter)->release();
+			while (pResource->getLockCount() > 0)
+				pResource->release();
 
-			iter = deleteResource(*iter);
+			deleteResource(pResource);
+			++_cacheEvictions;
 		}
-	} while (iter != _resources.begin() && _resources.size() >= SWORD25_RESOURCECACHE_MIN);
+	}
+}
+
+/**
+ * Deletes unlocked resources, starting with the least recently used one, until the memory
+ * usage drops to the given limit.
+ */
+void ResourceManager::deleteUnlockedResources(uint limit, bool expensiveToReload) {
+	if (_resources.empty())
+		return;
+
+	// The list is processed backwards in order to first release those resources that have
+	// not been accessed for the longest. The first resource is the one in use right now.
+	Common::List<Resource *>::iterator iter = _resources.end();
+	--iter;
+	while (iter != _resources.begin() && _usedMemory > limit) {
+		Resource *pResource = *iter;
+		--iter;
+
+		// The resource may be released only if it isn't locked
+		if (pResource->getLockCount() == 0 &&
+			(expensiveToReload || !pResource->isExpensiveToReload())) {
+			deleteResource(pResource);
+			++_cacheEvictions;
+		}
+	}
 }
 
 /**
@@ -172,8 +234,14 @@ Resource *ResourceManager::requestResource(const Common::String &fileName) {
 	// Determine whether the resource is already loaded
 	// If the resource is found, it will be placed at the head of the resource list and returned
 	Resource *pResource = getResource(uniqueFileName);
-	if (!pResource)
+	if (pResource) {
+		++_cacheHits;
+	} else {
+		++_cacheMisses;
+		if (_logCacheMiss)
+			debugC(kDebugResource, "Resource cache miss: \"%s\"", uniqueFileName.c_str());
 		pResource = loadResource(uniqueFileName);
+	}
 	if (pResource) {
 		moveToFront(pResource);
 		(pResource)->addReference();
@@ -234,7 +302,7 @@ void ResourceManager::moveToFront(Resource *pResource) {
 }
 
 /**
- * Loads a resource and updates the m_UsedMemory total
+ * Loads a resource and updates the _usedMemory total
  *
  * The resource must not already be loaded
  * @param FileName      The unique filename of the resource to be loaded
@@ -243,9 +311,6 @@ Resource *ResourceManager::loadResource(const Common::String &fileName) {
 	// ResourceService finden, der die Resource laden kann.
 	for (uint i = 0; i < _resourceServices.size(); ++i) {
 		if (_resourceServices[i]->canLoadResource(fileName)) {
-			// If more memory is desired, memory must be released
-			deleteResourcesIfNecessary();
-
 			// Load the resource
 			Resource *pResource = _resourceServices[i]->loadResource(fileName);
 			if (!pResource) {
@@ -260,6 +325,12 @@ Resource *ResourceManager::loadResource(const Common::String &fileName) {
 			// Also store the resource in the hash table for quick lookup
 			_resourceHashMap[pResource->getFileName()] = pResource;
 
+			// Account for the memory used by the resource, and release others if
+			// the cache is now too big
+			pResource->_size = pResource->getSize();
+			_usedMemory += pResource->_size;
+			deleteResourcesIfNecessary();
+
 			return pResource;
 		}
 	}
@@ -290,7 +361,7 @@ Common::String ResourceManager::getUniqueFileName(const Common::String &fileName
 }
 
 /**
- * Deletes a resource, removes it from the lists, and updates m_UsedMemory
+ * Deletes a resource, removes it from the lists, and updates _usedMemory
  */
 Common::List<Resource *>::iterator ResourceManager::deleteResource(Resource *pResource) {
 	// Remove the resource from the hash table
@@ -299,6 +370,9 @@ Common::List<Resource *>::iterator ResourceManager::deleteResource(Resource *pRe
 	// Delete the resource from the resource list
 	Common::List<Resource *>::iterator result = _resources.erase(pResource->_iterator);
 
+	// Update the memory usage
+	_usedMemory -= pResource->_size;
+
 	// Delete the resource
 	delete pResource;
 
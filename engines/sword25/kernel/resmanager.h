@@ -88,14 +88,65 @@ public:
 	 */
 	void dumpLockedResources();
 
+	/**
+	 * Returns the maximum amount of memory the loaded resources may use, in bytes
+	 */
+	uint getMaxMemoryUsage() const {
+		return _maxMemoryUsage;
+	}
+
+	/**
+	 * Sets the maximum amount of memory the loaded resources may use, in bytes.
+	 * The value is capped to SWORD25_RESOURCECACHE_SIZE.
+	 * @param MaxMemoryUsage    The memory limit
+	 */
+	void setMaxMemoryUsage(uint maxMemoryUsage);
+
+	/**
+	 * Returns the amount of memory used by the loaded resources, in bytes
+	 */
+	uint getUsedMemory() const {
+		return _usedMemory;
+	}
+
+	/**
+	 * Returns the number of loaded resources
+	 */
+	uint getResourceCount() const {
+		return _resourceHashMap.size();
+	}
+
+	/**
+	 * Returns the number of resource requests served from the cache, the number of
+	 * requests that had to load the resource, and the number of resources released
+	 * to stay within the memory limit
+	 */
+	uint getCacheHits() const {
+		return _cacheHits;
+	}
+	uint getCacheMisses() const {
+		return _cacheMisses;
+	}
+	uint getCacheEvictions() const {
+		return _cacheEvictions;
+	}
+
+	/**
+	 * Specifies whether cache misses are written to the log
+	 */
+	bool isLogCacheMiss() const {
+		return _logCacheMiss;
+	}
+	void setLogCacheMiss(bool flag) {
+		_logCacheMiss = flag;
+	}
+
 private:
 	/**
 	 * Creates a new resource manager
 	 * Only the BS_Kernel class can generate copies this class. Thus, the constructor is private
 	 */
-	ResourceManager(Kernel *pKernel) :
-		_kernelPtr(pKernel)
-	{}
+	ResourceManager(Kernel *pKernel);
 	virtual ~ResourceManager();
 
 	/**
@@ -105,7 +156,7 @@ private:
 	void moveToFront(Resource *pResource);
 
 	/**
-	 * Loads a resource and updates the m_UsedMemory total
+	 * Loads a resource and updates the _usedMemory total
 	 *
 	 * The resource must not already be loaded
 	 * @param FileName      The unique filename of the resource to be loaded
@@ -119,7 +170,7 @@ private:
 	Common::String getUniqueFileName(const Common::String &fileName) const;
 
 	/**
-	 * Deletes a resource, removes it from the lists, and updates m_UsedMemory
+	 * Deletes a resource, removes it from the lists, and updates _usedMemory
 	 */
 	Common::List<Resource *>::iterator deleteResource(Resource *pResource);
 
@@ -131,14 +182,29 @@ private:
 
 	/**
 	 * Deletes resources as necessary until the specified memory limit is not being exceeded.
+	 * The most recently used resource is never deleted.
 	 */
 	void deleteResourcesIfNecessary();
 
+	/**
+	 * Deletes unlocked resources, starting with the least recently used one, until the memory
+	 * usage drops to the given limit.
+	 * @param Limit                 The memory limit
+	 * @param ExpensiveToReload     Whether resources that are expensive to reload may be deleted
+	 */
+	void deleteUnlockedResources(uint limit, bool expensiveToReload);
+
 	Kernel *_kernelPtr;
 	Common::Array<ResourceService *> _resourceServices;
 	Common::List<Resource *> _resources;
 	typedef Common::HashMap<Common::String, Resource *> ResMap;
 	ResMap _resourceHashMap;
+	uint _maxMemoryUsage;
+	uint _usedMemory;
+	uint _cacheHits;
+	uint _cacheMisses;
+	uint _cacheEvictions;
+	bool _logCacheMiss;
 };
 
 } // End of namespace Sword25
@@ -92,6 +92,22 @@ public:
 		return _type;
 	}
 
+	/**
+	 * Returns an estimate of the memory used by the resource, in bytes.
+	 * It is queried once after loading, for the resource cache accounting.
+	 */
+	virtual uint getSize() const {
+		return sizeof(Resource) + _fileName.size();
+	}
+
+	/**
+	 * Returns whether reloading the resource is expensive, compared to
+	 * other resources of the same size. The cache evicts those last.
+	 */
+	virtual bool isExpensiveToReload() const {
+		return false;
+	}
+
 protected:
 	virtual ~Resource() {}
 
@@ -99,6 +115,7 @@ private:
 	Common::String _fileName;          ///< The absolute filename
 	uint _refCount;          ///< The number of locks
 	uint _type;              ///< The type of the resource
+	uint _size;              ///< The memory accounted for the resource in the cache
 	Common::List<Resource *>::iterator _iterator;        ///< Points to the resource position in the LRU list
 };
 
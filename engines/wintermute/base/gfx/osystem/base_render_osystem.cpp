@@ -41,7 +41,7 @@
 namespace Wintermute {
 
 RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, bool mirrorX, bool mirrorY, bool disableAlpha) : _owner(owner),
-	_srcRect(*srcRect), _dstRect(*dstRect), _drawNum(0), _isValid(true), _wantsDraw(true), _hasAlpha(!disableAlpha) {
+	_srcRect(*srcRect), _dstRect(*dstRect), _isValid(true), _wantsDraw(true), _hasAlpha(!disableAlpha) {
 	_colorMod = 0;
 	_mirror = TransparentSurface::FLIP_NONE;
 	if (mirrorX) {
@@ -78,7 +78,7 @@ RenderTicket::~RenderTicket() {
 	}
 }
 
-bool RenderTicket::operator==(RenderTicket &t) {
+bool RenderTicket::operator==(const RenderTicket &t) const {
 	if ((t._srcRect != _srcRect) ||
 	        (t._dstRect != _dstRect) ||
 	        (t._mirror != _mirror) ||
@@ -90,6 +90,16 @@ bool RenderTicket::operator==(RenderTicket &t) {
 	return true;
 }
 
+uint RenderTicket_Hash::operator()(const RenderTicket *ticket) const {
+	uint hash = (uint)(size_t)ticket->_owner;
+	hash = hash * 31 + ((uint16)ticket->_srcRect.left | ((uint16)ticket->_srcRect.top << 16));
+	hash = hash * 31 + ((uint16)ticket->_srcRect.right | ((uint16)ticket->_srcRect.bottom << 16));
+	hash = hash * 31 + ((uint16)ticket->_dstRect.left | ((uint16)ticket->_dstRect.top << 16));
+	hash = hash * 31 + ((uint16)ticket->_dstRect.right | ((uint16)ticket->_dstRect.bottom << 16));
+	hash = hash * 31 + ticket->_mirror + (ticket->_hasAlpha ? 4 : 0);
+	return hash * 31 + ticket->_colorMod;
+}
+
 BaseRenderer *makeOSystemRenderer(BaseGame *inGame) {
 	return new BaseRenderOSystem(inGame);
 }
@@ -98,14 +108,13 @@ BaseRenderer *makeOSystemRenderer(BaseGame *inGame) {
 BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame) {
 	_renderSurface = new Graphics::Surface();
 	_blankSurface = new Graphics::Surface();
-	_drawNum = 1;
+	_nextTicket = _renderQueue.begin();
 	_needsFlip = true;
 
 	_borderLeft = _borderRight = _borderTop = _borderBottom = 0;
 	_ratioX = _ratioY = 1.0f;
 	setAlphaMod(255);
 	setColorMod(255, 255, 255);
-	_dirtyRect = NULL;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -114,7 +123,6 @@ BaseRenderOSystem::~BaseRenderOSystem() {
 	delete _renderSurface;
 	_blankSurface->free();
 	delete _blankSurface;
-	TransparentSurface::destroyLookup();
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -205,9 +213,7 @@ bool BaseRenderOSystem::flip() {
 		RenderQueueIterator it = _renderQueue.begin();
 		while (it != _renderQueue.end()) {
 			if ((*it)->_wantsDraw == false) {
-				RenderTicket *ticket = *it;
-				it = _renderQueue.erase(it);
-				delete ticket;
+				it = eraseTicket(it);
 			} else {
 				(*it)->_wantsDraw = false;
 				++it;
@@ -218,13 +224,11 @@ bool BaseRenderOSystem::flip() {
 		if (_disableDirtyRects) {
 			g_system->copyRectToScreen((byte *)_renderSurface->pixels, _renderSurface->pitch, 0, 0, _renderSurface->w, _renderSurface->h);
 		}
-		//  g_system->copyRectToScreen((byte *)_renderSurface->pixels, _renderSurface->pitch, _dirtyRect->left, _dirtyRect->top, _dirtyRect->width(), _dirtyRect->height());
-		delete _dirtyRect;
-		_dirtyRect = NULL;
+		_dirtyRects.clear();
 		g_system->updateScreen();
 		_needsFlip = false;
 	}
-	_drawNum = 1;
+	_nextTicket = _renderQueue.begin();
 
 	return STATUS_OK;
 }
@@ -315,17 +319,16 @@ void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::S
 	if (owner) { // Fade-tickets are owner-less
 		RenderTicket compare(owner, NULL, srcRect, dstRect, mirrorX, mirrorY, disableAlpha);
 		compare._colorMod = _colorMod;
-		RenderQueueIterator it;
-		for (it = _renderQueue.begin(); it != _renderQueue.end(); ++it) {
-			if ((*it)->_owner == owner && *(*it) == compare && (*it)->_isValid) {
-				(*it)->_colorMod = _colorMod;
-				if (_disableDirtyRects) {
-					drawFromSurface(*it, NULL);
-				} else {
-					drawFromTicket(*it);
-				}
-				return;
+		RenderTicketMap::iterator it = _renderTicketMap.find(&compare);
+		if (it != _renderTicketMap.end()) {
+			RenderTicket *ticket = *it->_value;
+			if (_disableDirtyRects) {
+				ticket->_wantsDraw = true;
+				drawFromSurface(ticket, NULL);
+			} else {
+				drawFromTicket(ticket);
 			}
+			return;
 		}
 	}
 	RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, mirrorX, mirrorY, disableAlpha);
@@ -335,13 +338,29 @@ void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::S
 	} else {
 		ticket->_wantsDraw = true;
 		_renderQueue.push_back(ticket);
+		if (owner)
+			_renderTicketMap[ticket] = --_renderQueue.end();
 		drawFromSurface(ticket, NULL);
 	}
 }
 
+BaseRenderOSystem::RenderQueueIterator BaseRenderOSystem::eraseTicket(RenderQueueIterator it) {
+	RenderTicket *ticket = *it;
+	unmapTicket(ticket);
+	delete ticket;
+	return _renderQueue.erase(it);
+}
+
+void BaseRenderOSystem::unmapTicket(RenderTicket *ticket) {
+	RenderTicketMap::iterator it = _renderTicketMap.find(ticket);
+	if (it != _renderTicketMap.end() && *it->_value == ticket)
+		_renderTicketMap.erase(it);
+}
+
 void BaseRenderOSystem::invalidateTicket(RenderTicket *renderTicket) {
 	addDirtyRect(renderTicket->_dstRect);
 	renderTicket->_isValid = false;
+	unmapTicket(renderTicket);
 //	renderTicket->_canDelete = true; // TODO: Maybe readd this, to avoid even more duplicates.
 }
 
@@ -356,117 +375,111 @@ void BaseRenderOSystem::invalidateTicketsFromSurface(BaseSurfaceOSystem *surf) {
 
 void BaseRenderOSystem::drawFromTicket(RenderTicket *renderTicket) {
 	renderTicket->_wantsDraw = true;
-	// A new item always has _drawNum == 0
-	if (renderTicket->_drawNum == 0) {
-		// In-order
-		if (_renderQueue.empty() || _drawNum > (_renderQueue.back())->_drawNum) {
-			renderTicket->_drawNum = _drawNum++;
-			_renderQueue.push_back(renderTicket);
-			addDirtyRect(renderTicket->_dstRect);
-		} else {
-			// Before something
-			Common::List<RenderTicket *>::iterator pos;
-			for (pos = _renderQueue.begin(); pos != _renderQueue.end(); pos++) {
-				if ((*pos)->_drawNum >= _drawNum) {
-					break;
-				}
-			}
-			_renderQueue.insert(pos, renderTicket);
-			Common::List<RenderTicket *>::iterator it;
-			renderTicket->_drawNum = _drawNum++;
-			// Increment the following tickets, so they still are in line
-			for (it = pos; it != _renderQueue.end(); ++it) {
-				(*it)->_drawNum++;
-				(*it)->_wantsDraw = false;
-			}
-			addDirtyRect(renderTicket->_dstRect);
-		}
-	} else {
-		// Was drawn last round, still in the same order
-		if (_drawNum == renderTicket->_drawNum) {
-			_drawNum++;
-		} else {
-			// Remove the ticket from the list
-			RenderQueueIterator it = _renderQueue.begin();
-			while (it != _renderQueue.end()) {
-				if ((*it) == renderTicket) {
-					it = _renderQueue.erase(it);
-					break;
-				} else {
-					++it;
-				}
-			}
-			if (it != _renderQueue.end()) {
-				// Decreement the following tickets.
-				for (; it != _renderQueue.end(); ++it) {
-					(*it)->_drawNum--;
-				}
-			}
-			// Is not in order, so readd it as if it was a new ticket
-			renderTicket->_drawNum = 0;
-			drawFromTicket(renderTicket);
-		}
+
+	// Was drawn last round, still in the same order
+	if (_nextTicket != _renderQueue.end() && *_nextTicket == renderTicket) {
+		++_nextTicket;
+		return;
+	}
+
+	// Not in order anymore, so take it out of the queue, and readd it as if
+	// it was a new ticket
+	RenderTicketMap::iterator mapped = _renderTicketMap.find(renderTicket);
+	if (mapped != _renderTicketMap.end() && *mapped->_value == renderTicket)
+		_renderQueue.erase(mapped->_value);
+
+	// Put it before the ticket expected next, or at the end, if the rest of
+	// the queue has been drawn already.
+	_renderQueue.insert(_nextTicket, renderTicket);
+	if (renderTicket->_owner) {
+		RenderQueueIterator pos = _nextTicket;
+		_renderTicketMap[renderTicket] = --pos;
 	}
+	addDirtyRect(renderTicket->_dstRect);
 }
 
 void BaseRenderOSystem::addDirtyRect(const Common::Rect &rect) {
-	if (!_dirtyRect) {
-		_dirtyRect = new Common::Rect(rect);
-	} else {
-		_dirtyRect->extend(rect);
+	Common::Rect dirtyRect(rect);
+	dirtyRect.clip(_renderRect);
+	if (dirtyRect.isEmpty()) {
+		return;
+	}
+
+	// Merge it with the rects it overlaps. The merged rect may overlap
+	// rects that were checked before, so start over after each merge.
+	Common::List<Common::Rect>::iterator it = _dirtyRects.begin();
+	while (it != _dirtyRects.end()) {
+		if (it->intersects(dirtyRect)) {
+			dirtyRect.extend(*it);
+			_dirtyRects.erase(it);
+			it = _dirtyRects.begin();
+		} else {
+			++it;
+		}
+	}
+
+	// Too many small rects cost more than redrawing the area between them
+	if (_dirtyRects.size() >= _maxDirtyRects) {
+		for (it = _dirtyRects.begin(); it != _dirtyRects.end(); ++it) {
+			dirtyRect.extend(*it);
+		}
+		_dirtyRects.clear();
 	}
-	_dirtyRect->clip(_renderRect);
+
+	_dirtyRects.push_back(dirtyRect);
 }
 
 void BaseRenderOSystem::drawTickets() {
 	RenderQueueIterator it = _renderQueue.begin();
 	// Clean out the old tickets
-	int decrement = 0;
 	while (it != _renderQueue.end()) {
 		if ((*it)->_wantsDraw == false || (*it)->_isValid == false) {
-			RenderTicket *ticket = *it;
 			addDirtyRect((*it)->_dstRect);
-			it = _renderQueue.erase(it);
-			delete ticket;
-			decrement++;
+			it = eraseTicket(it);
 		} else {
-			(*it)->_drawNum -= decrement;
 			++it;
 		}
 	}
-	if (!_dirtyRect || _dirtyRect->width() == 0 || _dirtyRect->height() == 0) {
+	if (_dirtyRects.empty()) {
 		return;
 	}
 	// The color-mods are stored in the RenderTickets on add, since we set that state again during
 	// draw, we need to keep track of what it was prior to draw.
 	uint32 oldColorMod = _colorMod;
 
-	// Apply the clear-color to the dirty rect.
-	_renderSurface->fillRect(*_dirtyRect, _clearColor);
-	_drawNum = 1;
-	for (it = _renderQueue.begin(); it != _renderQueue.end(); ++it) {
-		RenderTicket *ticket = *it;
-		assert(ticket->_drawNum == _drawNum++);
-		if (ticket->_isValid && ticket->_dstRect.intersects(*_dirtyRect)) {
-			// dstClip is the area we want redrawn.
-			Common::Rect dstClip(ticket->_dstRect);
-			// reduce it to the dirty rect
-			dstClip.clip(*_dirtyRect);
-			// we need to keep track of the position to redraw the dirty rect
-			Common::Rect pos(dstClip);
-			int16 offsetX = ticket->_dstRect.left;
-			int16 offsetY = ticket->_dstRect.top;
-			// convert from screen-coords to surface-coords.
-			dstClip.translate(-offsetX, -offsetY);
-
-			_colorMod = ticket->_colorMod;
-			drawFromSurface(ticket->getSurface(), &ticket->_srcRect, &pos, &dstClip, ticket->_mirror);
-			_needsFlip = true;
+	// The dirty rects don't overlap, so each of them can be redrawn on its
+	// own, from the tickets intersecting it.
+	for (Common::List<Common::Rect>::const_iterator dirtyIt = _dirtyRects.begin(); dirtyIt != _dirtyRects.end(); ++dirtyIt) {
+		const Common::Rect &dirtyRect = *dirtyIt;
+
+		// Apply the clear-color to the dirty rect.
+		_renderSurface->fillRect(dirtyRect, _clearColor);
+		for (it = _renderQueue.begin(); it != _renderQueue.end(); ++it) {
+			RenderTicket *ticket = *it;
+			if (ticket->_isValid && ticket->_dstRect.intersects(dirtyRect)) {
+				// dstClip is the area we want redrawn.
+				Common::Rect dstClip(ticket->_dstRect);
+				// reduce it to the dirty rect
+				dstClip.clip(dirtyRect);
+				// we need to keep track of the position to redraw the dirty rect
+				Common::Rect pos(dstClip);
+				int16 offsetX = ticket->_dstRect.left;
+				int16 offsetY = ticket->_dstRect.top;
+				// convert from screen-coords to surface-coords.
+				dstClip.translate(-offsetX, -offsetY);
+
+				_colorMod = ticket->_colorMod;
+				drawFromSurface(ticket->getSurface(), &ticket->_srcRect, &pos, &dstClip, ticket->_mirror);
+				_needsFlip = true;
+			}
 		}
-		// Some tickets want redraw but don't actually clip the dirty area (typically the ones that shouldnt become clear-color)
-		ticket->_wantsDraw = false;
+		g_system->copyRectToScreen((byte *)_renderSurface->getBasePtr(dirtyRect.left, dirtyRect.top), _renderSurface->pitch, dirtyRect.left, dirtyRect.top, dirtyRect.width(), dirtyRect.height());
+	}
+
+	// Some tickets want redraw but don't actually clip the dirty area (typically the ones that shouldnt become clear-color)
+	for (it = _renderQueue.begin(); it != _renderQueue.end(); ++it) {
+		(*it)->_wantsDraw = false;
 	}
-	g_system->copyRectToScreen((byte *)_renderSurface->getBasePtr(_dirtyRect->left, _dirtyRect->top), _renderSurface->pitch, _dirtyRect->left, _dirtyRect->top, _dirtyRect->width(), _dirtyRect->height());
 
 	// Revert the colorMod-state.
 	_colorMod = oldColorMod;
@@ -32,6 +32,7 @@
 #include "engines/wintermute/base/gfx/base_renderer.h"
 #include "common/rect.h"
 #include "graphics/surface.h"
+#include "common/hashmap.h"
 #include "common/list.h"
 
 namespace Wintermute {
@@ -40,7 +41,7 @@ class RenderTicket {
 	Graphics::Surface *_surface;
 public:
 	RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRest, bool mirrorX = false, bool mirrorY = false, bool disableAlpha = false);
-	RenderTicket() : _isValid(true), _wantsDraw(false), _drawNum(0) {}
+	RenderTicket() : _isValid(true), _wantsDraw(false) {}
 	~RenderTicket();
 	const Graphics::Surface *getSurface() { return _surface; }
 	Common::Rect _srcRect;
@@ -50,11 +51,21 @@ public:
 
 	bool _isValid;
 	bool _wantsDraw;
-	uint32 _drawNum;
 	uint32 _colorMod;
 
 	BaseSurfaceOSystem *_owner;
-	bool operator==(RenderTicket &a);
+	bool operator==(const RenderTicket &a) const;
+};
+
+/**
+ * Hashes the parts of a RenderTicket compared by RenderTicket::operator==
+ */
+struct RenderTicket_Hash {
+	uint operator()(const RenderTicket *ticket) const;
+};
+
+struct RenderTicket_EqualTo {
+	bool operator()(const RenderTicket *a, const RenderTicket *b) const { return *a == *b; }
 };
 
 class BaseRenderOSystem : public BaseRenderer {
@@ -101,15 +112,25 @@ public:
 	void drawSurface(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, bool mirrorX, bool mirrorY, bool disableAlpha = false);
 	BaseSurface *createSurface();
 private:
+	typedef Common::List<RenderTicket *>::iterator RenderQueueIterator;
+	typedef Common::HashMap<RenderTicket *, RenderQueueIterator, RenderTicket_Hash, RenderTicket_EqualTo> RenderTicketMap;
+
 	void addDirtyRect(const Common::Rect &rect);
 	void drawTickets();
 	void drawFromSurface(RenderTicket *ticket, Common::Rect *clipRect);
 	void drawFromSurface(const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Common::Rect *clipRect, uint32 mirror);
-	typedef Common::List<RenderTicket *>::iterator RenderQueueIterator;
-	Common::Rect *_dirtyRect;
+	RenderQueueIterator eraseTicket(RenderQueueIterator it);
+	void unmapTicket(RenderTicket *ticket);
+
+	// Areas to redraw, they never overlap each other
+	Common::List<Common::Rect> _dirtyRects;
 	Common::List<RenderTicket *> _renderQueue;
+	// The valid tickets of the queue, to find them by their contents
+	RenderTicketMap _renderTicketMap;
+	// The ticket expected to be drawn next, if the frame is drawn in the same
+	// order as the previous one
+	RenderQueueIterator _nextTicket;
 	bool _needsFlip;
-	uint32 _drawNum;
 	Common::Rect _renderRect;
 	Graphics::Surface *_renderSurface;
 	Graphics::Surface *_blankSurface;
@@ -120,6 +141,7 @@ private:
 	int _borderBottom;
 
 	static const bool _disableDirtyRects = true;
+	static const uint _maxDirtyRects = 16;
 	float _ratioX;
 	float _ratioY;
 	uint32 _colorMod;
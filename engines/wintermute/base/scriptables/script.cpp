@@ -46,6 +46,7 @@ ScScript::ScScript(BaseGame *inGame, ScEngine *engine) : BaseClass(inGame) {
 	_currentLine = 0;
 
 	_symbols = NULL;
+	_varSlots = NULL;
 	_numSymbols = 0;
 
 	_engine = engine;
@@ -101,141 +102,212 @@ ScScript::~ScScript() {
 	cleanup();
 }
 
-void ScScript::readHeader() {
-	uint32 oldPos = _scriptStream->pos();
-	_scriptStream->seek(0);
-	_header.magic = _scriptStream->readUint32LE();
-	_header.version = _scriptStream->readUint32LE();
-	_header.codeStart = _scriptStream->readUint32LE();
-	_header.funcTable = _scriptStream->readUint32LE();
-	_header.symbolTable = _scriptStream->readUint32LE();
-	_header.eventTable = _scriptStream->readUint32LE();
-	_header.externalsTable = _scriptStream->readUint32LE();
-	_header.methodTable = _scriptStream->readUint32LE();
-	_scriptStream->seek(oldPos);
-}
-
-
 //////////////////////////////////////////////////////////////////////////
-bool ScScript::initScript() {
-	if (!_scriptStream) {
-		_scriptStream = new Common::MemoryReadStream(_buffer, _bufferSize);
-	}
-	readHeader();
+ScScript::CompiledScript::CompiledScript(byte *buffer, uint32 size) {
+	_buffer = buffer;
+	_size = size;
 
-	if (_header.magic != SCRIPT_MAGIC) {
-		_gameRef->LOG(0, "File '%s' is not a valid compiled script", _filename);
-		cleanup();
-		return STATUS_FAILED;
-	}
+	_symbols = NULL;
+	_numSymbols = 0;
+	_functions = NULL;
+	_numFunctions = 0;
+	_methods = NULL;
+	_numMethods = 0;
+	_events = NULL;
+	_numEvents = 0;
+	_externals = NULL;
+	_numExternals = 0;
 
-	if (_header.version > SCRIPT_VERSION) {
-		_gameRef->LOG(0, "Script '%s' has a wrong version %d.%d (expected %d.%d)", _filename, _header.version / 256, _header.version % 256, SCRIPT_VERSION / 256, SCRIPT_VERSION % 256);
-		cleanup();
-		return STATUS_FAILED;
+	Common::MemoryReadStream stream(_buffer, _size);
+	_header.magic = stream.readUint32LE();
+	_header.version = stream.readUint32LE();
+	_header.codeStart = stream.readUint32LE();
+	_header.funcTable = stream.readUint32LE();
+	_header.symbolTable = stream.readUint32LE();
+	_header.eventTable = stream.readUint32LE();
+	_header.externalsTable = stream.readUint32LE();
+	_header.methodTable = stream.readUint32LE();
+
+	// ScScript::initScript() reports invalid scripts
+	if (_header.magic == SCRIPT_MAGIC && _header.version <= SCRIPT_VERSION) {
+		readTables();
 	}
-
-	initTables();
-
-	// init stacks
-	_scopeStack = new ScStack(_gameRef);
-	_callStack  = new ScStack(_gameRef);
-	_thisStack  = new ScStack(_gameRef);
-	_stack      = new ScStack(_gameRef);
-
-	_operand    = new ScValue(_gameRef);
-	_reg1       = new ScValue(_gameRef);
+}
 
 
-	// skip to the beginning
-	_iP = _header.codeStart;
-	_scriptStream->seek(_iP);
-	_currentLine = 0;
+//////////////////////////////////////////////////////////////////////////
+ScScript::CompiledScript::~CompiledScript() {
+	delete[] _symbols;
+	delete[] _functions;
+	delete[] _methods;
+	delete[] _events;
 
-	// ready to rumble...
-	_state = SCRIPT_RUNNING;
+	if (_externals) {
+		for (uint32 i = 0; i < _numExternals; i++) {
+			if (_externals[i].nu_params > 0) {
+				delete[] _externals[i].params;
+			}
+		}
+		delete[] _externals;
+	}
 
-	return STATUS_OK;
+	delete[] _buffer;
 }
 
 
 //////////////////////////////////////////////////////////////////////////
-bool ScScript::initTables() {
-	uint32 origIP = _iP;
+void ScScript::CompiledScript::readTables() {
+	Common::MemoryReadStream stream(_buffer, _size);
 
-	readHeader();
 	// load symbol table
-	_iP = _header.symbolTable;
+	stream.seek(_header.symbolTable);
 
-	_numSymbols = getDWORD();
+	_numSymbols = stream.readUint32LE();
 	_symbols = new char*[_numSymbols];
 	for (uint32 i = 0; i < _numSymbols; i++) {
-		uint32 index = getDWORD();
-		_symbols[index] = getString();
+		uint32 index = stream.readUint32LE();
+		_symbols[index] = readString(stream);
 	}
 
 	// load functions table
-	_iP = _header.funcTable;
+	stream.seek(_header.funcTable);
 
-	_numFunctions = getDWORD();
+	_numFunctions = stream.readUint32LE();
 	_functions = new TFunctionPos[_numFunctions];
 	for (uint32 i = 0; i < _numFunctions; i++) {
-		_functions[i].pos = getDWORD();
-		_functions[i].name = getString();
+		_functions[i].pos = stream.readUint32LE();
+		_functions[i].name = readString(stream);
 	}
 
 
 	// load events table
-	_iP = _header.eventTable;
+	stream.seek(_header.eventTable);
 
-	_numEvents = getDWORD();
+	_numEvents = stream.readUint32LE();
 	_events = new TEventPos[_numEvents];
 	for (uint32 i = 0; i < _numEvents; i++) {
-		_events[i].pos = getDWORD();
-		_events[i].name = getString();
+		_events[i].pos = stream.readUint32LE();
+		_events[i].name = readString(stream);
 	}
 
 
 	// load externals
 	if (_header.version >= 0x0101) {
-		_iP = _header.externalsTable;
+		stream.seek(_header.externalsTable);
 
-		_numExternals = getDWORD();
+		_numExternals = stream.readUint32LE();
 		_externals = new TExternalFunction[_numExternals];
 		for (uint32 i = 0; i < _numExternals; i++) {
-			_externals[i].dll_name = getString();
-			_externals[i].name = getString();
-			_externals[i].call_type = (TCallType)getDWORD();
-			_externals[i].returns = (TExternalType)getDWORD();
-			_externals[i].nu_params = getDWORD();
+			_externals[i].dll_name = readString(stream);
+			_externals[i].name = readString(stream);
+			_externals[i].call_type = (TCallType)stream.readUint32LE();
+			_externals[i].returns = (TExternalType)stream.readUint32LE();
+			_externals[i].nu_params = stream.readUint32LE();
 			if (_externals[i].nu_params > 0) {
 				_externals[i].params = new TExternalType[_externals[i].nu_params];
 				for (int j = 0; j < _externals[i].nu_params; j++) {
-					_externals[i].params[j] = (TExternalType)getDWORD();
+					_externals[i].params[j] = (TExternalType)stream.readUint32LE();
 				}
 			}
 		}
 	}
 
 	// load method table
-	_iP = _header.methodTable;
+	stream.seek(_header.methodTable);
 
-	_numMethods = getDWORD();
+	_numMethods = stream.readUint32LE();
 	_methods = new TMethodPos[_numMethods];
 	for (uint32 i = 0; i < _numMethods; i++) {
-		_methods[i].pos = getDWORD();
-		_methods[i].name = getString();
+		_methods[i].pos = stream.readUint32LE();
+		_methods[i].name = readString(stream);
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+char *ScScript::CompiledScript::readString(Common::SeekableReadStream &stream) {
+	uint32 pos = stream.pos();
+	char *ret = (char *)(_buffer + pos);
+	while (pos < _size && _buffer[pos] != '\0') {
+		pos++;
+	}
+	stream.seek(pos + 1); // string terminator
+
+	return ret;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+bool ScScript::initScript() {
+	initTables();
+
+	if (!_scriptStream) {
+		_scriptStream = new Common::MemoryReadStream(_buffer, _bufferSize);
+	}
+
+	if (_header.magic != SCRIPT_MAGIC) {
+		_gameRef->LOG(0, "File '%s' is not a valid compiled script", _filename);
+		cleanup();
+		return STATUS_FAILED;
+	}
+
+	if (_header.version > SCRIPT_VERSION) {
+		_gameRef->LOG(0, "Script '%s' has a wrong version %d.%d (expected %d.%d)", _filename, _header.version / 256, _header.version % 256, SCRIPT_VERSION / 256, SCRIPT_VERSION % 256);
+		cleanup();
+		return STATUS_FAILED;
 	}
 
+	// init stacks
+	_scopeStack = new ScStack(_gameRef);
+	_callStack  = new ScStack(_gameRef);
+	_thisStack  = new ScStack(_gameRef);
+	_stack      = new ScStack(_gameRef);
+
+	_operand    = new ScValue(_gameRef);
+	_reg1       = new ScValue(_gameRef);
+
+
+	// skip to the beginning
+	_iP = _header.codeStart;
+	_scriptStream->seek(_iP);
+	_currentLine = 0;
 
-	_iP = origIP;
+	// ready to rumble...
+	_state = SCRIPT_RUNNING;
 
 	return STATUS_OK;
 }
 
 
 //////////////////////////////////////////////////////////////////////////
-bool ScScript::create(const char *filename, byte *buffer, uint32 size, BaseScriptHolder *owner) {
+void ScScript::initTables() {
+	// the bytecode and the tables are shared with all the other scripts
+	// running the same file
+	_buffer = _compiled->_buffer;
+	_bufferSize = _compiled->_size;
+	_header = _compiled->_header;
+
+	_symbols = _compiled->_symbols;
+	_numSymbols = _compiled->_numSymbols;
+	_functions = _compiled->_functions;
+	_numFunctions = _compiled->_numFunctions;
+	_methods = _compiled->_methods;
+	_numMethods = _compiled->_numMethods;
+	_events = _compiled->_events;
+	_numEvents = _compiled->_numEvents;
+	_externals = _compiled->_externals;
+	_numExternals = _compiled->_numExternals;
+
+	// variable slots are resolved on first use
+	_varSlots = new TVariableSlot[_numSymbols];
+	for (uint32 i = 0; i < _numSymbols; i++) {
+		_varSlots[i].var = NULL;
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+bool ScScript::create(const char *filename, const CompiledScriptPtr &compiled, BaseScriptHolder *owner) {
 	cleanup();
 
 	_thread = false;
@@ -249,14 +321,7 @@ bool ScScript::create(const char *filename, byte *buffer, uint32 size, BaseScrip
 		strcpy(_filename, filename);
 	}
 
-	_buffer = new byte [size];
-	if (!_buffer) {
-		return STATUS_FAILED;
-	}
-
-	memcpy(_buffer, buffer, size);
-
-	_bufferSize = size;
+	_compiled = compiled;
 
 	bool res = initScript();
 	if (DID_FAIL(res)) {
@@ -289,14 +354,8 @@ bool ScScript::createThread(ScScript *original, uint32 initIP, const Common::Str
 		strcpy(_filename, original->_filename);
 	}
 
-	// copy buffer
-	_buffer = new byte [original->_bufferSize];
-	if (!_buffer) {
-		return STATUS_FAILED;
-	}
-
-	memcpy(_buffer, original->_buffer, original->_bufferSize);
-	_bufferSize = original->_bufferSize;
+	// share the bytecode
+	_compiled = original->_compiled;
 
 	// initialize
 	bool res = initScript();
@@ -346,14 +405,8 @@ bool ScScript::createMethodThread(ScScript *original, const Common::String &meth
 		strcpy(_filename, original->_filename);
 	}
 
-	// copy buffer
-	_buffer = new byte [original->_bufferSize];
-	if (!_buffer) {
-		return STATUS_FAILED;
-	}
-
-	memcpy(_buffer, original->_buffer, original->_bufferSize);
-	_bufferSize = original->_bufferSize;
+	// share the bytecode
+	_compiled = original->_compiled;
 
 	// initialize
 	bool res = initScript();
@@ -380,22 +433,20 @@ bool ScScript::createMethodThread(ScScript *original, const Common::String &meth
 
 //////////////////////////////////////////////////////////////////////////
 void ScScript::cleanup() {
-	if (_buffer) {
-		delete[] _buffer;
-	}
 	_buffer = NULL;
+	_bufferSize = 0;
 
 	if (_filename) {
 		delete[] _filename;
 	}
 	_filename = NULL;
 
-	if (_symbols) {
-		delete[] _symbols;
-	}
 	_symbols = NULL;
 	_numSymbols = 0;
 
+	delete[] _varSlots;
+	_varSlots = NULL;
+
 	if (_globals && !_thread) {
 		delete _globals;
 	}
@@ -413,36 +464,21 @@ void ScScript::cleanup() {
 	delete _stack;
 	_stack = NULL;
 
-	if (_functions) {
-		delete[] _functions;
-	}
 	_functions = NULL;
 	_numFunctions = 0;
 
-	if (_methods) {
-		delete[] _methods;
-	}
 	_methods = NULL;
 	_numMethods = 0;
 
-	if (_events) {
-		delete[] _events;
-	}
 	_events = NULL;
 	_numEvents = 0;
 
-
-	if (_externals) {
-		for (uint32 i = 0; i < _numExternals; i++) {
-			if (_externals[i].nu_params > 0) {
-				delete[] _externals[i].params;
-			}
-		}
-		delete[] _externals;
-	}
 	_externals = NULL;
 	_numExternals = 0;
 
+	// the tables above belong to the compiled script
+	_compiled.reset();
+
 	delete _operand;
 	delete _reg1;
 	_operand = NULL;
@@ -461,6 +497,7 @@ void ScScript::cleanup() {
 	_parentScript = NULL; // ref only
 
 	delete _scriptStream;
+	_scriptStream = NULL;
 }
 
 
@@ -690,7 +727,7 @@ bool ScScript::executeInstruction() {
 		break;
 
 	case II_PUSH_VAR: {
-		ScValue *var = getVar(_symbols[getDWORD()]);
+		ScValue *var = getSymbolVar(getDWORD());
 		if (false && /*var->_type==VAL_OBJECT ||*/ var->_type == VAL_NATIVE) {
 			_operand->setReference(var);
 			_stack->push(_operand);
@@ -701,15 +738,14 @@ bool ScScript::executeInstruction() {
 	}
 
 	case II_PUSH_VAR_REF: {
-		ScValue *var = getVar(_symbols[getDWORD()]);
+		ScValue *var = getSymbolVar(getDWORD());
 		_operand->setReference(var);
 		_stack->push(_operand);
 		break;
 	}
 
 	case II_POP_VAR: {
-		char *varName = _symbols[getDWORD()];
-		ScValue *var = getVar(varName);
+		ScValue *var = getSymbolVar(getDWORD());
 		if (var) {
 			ScValue *val = _stack->pop();
 			if (!val) {
@@ -762,7 +798,7 @@ bool ScScript::executeInstruction() {
 		break;
 
 	case II_PUSH_THIS:
-		_operand->setReference(getVar(_symbols[getDWORD()]));
+		_operand->setReference(getSymbolVar(getDWORD()));
 		_thisStack->push(_operand);
 		break;
 
@@ -1162,6 +1198,72 @@ ScValue *ScScript::getVar(char *name) {
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+// Variable tables which are plain objects can be searched directly.
+static bool isPlainVarTable(ScValue *table) {
+	return table->_type == VAL_OBJECT || table->_type == VAL_NULL;
+}
+
+static ScValue *findVar(ScValue *table, const Common::String &name) {
+	Common::HashMap<Common::String, ScValue *>::const_iterator it = table->_valObject.find(name);
+	return it != table->_valObject.end() ? it->_value : NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Same as getVar(), for a symbol of the script. The resolved variable is
+// remembered, so following accesses skip the name lookups until a variable
+// is added to or removed from one of the tables searched.
+ScValue *ScScript::getSymbolVar(uint32 symbol) {
+	ScValue *scope = _scopeStack->getTop();
+	TVariableSlot &slot = _varSlots[symbol];
+
+	if (slot.var && slot.scope == scope && (!scope || scope->_propsGeneration == slot.scopeGeneration)) {
+		if (slot.table == VAR_TABLE_SCOPE) {
+			return slot.var;
+		}
+		if (_globals->_propsGeneration == slot.globalsGeneration) {
+			if (slot.table == VAR_TABLE_GLOBALS || _engine->_globals->_propsGeneration == slot.engineGeneration) {
+				return slot.var;
+			}
+		}
+	}
+
+	slot.var = NULL;
+	if ((scope && !isPlainVarTable(scope)) || !isPlainVarTable(_globals) || !isPlainVarTable(_engine->_globals)) {
+		return getVar(_symbols[symbol]);
+	}
+
+	const Common::String name(_symbols[symbol]);
+	ScValue *var = NULL;
+	TVariableTable table = VAR_TABLE_SCOPE;
+
+	if (scope) {
+		var = findVar(scope, name);
+	}
+	if (!var) {
+		table = VAR_TABLE_GLOBALS;
+		var = findVar(_globals, name);
+	}
+	if (!var) {
+		table = VAR_TABLE_ENGINE;
+		var = findVar(_engine->_globals, name);
+	}
+
+	// undefined variables are created (and reported) by getVar()
+	if (!var) {
+		return getVar(_symbols[symbol]);
+	}
+
+	slot.var = var;
+	slot.scope = scope;
+	slot.table = table;
+	slot.scopeGeneration = scope ? scope->_propsGeneration : 0;
+	slot.globalsGeneration = _globals->_propsGeneration;
+	slot.engineGeneration = _engine->_globals->_propsGeneration;
+	return var;
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 bool ScScript::waitFor(BaseObject *object) {
 	if (_unbreakable) {
@@ -1257,11 +1359,13 @@ bool ScScript::persist(BasePersistenceManager *persistMgr) {
 		}
 	} else {
 		persistMgr->transfer(TMEMBER(_bufferSize));
+		_varSlots = NULL;
 		if (_bufferSize > 0) {
-			_buffer = new byte[_bufferSize];
-			persistMgr->getBytes(_buffer, _bufferSize);
-			_scriptStream = new Common::MemoryReadStream(_buffer, _bufferSize);
+			byte *buffer = new byte[_bufferSize];
+			persistMgr->getBytes(buffer, _bufferSize);
+			_compiled = CompiledScriptPtr(new CompiledScript(buffer, _bufferSize));
 			initTables();
+			_scriptStream = new Common::MemoryReadStream(_buffer, _bufferSize);
 		} else {
 			_buffer = NULL;
 			_scriptStream = NULL;
@@ -1447,20 +1551,17 @@ const char *ScScript::dbgGetFilename() {
 //////////////////////////////////////////////////////////////////////////
 void ScScript::afterLoad() {
 	if (_buffer == NULL) {
-		byte *buffer = _engine->getCompiledScript(_filename, &_bufferSize);
-		if (!buffer) {
+		_compiled = _engine->getCompiledScript(_filename);
+		if (!_compiled) {
 			_gameRef->LOG(0, "Error reinitializing script '%s' after load. Script will be terminated.", _filename);
 			_state = SCRIPT_ERROR;
 			return;
 		}
 
-		_buffer = new byte [_bufferSize];
-		memcpy(_buffer, buffer, _bufferSize);
+		initTables();
 
 		delete _scriptStream;
 		_scriptStream = new Common::MemoryReadStream(_buffer, _bufferSize);
-
-		initTables();
 	}
 }
 
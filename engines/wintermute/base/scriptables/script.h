@@ -33,12 +33,15 @@
 #include "engines/wintermute/base/base.h"
 #include "engines/wintermute/base/scriptables/dcscript.h"   // Added by ClassView
 #include "engines/wintermute/coll_templ.h"
+#include "common/noncopyable.h"
+#include "common/ptr.h"
 
 namespace Wintermute {
 class BaseScriptHolder;
 class BaseObject;
 class ScEngine;
 class ScStack;
+class ScValue;
 class ScScript : public BaseClass {
 public:
 	BaseArray<int> _breakpoints;
@@ -77,6 +80,7 @@ public:
 	TScriptState _state;
 	TScriptState _origState;
 	ScValue *getVar(char *name);
+	ScValue *getSymbolVar(uint32 symbol);
 	uint32 getFuncPos(const Common::String &name);
 	uint32 getEventPos(const Common::String &name);
 	uint32 getMethodPos(const Common::String &name);
@@ -117,6 +121,39 @@ public:
 		TExternalType *params;
 	} TExternalFunction;
 
+	/**
+	 * The bytecode of a compiled script and the tables read from it. It is
+	 * shared by the script cache and all the scripts and threads running
+	 * the bytecode, and never changes once it has been loaded.
+	 */
+	class CompiledScript : Common::NonCopyable {
+	public:
+		// Takes over the buffer, which must have been allocated with new[]
+		CompiledScript(byte *buffer, uint32 size);
+		~CompiledScript();
+
+		byte *_buffer;
+		uint32 _size;
+		TScriptHeader _header;
+
+		char **_symbols;
+		uint32 _numSymbols;
+		TFunctionPos *_functions;
+		uint32 _numFunctions;
+		TMethodPos *_methods;
+		uint32 _numMethods;
+		TEventPos *_events;
+		uint32 _numEvents;
+		TExternalFunction *_externals;
+		uint32 _numExternals;
+
+	private:
+		void readTables();
+		char *readString(Common::SeekableReadStream &stream);
+	};
+
+	typedef Common::SharedPtr<CompiledScript> CompiledScriptPtr;
+
 
 	ScStack *_callStack;
 	ScStack *_thisStack;
@@ -130,10 +167,11 @@ public:
 	uint32 getDWORD();
 	double getFloat();
 	void cleanup();
-	bool create(const char *filename, byte *buffer, uint32 size, BaseScriptHolder *owner);
+	bool create(const char *filename, const CompiledScriptPtr &compiled, BaseScriptHolder *owner);
 	uint32 _iP;
 private:
-	void readHeader();
+	CompiledScriptPtr _compiled;
+	// The following point into _compiled
 	uint32 _bufferSize;
 	byte *_buffer;
 public:
@@ -148,7 +186,26 @@ public:
 	ScScript::TExternalFunction *getExternal(char *name);
 	bool externalCall(ScStack *stack, ScStack *thisStack, ScScript::TExternalFunction *function);
 private:
+	enum TVariableTable {
+		VAR_TABLE_SCOPE,
+		VAR_TABLE_GLOBALS,
+		VAR_TABLE_ENGINE
+	};
+
+	// The variable a symbol was last resolved to, and the generations of
+	// the variable tables searched to find it. The slot remains valid as
+	// long as none of those tables gained or lost variables.
+	typedef struct {
+		ScValue *var;
+		ScValue *scope;
+		TVariableTable table;
+		uint32 scopeGeneration;
+		uint32 globalsGeneration;
+		uint32 engineGeneration;
+	} TVariableSlot;
+
 	char **_symbols;
+	TVariableSlot *_varSlots;
 	uint32 _numSymbols;
 	TFunctionPos *_functions;
 	TMethodPos *_methods;
@@ -160,7 +217,7 @@ private:
 	uint32 _numEvents;
 
 	bool initScript();
-	bool initTables();
+	void initTables();
 
 
 // IWmeDebugScript interface implementation
@@ -69,9 +69,7 @@ ScEngine::ScEngine(BaseGame *inGame) : BaseClass(inGame) {
 	}
 
 	// prepare script cache
-	for (int i = 0; i < MAX_CACHED_SCRIPTS; i++) {
-		_cachedScripts[i] = NULL;
-	}
+	_cachedScriptsSize = 0;
 
 	_currentScript = NULL;
 
@@ -135,18 +133,15 @@ void ScEngine::parseElement(void *data, int line, int type, void *elementData) {
 
 //////////////////////////////////////////////////////////////////////////
 ScScript *ScEngine::runScript(const char *filename, BaseScriptHolder *owner) {
-	byte *compBuffer;
-	uint32 compSize;
-
 	// get script from cache
-	compBuffer = getCompiledScript(filename, &compSize);
-	if (!compBuffer) {
+	ScScript::CompiledScriptPtr compiled = getCompiledScript(filename);
+	if (!compiled) {
 		return NULL;
 	}
 
 	// add new script
 	ScScript *script = new ScScript(_gameRef, this);
-	bool ret = script->create(filename, compBuffer, compSize, owner);
+	bool ret = script->create(filename, compiled, owner);
 	if (DID_FAIL(ret)) {
 		_gameRef->LOG(ret, "Error running script '%s'...", filename);
 		delete script;
@@ -171,80 +166,69 @@ ScScript *ScEngine::runScript(const char *filename, BaseScriptHolder *owner) {
 
 
 //////////////////////////////////////////////////////////////////////////
-byte *ScEngine::getCompiledScript(const char *filename, uint32 *outSize, bool ignoreCache) {
+ScScript::CompiledScriptPtr ScEngine::getCompiledScript(const char *filename, bool ignoreCache) {
 	// is script in cache?
 	if (!ignoreCache) {
-		for (int i = 0; i < MAX_CACHED_SCRIPTS; i++) {
-			if (_cachedScripts[i] && scumm_stricmp(_cachedScripts[i]->_filename.c_str(), filename) == 0) {
-				_cachedScripts[i]->_timestamp = g_system->getMillis();
-				*outSize = _cachedScripts[i]->_size;
-				return _cachedScripts[i]->_buffer;
+		CachedScriptMap::iterator cached = _cachedScriptMap.find(filename);
+		if (cached != _cachedScriptMap.end()) {
+			// move it to the front of the list
+			CachedScriptList::iterator it = cached->_value;
+			if (it != _cachedScripts.begin()) {
+				_cachedScripts.push_front(*it);
+				_cachedScripts.erase(it);
+				cached->_value = _cachedScripts.begin();
 			}
+			return _cachedScripts.front()._compiled;
 		}
 	}
 
 	// nope, load it
-	byte *compBuffer;
-	uint32 compSize;
-
 	uint32 size;
 
 	byte *buffer = BaseEngine::instance().getFileManager()->readWholeFile(filename, &size);
 	if (!buffer) {
 		_gameRef->LOG(0, "ScEngine::GetCompiledScript - error opening script '%s'", filename);
-		return NULL;
+		return ScScript::CompiledScriptPtr();
 	}
 
 	// needs to be compiled?
-	if (FROM_LE_32(*(uint32 *)buffer) == SCRIPT_MAGIC) {
-		compBuffer = buffer;
-		compSize = size;
-	} else {
+	if (size < sizeof(uint32) || READ_LE_UINT32(buffer) != SCRIPT_MAGIC) {
 		if (!_compilerAvailable) {
 			_gameRef->LOG(0, "ScEngine::GetCompiledScript - script '%s' needs to be compiled but compiler is not available", filename);
 			delete[] buffer;
-			return NULL;
+			return ScScript::CompiledScriptPtr();
 		}
 		// This code will never be called, since _compilerAvailable is const false.
 		// It's only here in the event someone would want to reinclude the compiler.
 		error("Script needs compilation, ScummVM does not contain a WME compiler");
 	}
 
-	byte *ret = NULL;
-
-	// add script to cache
-	CScCachedScript *cachedScript = new CScCachedScript(filename, compBuffer, compSize);
-	if (cachedScript) {
-		int index = 0;
-		uint32 minTime = g_system->getMillis();
-		for (int i = 0; i < MAX_CACHED_SCRIPTS; i++) {
-			if (_cachedScripts[i] == NULL) {
-				index = i;
-				break;
-			} else if (_cachedScripts[i]->_timestamp <= minTime) {
-				minTime = _cachedScripts[i]->_timestamp;
-				index = i;
-			}
-		}
-
-		if (_cachedScripts[index] != NULL) {
-			delete _cachedScripts[index];
-		}
-		_cachedScripts[index] = cachedScript;
+	// the compiled script takes over the buffer
+	ScScript::CompiledScriptPtr compiled(new ScScript::CompiledScript(buffer, size));
 
-		ret = cachedScript->_buffer;
-		*outSize = cachedScript->_size;
+	// add script to cache, replacing an outdated copy
+	CachedScriptMap::iterator cached = _cachedScriptMap.find(filename);
+	if (cached != _cachedScriptMap.end()) {
+		_cachedScriptsSize -= cached->_value->_compiled->_size;
+		_cachedScripts.erase(cached->_value);
+	}
+	_cachedScripts.push_front(CScCachedScript(filename, compiled));
+	_cachedScriptMap[filename] = _cachedScripts.begin();
+	_cachedScriptsSize += size;
+
+	// drop the least recently used scripts when over budget, but always keep
+	// the one just loaded; running scripts keep their own reference
+	while (_cachedScriptsSize > SCRIPT_CACHE_SIZE && _cachedScripts.back()._compiled != compiled) {
+		const CScCachedScript &last = _cachedScripts.back();
+		_cachedScriptsSize -= last._compiled->_size;
+		_cachedScriptMap.erase(last._filename);
+		_cachedScripts.pop_back();
 	}
 
-
-	// cleanup
-	delete[] buffer;
-
-	return ret;
+	return compiled;
 }
 
 
-
 //////////////////////////////////////////////////////////////////////////
 bool ScEngine::tick() {
 	if (_scripts.size() == 0) {
@@ -442,12 +426,9 @@ int ScEngine::getNumScripts(int *running, int *waiting, int *persistent) {
 
 //////////////////////////////////////////////////////////////////////////
 bool ScEngine::emptyScriptCache() {
-	for (int i = 0; i < MAX_CACHED_SCRIPTS; i++) {
-		if (_cachedScripts[i]) {
-			delete _cachedScripts[i];
-			_cachedScripts[i] = NULL;
-		}
-	}
+	_cachedScripts.clear();
+	_cachedScriptMap.clear();
+	_cachedScriptsSize = 0;
 	return STATUS_OK;
 }
 
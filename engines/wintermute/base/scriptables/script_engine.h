@@ -32,11 +32,14 @@
 #include "engines/wintermute/persistent.h"
 #include "engines/wintermute/coll_templ.h"
 #include "engines/wintermute/base/base.h"
+#include "engines/wintermute/base/scriptables/script.h"
+#include "common/hash-str.h"
+#include "common/list.h"
 
 namespace Wintermute {
 
-#define MAX_CACHED_SCRIPTS 20
-class ScScript;
+// The total size of the compiled scripts kept in the script cache
+#define SCRIPT_CACHE_SIZE (2 * 1024 * 1024)
 class ScValue;
 class BaseObject;
 class BaseScriptHolder;
@@ -44,26 +47,12 @@ class ScEngine : public BaseClass {
 public:
 	class CScCachedScript {
 	public:
-		CScCachedScript(const char *filename, byte *buffer, uint32 size) {
-			_timestamp = g_system->getMillis();
-			_buffer = new byte[size];
-			if (_buffer) {
-				memcpy(_buffer, buffer, size);
-			}
-			_size = size;
-			_filename = filename;
-		};
-
-		~CScCachedScript() {
-			if (_buffer) {
-				delete[] _buffer;
-			}
-		};
+		CScCachedScript(const Common::String &filename, const ScScript::CompiledScriptPtr &compiled) :
+			_filename(filename), _compiled(compiled) {
+		}
 
-		uint32 _timestamp;
-		byte *_buffer;
-		uint32 _size;
 		Common::String _filename;
+		ScScript::CompiledScriptPtr _compiled;
 	};
 
 	class CScBreakpoint {
@@ -93,7 +82,7 @@ public:
 	bool resetObject(BaseObject *Object);
 	bool resetScript(ScScript *script);
 	bool emptyScriptCache();
-	byte *getCompiledScript(const char *filename, uint32 *outSize, bool ignoreCache = false);
+	ScScript::CompiledScriptPtr getCompiledScript(const char *filename, bool ignoreCache = false);
 	DECLARE_PERSISTENT(ScEngine, BaseClass)
 	bool cleanup();
 	int getNumScripts(int *running = NULL, int *waiting = NULL, int *persistent = NULL);
@@ -121,7 +110,12 @@ public:
 
 private:
 
-	CScCachedScript *_cachedScripts[MAX_CACHED_SCRIPTS];
+	// The cached scripts, most recently used first, and their total size
+	typedef Common::List<CScCachedScript> CachedScriptList;
+	typedef Common::HashMap<Common::String, CachedScriptList::iterator, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> CachedScriptMap;
+	CachedScriptList _cachedScripts;
+	CachedScriptMap _cachedScriptMap;
+	uint32 _cachedScriptsSize;
 	bool _isProfiling;
 	uint32 _profilingStartTime;
 
@@ -42,6 +42,8 @@ namespace Wintermute {
 
 IMPLEMENT_PERSISTENT(ScValue, false)
 
+static uint32 s_propsGeneration = 0;
+
 //////////////////////////////////////////////////////////////////////////
 ScValue::ScValue(BaseGame *inGame) : BaseClass(inGame) {
 	_type = VAL_NULL;
@@ -54,6 +56,7 @@ ScValue::ScValue(BaseGame *inGame) : BaseClass(inGame) {
 	_valRef = NULL;
 	_persistent = false;
 	_isConstVar = false;
+	propsChanged();
 }
 
 
@@ -69,6 +72,7 @@ ScValue::ScValue(BaseGame *inGame, bool val) : BaseClass(inGame) {
 	_valRef = NULL;
 	_persistent = false;
 	_isConstVar = false;
+	propsChanged();
 }
 
 
@@ -84,6 +88,7 @@ ScValue::ScValue(BaseGame *inGame, int val) : BaseClass(inGame) {
 	_valRef = NULL;
 	_persistent = false;
 	_isConstVar = false;
+	propsChanged();
 }
 
 
@@ -99,6 +104,7 @@ ScValue::ScValue(BaseGame *inGame, double val) : BaseClass(inGame) {
 	_valRef = NULL;
 	_persistent = false;
 	_isConstVar = false;
+	propsChanged();
 }
 
 
@@ -115,6 +121,7 @@ ScValue::ScValue(BaseGame *inGame, const char *val) : BaseClass(inGame) {
 	_valRef = NULL;
 	_persistent = false;
 	_isConstVar = false;
+	propsChanged();
 }
 
 
@@ -201,6 +208,7 @@ bool ScValue::deleteProp(const char *name) {
 	if (_valIter != _valObject.end()) {
 		delete _valIter->_value;
 		_valIter->_value = NULL;
+		propsChanged();
 	}
 
 	return STATUS_OK;
@@ -228,13 +236,14 @@ bool ScValue::setProp(const char *name, ScValue *val, bool copyWhole, bool setAs
 		}
 		if (!newVal) {
 			newVal = new ScValue(_gameRef);
+			_valObject[name] = newVal;
+			propsChanged();
 		} else {
 			newVal->cleanup();
 		}
 
 		newVal->copy(val, copyWhole);
 		newVal->_isConstVar = setAsConst;
-		_valObject[name] = newVal;
 
 		if (_type != VAL_NATIVE) {
 			_type = VAL_OBJECT;
@@ -272,12 +281,23 @@ bool ScValue::propExists(const char *name) {
 
 //////////////////////////////////////////////////////////////////////////
 void ScValue::deleteProps() {
+	if (_valObject.empty()) {
+		return;
+	}
+
 	_valIter = _valObject.begin();
 	while (_valIter != _valObject.end()) {
 		delete(ScValue *)_valIter->_value;
 		_valIter++;
 	}
 	_valObject.clear();
+	propsChanged();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+void ScValue::propsChanged() {
+	_propsGeneration = ++s_propsGeneration;
 }
 
 
@@ -747,6 +767,7 @@ void ScValue::copy(ScValue *orig, bool copyWhole) {
 			_valObject[orig->_valIter->_key]->copy(orig->_valIter->_value);
 			orig->_valIter++;
 		}
+		propsChanged();
 	} else {
 		_valObject.clear();
 	}
@@ -822,6 +843,7 @@ bool ScValue::persist(BasePersistenceManager *persistMgr) {
 			_valObject[str] = val;
 			delete[] str;
 		}
+		propsChanged();
 	}
 
 	persistMgr->transfer(TMEMBER(_valRef));
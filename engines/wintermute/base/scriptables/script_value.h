@@ -100,12 +100,18 @@ public:
 	virtual ~ScValue();
 	Common::HashMap<Common::String, ScValue *> _valObject;
 	Common::HashMap<Common::String, ScValue *>::iterator _valIter;
+	// Changes whenever properties are added to or removed from _valObject.
+	// Generations are unique across all values, so a cached generation
+	// never matches a different (or a recreated) value.
+	uint32 _propsGeneration;
 
 	bool setProperty(const char *propName, int value);
 	bool setProperty(const char *propName, const char *value);
 	bool setProperty(const char *propName, double value);
 	bool setProperty(const char *propName, bool value);
 	bool setProperty(const char *propName);
+private:
+	void propsChanged();
 };
 
 } // end of namespace Wintermute
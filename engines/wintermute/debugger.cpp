@@ -0,0 +1,169 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "engines/wintermute/debugger.h"
+#include "engines/wintermute/wintermute.h"
+#include "engines/wintermute/graphics/transparent_surface.h"
+#include "engines/wintermute/graphics/transparent_surface_simd.h"
+
+#include "common/endian.h"
+#include "common/rect.h"
+#include "common/system.h"
+
+namespace Wintermute {
+
+Console::Console(WintermuteEngine *vm) : GUI::Debugger(), _engineRef(vm) {
+	DCmd_Register("blitbench", WRAP_METHOD(Console, Cmd_BlitBench));
+}
+
+Console::~Console() {
+}
+
+/**
+ * Fills a surface with pseudo random pixels. A quarter of them is fully
+ * transparent and a quarter fully opaque, like in typical sprites.
+ */
+static void fillBenchmarkSurface(Graphics::Surface &surface, uint32 seed) {
+	uint32 *pixels = (uint32 *)surface.pixels;
+	for (int i = 0; i < surface.w * surface.h; i++) {
+		seed = seed * 1103515245 + 12345;
+		uint32 color = seed >> 8;
+		switch (seed >> 30) {
+		case 0:
+			color &= 0x00ffffff;
+			break;
+		case 1:
+			color |= 0xff000000;
+			break;
+		default:
+			color = (color & 0x00ffffff) | ((seed & 0xff) << 24);
+			break;
+		}
+		pixels[i] = color;
+	}
+}
+
+struct BlitBenchmark {
+	const char *name;
+	int flipping;
+	byte a, r, g, b;
+};
+
+static const BlitBenchmark blitBenchmarks[] = {
+	{ "alpha",             TransparentSurface::FLIP_NONE, 255, 255, 255, 255 },
+	{ "alpha, mirrored",   TransparentSurface::FLIP_V,    255, 255, 255, 255 },
+	{ "alpha, flipped",    TransparentSurface::FLIP_HV,   255, 255, 255, 255 },
+	{ "color mod",         TransparentSurface::FLIP_NONE, 255, 255, 128, 0 },
+	{ "color mod, faded",  TransparentSurface::FLIP_NONE, 160, 255, 255, 255 },
+	{ "color mod, mirror", TransparentSurface::FLIP_V,    200, 64, 255, 128 }
+};
+
+bool Console::Cmd_BlitBench(int argc, const char **argv) {
+	int iterations = 100;
+	if (argc > 1)
+		iterations = MAX(atoi(argv[1]), 1);
+
+	const int srcW = 254, srcH = 254;
+	const int dstW = 800, dstH = 600;
+	const Graphics::PixelFormat format(4, 8, 8, 8, 8, 16, 8, 0, 24);
+
+	TransparentSurface src;
+	src.create(srcW, srcH, format);
+	fillBenchmarkSurface(src, 1);
+
+	Graphics::Surface background, scalarTarget, simdTarget;
+	background.create(dstW, dstH, format);
+	fillBenchmarkSurface(background, 2);
+	scalarTarget.create(dstW, dstH, format);
+	simdTarget.create(dstW, dstH, format);
+
+	DebugPrintf("Blitting %dx%d pixels %d times, SIMD kernels %savailable\n", srcW, srcH, iterations, hasSIMDBlit() ? "" : "not ");
+
+	for (uint i = 0; i < ARRAYSIZE(blitBenchmarks); i++) {
+		const BlitBenchmark &bench = blitBenchmarks[i];
+		uint32 millis[2];
+
+		for (int simd = 0; simd < 2; simd++) {
+			Graphics::Surface &target = simd ? simdTarget : scalarTarget;
+			memcpy(target.pixels, background.pixels, dstH * target.pitch);
+			enableSIMDBlit(simd != 0);
+
+			const uint32 start = g_system->getMillis();
+			for (int j = 0; j < iterations; j++) {
+				Common::Rect srcRect(0, 0, srcW, srcH);
+				src.blit(target, (j * 37) % (dstW - srcW), (j * 23) % (dstH - srcH), bench.flipping, &srcRect, BS_ARGB((uint)bench.a, bench.r, bench.g, bench.b));
+			}
+			millis[simd] = g_system->getMillis() - start;
+		}
+
+		const bool identical = !memcmp(scalarTarget.pixels, simdTarget.pixels, dstH * scalarTarget.pitch);
+		DebugPrintf("%-18s scalar %5d ms, SIMD %5d ms, %s\n", bench.name, millis[0], millis[1], identical ? "identical" : "MISMATCH");
+	}
+
+	enableSIMDBlit(true);
+
+	// Compare the stepping scaler with the former division per pixel
+	const int scaledW = 371, scaledH = 197;
+	uint32 start = g_system->getMillis();
+	Graphics::Surface reference;
+	reference.create(scaledW, scaledH, format);
+	for (int j = 0; j < iterations; j++) {
+		for (int y = 0; y < scaledH; y++) {
+			for (int x = 0; x < scaledW; x++) {
+				uint32 color = READ_UINT32((const byte *)src.getBasePtr(x * srcW / scaledW, y * srcH / scaledH));
+				WRITE_UINT32((byte *)reference.getBasePtr(x, y), color);
+			}
+		}
+	}
+	const uint32 referenceMillis = g_system->getMillis() - start;
+
+	for (int bilinear = 0; bilinear < 2; bilinear++) {
+		TransparentSurface *scaled = NULL;
+		start = g_system->getMillis();
+		for (int j = 0; j < iterations; j++) {
+			if (scaled) {
+				scaled->free();
+				delete scaled;
+			}
+			scaled = src.scale(scaledW, scaledH, bilinear != 0);
+		}
+		const uint32 millis = g_system->getMillis() - start;
+
+		if (bilinear) {
+			DebugPrintf("%-18s %5d ms\n", "scale, bilinear", millis);
+		} else {
+			const bool identical = !memcmp(reference.pixels, scaled->pixels, scaledH * reference.pitch);
+			DebugPrintf("%-18s division %5d ms, stepping %5d ms, %s\n", "scale", referenceMillis, millis, identical ? "identical" : "MISMATCH");
+		}
+
+		scaled->free();
+		delete scaled;
+	}
+
+	reference.free();
+	simdTarget.free();
+	scalarTarget.free();
+	background.free();
+	src.free();
+	return true;
+}
+
+} // End of namespace Wintermute
@@ -26,16 +26,10 @@
 #include "common/textconsole.h"
 #include "graphics/primitives.h"
 #include "engines/wintermute/graphics/transparent_surface.h"
+#include "engines/wintermute/graphics/transparent_surface_simd.h"
 
 namespace Wintermute {
 
-byte *TransparentSurface::_lookup = NULL;
-
-void TransparentSurface::destroyLookup() {
-	delete _lookup;
-	_lookup = NULL;
-}
-
 TransparentSurface::TransparentSurface() : Surface(), _enableAlphaBlit(true) {}
 
 TransparentSurface::TransparentSurface(const Surface &surf, bool copyData) : Surface(), _enableAlphaBlit(true) {
@@ -72,96 +66,26 @@ void doBlitOpaque(byte *ino, byte* outo, uint32 width, uint32 height, uint32 pit
 	}
 }
 
-void TransparentSurface::generateLookup() {
-	_lookup = new byte[256 * 256];
-	for (int i = 0; i < 256; i++) {
-		for (int j = 0; j < 256; j++) {
-			_lookup[(i << 8) + j] = (i * j) >> 8;
-		}
-	}
-}
-
-void TransparentSurface::doBlitAlpha(byte *ino, byte* outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
-	byte *in, *out;
+void TransparentSurface::doBlitAlpha(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const BlitAlphaRowFunc blitRow = getBlitAlphaRowFunc();
 
-	if (!_lookup) {
-		generateLookup();
+	for (uint32 i = 0; i < height; i++) {
+		blitRow(ino, outo, width, inStep);
+		outo += pitch;
+		ino += inoStep;
 	}
+}
 
-#ifdef SCUMM_LITTLE_ENDIAN
-	const int aIndex = 3;
-	const int bIndex = 0;
-	const int gIndex = 1;
-	const int rIndex = 2;
-#else
-	const int aIndex = 0;
-	const int bIndex = 3;
-	const int gIndex = 2;
-	const int rIndex = 1;
-#endif
-
-	const int bShift = 0;//img->format.bShift;
-	const int gShift = 8;//img->format.gShift;
-	const int rShift = 16;//img->format.rShift;
-	const int aShift = 24;//img->format.aShift;
-
-	const int bShiftTarget = 0;//target.format.bShift;
-	const int gShiftTarget = 8;//target.format.gShift;
-	const int rShiftTarget = 16;//target.format.rShift;
+void TransparentSurface::doBlitColorMod(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, const BlitColorMod &mod) {
+	const BlitColorModRowFunc blitRow = getBlitColorModRowFunc();
 
 	for (uint32 i = 0; i < height; i++) {
-		out = outo;
-		in = ino;
-		for (uint32 j = 0; j < width; j++) {
-			uint32 pix = *(uint32 *)in;
-			uint32 oPix = *(uint32 *) out;
-			int b = (pix >> bShift) & 0xff;
-			int g = (pix >> gShift) & 0xff;
-			int r = (pix >> rShift) & 0xff;
-			int a = (pix >> aShift) & 0xff;
-			int outb, outg, outr, outa;
-			in += inStep;
-
-			switch (a) {
-				case 0: // Full transparency
-					out += 4;
-					break;
-				case 255: // Full opacity
-					outb = b;
-					outg = g;
-					outr = r;
-					outa = a;
-
-					out[aIndex] = outa;
-					out[bIndex] = outb;
-					out[gIndex] = outg;
-					out[rIndex] = outr;
-					out += 4;
-					break;
-
-				default: // alpha blending
-					outa = 255;
-
-					outb = _lookup[(((oPix >> bShiftTarget) & 0xff)) + ((255 - a) << 8)];
-					outg = _lookup[(((oPix >> gShiftTarget) & 0xff)) + ((255 - a) << 8)];
-					outr = _lookup[(((oPix >> rShiftTarget) & 0xff)) + ((255 - a) << 8)];
-					outb += _lookup[b + (a << 8)];
-					outg += _lookup[g + (a << 8)];
-					outr += _lookup[r + (a << 8)];
-
-					out[aIndex] = outa;
-					out[bIndex] = outb;
-					out[gIndex] = outg;
-					out[rIndex] = outr;
-					out += 4;
-			}
-		}
+		blitRow(ino, outo, width, inStep, mod);
 		outo += pitch;
 		ino += inoStep;
 	}
 }
 
-
 Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int posY, int flipping, Common::Rect *pPartRect, uint color, int width, int height) {
 	int ca = (color >> 24) & 0xff;
 
@@ -262,27 +186,6 @@ Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int p
 
 		byte *ino = (byte *)img->getBasePtr(xp, yp);
 		byte *outo = (byte *)target.getBasePtr(posX, posY);
-		byte *in, *out;
-
-#ifdef SCUMM_LITTLE_ENDIAN
-		const int aIndex = 3;
-		const int bIndex = 0;
-		const int gIndex = 1;
-		const int rIndex = 2;
-#else
-		const int aIndex = 0;
-		const int bIndex = 3;
-		const int gIndex = 2;
-		const int rIndex = 1;
-#endif
-		const int bShift = 0;//img->format.bShift;
-		const int gShift = 8;//img->format.gShift;
-		const int rShift = 16;//img->format.rShift;
-		const int aShift = 24;//img->format.aShift;
-
-		const int bShiftTarget = 0;//target.format.bShift;
-		const int gShiftTarget = 8;//target.format.gShift;
-		const int rShiftTarget = 16;//target.format.rShift;
 
 		if (ca == 255 && cb == 255 && cg == 255 && cr == 255) {
 			if (_enableAlphaBlit) {
@@ -291,83 +194,12 @@ Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int p
 				doBlitOpaque(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
 			}
 		} else {
-			for (int i = 0; i < img->h; i++) {
-				out = outo;
-				in = ino;
-				for (int j = 0; j < img->w; j++) {
-					uint32 pix = *(uint32 *)in;
-					uint32 o_pix = *(uint32 *) out;
-					int b = (pix >> bShift) & 0xff;
-					int g = (pix >> gShift) & 0xff;
-					int r = (pix >> rShift) & 0xff;
-					int a = (pix >> aShift) & 0xff;
-					int outb, outg, outr, outa;
-					in += inStep;
-
-					if (ca != 255) {
-						a = a * ca >> 8;
-					}
-
-					switch (a) {
-					case 0: // Full transparency
-						out += 4;
-						break;
-					case 255: // Full opacity
-						if (cb != 255)
-							outb = (b * cb) >> 8;
-						else
-							outb = b;
-
-						if (cg != 255)
-							outg = (g * cg) >> 8;
-						else
-							outg = g;
-
-						if (cr != 255)
-							outr = (r * cr) >> 8;
-						else
-							outr = r;
-						outa = a;
-						out[aIndex] = outa;
-						out[bIndex] = outb;
-						out[gIndex] = outg;
-						out[rIndex] = outr;
-						out += 4;
-						break;
-
-					default: // alpha blending
-						outa = 255;
-						outb = (o_pix >> bShiftTarget) & 0xff;
-						outg = (o_pix >> gShiftTarget) & 0xff;
-						outr = (o_pix >> rShiftTarget) & 0xff;
-						if (cb == 0)
-							outb = 0;
-						else if (cb != 255)
-							outb += ((b - outb) * a * cb) >> 16;
-						else
-							outb += ((b - outb) * a) >> 8;
-						if (cg == 0)
-							outg = 0;
-						else if (cg != 255)
-							outg += ((g - outg) * a * cg) >> 16;
-						else
-							outg += ((g - outg) * a) >> 8;
-						if (cr == 0)
-							outr = 0;
-						else if (cr != 255)
-							outr += ((r - outr) * a * cr) >> 16;
-						else
-							outr += ((r - outr) * a) >> 8;
-						out[aIndex] = outa;
-						out[bIndex] = outb;
-						out[gIndex] = outg;
-						out[rIndex] = outr;
-						out += 4;
-					}
-				}
-				outo += target.pitch;
-				ino += inoStep;
-			}
+			BlitColorMod mod;
+			mod.a = ca;
+			mod.r = cr;
+			mod.g = cg;
+			mod.b = cb;
+			doBlitColorMod(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, mod);
 		}
 	}
 
@@ -382,34 +214,98 @@ Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int p
 	return retSize;
 }
 
-TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight) const {
+TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight, bool bilinear) const {
 	Common::Rect srcRect(0, 0, (int16)w, (int16)h);
 	Common::Rect dstRect(0, 0, (int16)newWidth, (int16)newHeight);
-	return scale(srcRect, dstRect);
+	return scale(srcRect, dstRect, bilinear);
+}
+
+/**
+ * Interpolates two ARGB pixels, two components at a time.
+ * @param f the weight of the second pixel, between 0 and 256
+ */
+static inline uint32 lerpPixel(uint32 p0, uint32 p1, uint32 f) {
+	const uint32 rb = ((((p0 & 0x00ff00ff) * (256 - f)) + ((p1 & 0x00ff00ff) * f)) >> 8) & 0x00ff00ff;
+	const uint32 ag = ((((p0 >> 8) & 0x00ff00ff) * (256 - f)) + (((p1 >> 8) & 0x00ff00ff) * f)) & 0xff00ff00;
+	return rb | ag;
 }
 
-// Copied from clone2727's https://github.com/clone2727/scummvm/blob/pegasus/engines/pegasus/surface.cpp#L247
-TransparentSurface *TransparentSurface::scale(const Common::Rect &srcRect, const Common::Rect &dstRect) const {
-	// I'm doing simple linear scaling here
-	// dstRect(x, y) = srcRect(x * srcW / dstW, y * srcH / dstH);
+// Based on clone2727's https://github.com/clone2727/scummvm/blob/pegasus/engines/pegasus/surface.cpp#L247
+TransparentSurface *TransparentSurface::scale(const Common::Rect &srcRect, const Common::Rect &dstRect, bool bilinear) const {
 	TransparentSurface *target = new TransparentSurface();
 
-	int srcW = srcRect.width();
-	int srcH = srcRect.height();
-	int dstW = dstRect.width();
-	int dstH = dstRect.height();
+	const int srcW = srcRect.width();
+	const int srcH = srcRect.height();
+	const int dstW = dstRect.width();
+	const int dstH = dstRect.height();
 
 	target->create((uint16)dstW, (uint16)dstH, this->format);
 
-	for (int y = 0; y < dstH; y++) {
-		for (int x = 0; x < dstW; x++) {
-			uint32 color = READ_UINT32((const byte *)getBasePtr(x * srcW / dstW + srcRect.left,
-														  y * srcH / dstH + srcRect.top));
-			WRITE_UINT32((byte *)target->getBasePtr(x + dstRect.left, y + dstRect.top), color);
+	if (srcW <= 0 || srcH <= 0 || dstW <= 0 || dstH <= 0)
+		return target;
+
+	if (!bilinear) {
+		// dstRect(x, y) = srcRect(x * srcW / dstW, y * srcH / dstH);
+		// The source position is stepped through with an integer part and
+		// a remainder, which gives the same result without a division per
+		// pixel.
+		const int xStep = srcW / dstW, xRem = srcW % dstW;
+		const int yStep = srcH / dstH, yRem = srcH % dstH;
+		int srcY = srcRect.top, yErr = 0;
+
+		for (int y = 0; y < dstH; y++) {
+			const uint32 *src = (const uint32 *)getBasePtr(srcRect.left, srcY);
+			uint32 *dst = (uint32 *)target->getBasePtr(dstRect.left, y + dstRect.top);
+			int srcX = 0, xErr = 0;
+
+			for (int x = 0; x < dstW; x++) {
+				dst[x] = src[srcX];
+				srcX += xStep;
+				xErr += xRem;
+				if (xErr >= dstW) {
+					xErr -= dstW;
+					srcX++;
+				}
+			}
+
+			srcY += yStep;
+			yErr += yRem;
+			if (yErr >= dstH) {
+				yErr -= dstH;
+				srcY++;
+			}
+		}
+	} else {
+		// Sample the source at the centers of the target pixels, stepping
+		// in 16.16 fixed point and weighting with 8 bits of the fraction.
+		const int32 xStep = (srcW << 16) / dstW;
+		const int32 yStep = (srcH << 16) / dstH;
+		int32 srcY = yStep / 2 - 0x8000;
+
+		for (int y = 0; y < dstH; y++, srcY += yStep) {
+			const int32 clampedY = MAX<int32>(srcY, 0);
+			const int y0 = clampedY >> 16;
+			const int y1 = MIN(y0 + 1, srcH - 1);
+			const uint32 fy = (clampedY >> 8) & 0xff;
+			const uint32 *src0 = (const uint32 *)getBasePtr(srcRect.left, srcRect.top + y0);
+			const uint32 *src1 = (const uint32 *)getBasePtr(srcRect.left, srcRect.top + y1);
+			uint32 *dst = (uint32 *)target->getBasePtr(dstRect.left, y + dstRect.top);
+			int32 srcX = xStep / 2 - 0x8000;
+
+			for (int x = 0; x < dstW; x++, srcX += xStep) {
+				const int32 clampedX = MAX<int32>(srcX, 0);
+				const int x0 = clampedX >> 16;
+				const int x1 = MIN(x0 + 1, srcW - 1);
+				const uint32 fx = (clampedX >> 8) & 0xff;
+
+				const uint32 top = lerpPixel(src0[x0], src0[x1], fx);
+				const uint32 bottom = lerpPixel(src1[x0], src1[x1], fx);
+				dst[x] = lerpPixel(top, bottom, fy);
+			}
 		}
 	}
-	return target;
 
+	return target;
 }
 
 /**
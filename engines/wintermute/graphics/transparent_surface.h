@@ -39,6 +39,8 @@
 
 namespace Wintermute {
 
+struct BlitColorMod;
+
 /**
  * A transparent graphics surface, which implements alpha blitting.
  */
@@ -103,13 +105,12 @@ struct TransparentSurface : public Graphics::Surface {
 	                  int width = -1, int height = -1);
 	void applyColorKey(uint8 r, uint8 g, uint8 b, bool overwriteAlpha = false);
 	// The following scale-code supports arbitrary scaling (i.e. no repeats of column 0 at the end of lines)
-	TransparentSurface *scale(uint16 newWidth, uint16 newHeight) const;
-	TransparentSurface *scale(const Common::Rect &srcRect, const Common::Rect &dstRect) const;
-	static byte *_lookup;
-	static void destroyLookup();
+	// Nearest neighbour sampling is used, unless bilinear filtering is requested.
+	TransparentSurface *scale(uint16 newWidth, uint16 newHeight, bool bilinear = false) const;
+	TransparentSurface *scale(const Common::Rect &srcRect, const Common::Rect &dstRect, bool bilinear = false) const;
 private:
-	static void doBlitAlpha(byte *ino, byte* outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
-	static void generateLookup();
+	static void doBlitAlpha(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
+	static void doBlitColorMod(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, const BlitColorMod &mod);
 };
 
 /**
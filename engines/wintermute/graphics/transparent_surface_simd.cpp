@@ -0,0 +1,426 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Row kernels used by TransparentSurface::blit().
+ *
+ * Pixels are handled as native 32 bit values with the alpha channel in the
+ * top byte, so the scalar kernels work on either endianness. They are the
+ * reference implementation: the SSE2 and NEON kernels process four pixels
+ * at a time and produce bit-identical output. They are only built for
+ * little endian targets.
+ *
+ * SSE2 kernels are built with a function level target attribute on GCC, so
+ * 32 bit x86 builds pick them at runtime only on CPUs supporting SSE2.
+ */
+
+#include "engines/wintermute/graphics/transparent_surface_simd.h"
+
+#include "common/simd.h"
+
+#if defined(SCUMM_LITTLE_ENDIAN)
+#if defined(SCUMMVM_SIMD_SSE2)
+#define BLIT_SIMD_SSE2
+#elif defined(SCUMMVM_SIMD_NEON)
+#define BLIT_SIMD_NEON
+#endif
+#endif
+
+namespace Wintermute {
+
+static bool s_simdEnabled = true;
+
+#pragma mark -
+#pragma mark --- Scalar kernels ---
+#pragma mark -
+
+static void blitAlphaRowScalar(const byte *in, byte *out, uint32 width, int32 inStep) {
+	for (; width > 0; width--, in += inStep, out += 4) {
+		const uint32 pix = *(const uint32 *)in;
+		const uint32 a = pix >> 24;
+
+		if (a == 0) // Full transparency
+			continue;
+
+		if (a == 255) { // Full opacity
+			*(uint32 *)out = pix;
+			continue;
+		}
+
+		// Alpha blending
+		const uint32 oPix = *(const uint32 *)out;
+		const uint32 ia = 255 - a;
+		const uint32 outb = ((((oPix >>  0) & 0xff) * ia) >> 8) + ((((pix >>  0) & 0xff) * a) >> 8);
+		const uint32 outg = ((((oPix >>  8) & 0xff) * ia) >> 8) + ((((pix >>  8) & 0xff) * a) >> 8);
+		const uint32 outr = ((((oPix >> 16) & 0xff) * ia) >> 8) + ((((pix >> 16) & 0xff) * a) >> 8);
+		*(uint32 *)out = 0xff000000 | (outr << 16) | (outg << 8) | outb;
+	}
+}
+
+static inline int blendColorModScalar(int c, int o, int a, int mod) {
+	if (mod == 0)
+		return 0;
+	else if (mod != 255)
+		return o + (((c - o) * a * mod) >> 16);
+	else
+		return o + (((c - o) * a) >> 8);
+}
+
+static void blitColorModRowScalar(const byte *in, byte *out, uint32 width, int32 inStep, const BlitColorMod &mod) {
+	for (; width > 0; width--, in += inStep, out += 4) {
+		const uint32 pix = *(const uint32 *)in;
+		int b = (pix >>  0) & 0xff;
+		int g = (pix >>  8) & 0xff;
+		int r = (pix >> 16) & 0xff;
+		int a = (pix >> 24) & 0xff;
+
+		if (mod.a != 255)
+			a = a * mod.a >> 8;
+
+		if (a == 0) // Full transparency
+			continue;
+
+		if (a == 255) { // Full opacity
+			if (mod.b != 255)
+				b = (b * mod.b) >> 8;
+			if (mod.g != 255)
+				g = (g * mod.g) >> 8;
+			if (mod.r != 255)
+				r = (r * mod.r) >> 8;
+			*(uint32 *)out = 0xff000000 | (r << 16) | (g << 8) | b;
+			continue;
+		}
+
+		// Alpha blending
+		const uint32 oPix = *(const uint32 *)out;
+		const int outb = blendColorModScalar(b, (oPix >>  0) & 0xff, a, mod.b);
+		const int outg = blendColorModScalar(g, (oPix >>  8) & 0xff, a, mod.g);
+		const int outr = blendColorModScalar(r, (oPix >> 16) & 0xff, a, mod.r);
+		*(uint32 *)out = 0xff000000 | (outr << 16) | (outg << 8) | outb;
+	}
+}
+
+/**
+ * Returns the factor the vector kernels multiply a color component with,
+ * followed by a shift right by 8. A modulation of 255 leaves the component
+ * untouched in the scalar code, which corresponds to a factor of 256.
+ */
+static inline int16 getModFactor(int mod) {
+	return (int16)(mod == 255 ? 256 : mod);
+}
+
+#ifdef BLIT_SIMD_SSE2
+
+#pragma mark -
+#pragma mark --- SSE2 kernels ---
+#pragma mark -
+
+/**
+ * Loads the next four source pixels in drawing order. For mirrored rows
+ * 'in' points at the first pixel to draw and the others precede it.
+ */
+SCUMMVM_SSE2_TARGET
+static inline __m128i loadPixelsSSE2(const byte *in, int32 inStep) {
+	if (inStep > 0)
+		return _mm_loadu_si128((const __m128i *)in);
+	return _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(in - 12)), _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+SCUMMVM_SSE2_TARGET
+static inline __m128i selectSSE2(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/**
+ * Spreads the per pixel alphas (one per 32 bit lane) to the 16 bit lanes
+ * of the unpacked color components of the low and high pixel pairs.
+ */
+SCUMMVM_SSE2_TARGET
+static inline void spreadAlphaSSE2(__m128i alpha, __m128i &lo, __m128i &hi) {
+	const __m128i a16 = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+	lo = _mm_unpacklo_epi32(a16, a16);
+	hi = _mm_unpackhi_epi32(a16, a16);
+}
+
+SCUMMVM_SSE2_TARGET
+static inline __m128i blendAlphaSSE2(__m128i c, __m128i o, __m128i a) {
+	const __m128i ia = _mm_xor_si128(a, _mm_set1_epi16(255));
+	return _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(o, ia), 8), _mm_srli_epi16(_mm_mullo_epi16(c, a), 8));
+}
+
+/**
+ * Computes o + (((c - o) * w) >> 16) for unsigned 16 bit weights. The
+ * unsigned high multiply of the wrapped difference is off by w for
+ * negative differences, which is corrected afterwards.
+ */
+SCUMMVM_SSE2_TARGET
+static inline __m128i blendColorModSSE2(__m128i c, __m128i o, __m128i w) {
+	const __m128i d = _mm_sub_epi16(c, o);
+	const __m128i t = _mm_sub_epi16(_mm_mulhi_epu16(d, w), _mm_and_si128(w, _mm_srai_epi16(d, 15)));
+	return _mm_add_epi16(o, t);
+}
+
+SCUMMVM_SSE2_TARGET
+static void blitAlphaRowSSE2(const byte *in, byte *out, uint32 width, int32 inStep) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32(255);
+	const __m128i alphaMask = _mm_set1_epi32((int)0xff000000);
+
+	for (; width >= 4; width -= 4, in += 4 * inStep, out += 16) {
+		const __m128i pix = loadPixelsSSE2(in, inStep);
+		const __m128i alpha = _mm_srli_epi32(pix, 24);
+		const __m128i transparent = _mm_cmpeq_epi32(alpha, zero);
+		if (_mm_movemask_epi8(transparent) == 0xffff)
+			continue;
+
+		const __m128i oPix = _mm_loadu_si128((const __m128i *)out);
+		__m128i aLo, aHi;
+		spreadAlphaSSE2(alpha, aLo, aHi);
+
+		const __m128i lo = blendAlphaSSE2(_mm_unpacklo_epi8(pix, zero), _mm_unpacklo_epi8(oPix, zero), aLo);
+		const __m128i hi = blendAlphaSSE2(_mm_unpackhi_epi8(pix, zero), _mm_unpackhi_epi8(oPix, zero), aHi);
+
+		__m128i result = _mm_or_si128(_mm_packus_epi16(lo, hi), alphaMask);
+		result = selectSSE2(_mm_cmpeq_epi32(alpha, opaque), pix, result);
+		result = selectSSE2(transparent, oPix, result);
+		_mm_storeu_si128((__m128i *)out, result);
+	}
+
+	blitAlphaRowScalar(in, out, width, inStep);
+}
+
+SCUMMVM_SSE2_TARGET
+static void blitColorModRowSSE2(const byte *in, byte *out, uint32 width, int32 inStep, const BlitColorMod &mod) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32(255);
+	const __m128i alphaMask = _mm_set1_epi32((int)0xff000000);
+	const __m128i alphaFactor = _mm_set1_epi32(getModFactor(mod.a));
+
+	// Color factors and the mask of the components which are not zeroed by
+	// the modulation, in the component order of the unpacked pixels (b, g,
+	// r, a). The alpha lane is replaced with 255 in the end.
+	const int16 fb = getModFactor(mod.b), fg = getModFactor(mod.g), fr = getModFactor(mod.r);
+	const __m128i colorFactor = _mm_set_epi16(0, fr, fg, fb, 0, fr, fg, fb);
+	const int16 kb = mod.b ? -1 : 0, kg = mod.g ? -1 : 0, kr = mod.r ? -1 : 0;
+	const __m128i keep = _mm_set_epi16(0, kr, kg, kb, 0, kr, kg, kb);
+
+	for (; width >= 4; width -= 4, in += 4 * inStep, out += 16) {
+		const __m128i pix = loadPixelsSSE2(in, inStep);
+		// Alphas and factors fit into the low 16 bits of each lane
+		const __m128i alpha = _mm_srli_epi32(_mm_mullo_epi16(_mm_srli_epi32(pix, 24), alphaFactor), 8);
+		const __m128i transparent = _mm_cmpeq_epi32(alpha, zero);
+		if (_mm_movemask_epi8(transparent) == 0xffff)
+			continue;
+
+		const __m128i oPix = _mm_loadu_si128((const __m128i *)out);
+		__m128i aLo, aHi;
+		spreadAlphaSSE2(alpha, aLo, aHi);
+
+		const __m128i cLo = _mm_unpacklo_epi8(pix, zero);
+		const __m128i cHi = _mm_unpackhi_epi8(pix, zero);
+		const __m128i oLo = _mm_unpacklo_epi8(oPix, zero);
+		const __m128i oHi = _mm_unpackhi_epi8(oPix, zero);
+
+		const __m128i solidLo = _mm_srli_epi16(_mm_mullo_epi16(cLo, colorFactor), 8);
+		const __m128i solidHi = _mm_srli_epi16(_mm_mullo_epi16(cHi, colorFactor), 8);
+		const __m128i solid = _mm_or_si128(_mm_packus_epi16(solidLo, solidHi), alphaMask);
+
+		const __m128i blendLo = _mm_and_si128(blendColorModSSE2(cLo, oLo, _mm_mullo_epi16(aLo, colorFactor)), keep);
+		const __m128i blendHi = _mm_and_si128(blendColorModSSE2(cHi, oHi, _mm_mullo_epi16(aHi, colorFactor)), keep);
+
+		__m128i result = _mm_or_si128(_mm_packus_epi16(blendLo, blendHi), alphaMask);
+		result = selectSSE2(_mm_cmpeq_epi32(alpha, opaque), solid, result);
+		result = selectSSE2(transparent, oPix, result);
+		_mm_storeu_si128((__m128i *)out, result);
+	}
+
+	blitColorModRowScalar(in, out, width, inStep, mod);
+}
+
+#endif // BLIT_SIMD_SSE2
+
+#ifdef BLIT_SIMD_NEON
+
+#pragma mark -
+#pragma mark --- NEON kernels ---
+#pragma mark -
+
+/**
+ * Loads the next four source pixels in drawing order. For mirrored rows
+ * 'in' points at the first pixel to draw and the others precede it.
+ */
+static inline uint32x4_t loadPixelsNEON(const byte *in, int32 inStep) {
+	if (inStep > 0)
+		return vld1q_u32((const uint32 *)in);
+	const uint32x4_t p = vrev64q_u32(vld1q_u32((const uint32 *)(in - 12)));
+	return vcombine_u32(vget_high_u32(p), vget_low_u32(p));
+}
+
+static inline bool allSetNEON(uint32x4_t mask) {
+	const uint32x2_t m = vand_u32(vget_low_u32(mask), vget_high_u32(mask));
+	return (vget_lane_u32(m, 0) & vget_lane_u32(m, 1)) == 0xffffffff;
+}
+
+static inline uint32x4_t packPixelsNEON(uint16x8_t lo, uint16x8_t hi) {
+	return vreinterpretq_u32_u8(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+}
+
+static inline uint16x8_t blendAlphaNEON(uint16x8_t c, uint16x8_t o, uint16x8_t a) {
+	const uint16x8_t ia = vsubq_u16(vdupq_n_u16(255), a);
+	return vaddq_u16(vshrq_n_u16(vmulq_u16(o, ia), 8), vshrq_n_u16(vmulq_u16(c, a), 8));
+}
+
+/**
+ * Computes o + (((c - o) * w) >> 16) for unsigned 16 bit weights. The
+ * unsigned high multiply of the wrapped difference is off by w for
+ * negative differences, which is corrected afterwards.
+ */
+static inline uint16x8_t blendColorModNEON(uint16x8_t c, uint16x8_t o, uint16x8_t w) {
+	const uint16x8_t d = vsubq_u16(c, o);
+	const uint32x4_t pLo = vmull_u16(vget_low_u16(d), vget_low_u16(w));
+	const uint32x4_t pHi = vmull_u16(vget_high_u16(d), vget_high_u16(w));
+	const uint16x8_t high = vcombine_u16(vshrn_n_u32(pLo, 16), vshrn_n_u32(pHi, 16));
+	const uint16x8_t negative = vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(d), 15));
+	return vaddq_u16(o, vsubq_u16(high, vandq_u16(w, negative)));
+}
+
+static void blitAlphaRowNEON(const byte *in, byte *out, uint32 width, int32 inStep) {
+	const uint32x4_t zero = vdupq_n_u32(0);
+	const uint32x4_t opaque = vdupq_n_u32(255);
+	const uint32x4_t alphaMask = vdupq_n_u32(0xff000000);
+
+	for (; width >= 4; width -= 4, in += 4 * inStep, out += 16) {
+		const uint32x4_t pix = loadPixelsNEON(in, inStep);
+		const uint32x4_t alpha = vshrq_n_u32(pix, 24);
+		const uint32x4_t transparent = vceqq_u32(alpha, zero);
+		if (allSetNEON(transparent))
+			continue;
+
+		const uint32x4_t oPix = vld1q_u32((const uint32 *)out);
+		const uint8x16_t a = vreinterpretq_u8_u32(vmulq_n_u32(alpha, 0x01010101));
+		const uint8x16_t c = vreinterpretq_u8_u32(pix);
+		const uint8x16_t o = vreinterpretq_u8_u32(oPix);
+
+		const uint16x8_t lo = blendAlphaNEON(vmovl_u8(vget_low_u8(c)), vmovl_u8(vget_low_u8(o)), vmovl_u8(vget_low_u8(a)));
+		const uint16x8_t hi = blendAlphaNEON(vmovl_u8(vget_high_u8(c)), vmovl_u8(vget_high_u8(o)), vmovl_u8(vget_high_u8(a)));
+
+		uint32x4_t result = vorrq_u32(packPixelsNEON(lo, hi), alphaMask);
+		result = vbslq_u32(vceqq_u32(alpha, opaque), pix, result);
+		result = vbslq_u32(transparent, oPix, result);
+		vst1q_u32((uint32 *)out, result);
+	}
+
+	blitAlphaRowScalar(in, out, width, inStep);
+}
+
+static void blitColorModRowNEON(const byte *in, byte *out, uint32 width, int32 inStep, const BlitColorMod &mod) {
+	const uint32x4_t zero = vdupq_n_u32(0);
+	const uint32x4_t opaque = vdupq_n_u32(255);
+	const uint32x4_t alphaMask = vdupq_n_u32(0xff000000);
+	const uint32 alphaFactor = getModFactor(mod.a);
+
+	// Color factors and the mask of the components which are not zeroed by
+	// the modulation, in the component order of the unpacked pixels (b, g,
+	// r, a). The alpha lane is replaced with 255 in the end.
+	const uint16 fb = getModFactor(mod.b), fg = getModFactor(mod.g), fr = getModFactor(mod.r);
+	const uint16 factors[8] = { fb, fg, fr, 0, fb, fg, fr, 0 };
+	const uint16x8_t colorFactor = vld1q_u16(factors);
+	const uint16 kb = mod.b ? 0xffff : 0, kg = mod.g ? 0xffff : 0, kr = mod.r ? 0xffff : 0;
+	const uint16 keepLanes[8] = { kb, kg, kr, 0, kb, kg, kr, 0 };
+	const uint16x8_t keep = vld1q_u16(keepLanes);
+
+	for (; width >= 4; width -= 4, in += 4 * inStep, out += 16) {
+		const uint32x4_t pix = loadPixelsNEON(in, inStep);
+		const uint32x4_t alpha = vshrq_n_u32(vmulq_n_u32(vshrq_n_u32(pix, 24), alphaFactor), 8);
+		const uint32x4_t transparent = vceqq_u32(alpha, zero);
+		if (allSetNEON(transparent))
+			continue;
+
+		const uint32x4_t oPix = vld1q_u32((const uint32 *)out);
+		const uint8x16_t a = vreinterpretq_u8_u32(vmulq_n_u32(alpha, 0x01010101));
+		const uint8x16_t c = vreinterpretq_u8_u32(pix);
+		const uint8x16_t o = vreinterpretq_u8_u32(oPix);
+
+		const uint16x8_t cLo = vmovl_u8(vget_low_u8(c));
+		const uint16x8_t cHi = vmovl_u8(vget_high_u8(c));
+		const uint16x8_t oLo = vmovl_u8(vget_low_u8(o));
+		const uint16x8_t oHi = vmovl_u8(vget_high_u8(o));
+
+		const uint16x8_t solidLo = vshrq_n_u16(vmulq_u16(cLo, colorFactor), 8);
+		const uint16x8_t solidHi = vshrq_n_u16(vmulq_u16(cHi, colorFactor), 8);
+		const uint32x4_t solid = vorrq_u32(packPixelsNEON(solidLo, solidHi), alphaMask);
+
+		const uint16x8_t blendLo = vandq_u16(blendColorModNEON(cLo, oLo, vmulq_u16(vmovl_u8(vget_low_u8(a)), colorFactor)), keep);
+		const uint16x8_t blendHi = vandq_u16(blendColorModNEON(cHi, oHi, vmulq_u16(vmovl_u8(vget_high_u8(a)), colorFactor)), keep);
+
+		uint32x4_t result = vorrq_u32(packPixelsNEON(blendLo, blendHi), alphaMask);
+		result = vbslq_u32(vceqq_u32(alpha, opaque), solid, result);
+		result = vbslq_u32(transparent, oPix, result);
+		vst1q_u32((uint32 *)out, result);
+	}
+
+	blitColorModRowScalar(in, out, width, inStep, mod);
+}
+
+#endif // BLIT_SIMD_NEON
+
+#pragma mark -
+
+bool hasSIMDBlit() {
+#if defined(BLIT_SIMD_SSE2)
+	static const bool sse2 = Common::hasSSE2();
+	return sse2;
+#elif defined(BLIT_SIMD_NEON)
+	return true;
+#else
+	return false;
+#endif
+}
+
+void enableSIMDBlit(bool enable) {
+	s_simdEnabled = enable;
+}
+
+BlitAlphaRowFunc getBlitAlphaRowFunc() {
+	if (s_simdEnabled && hasSIMDBlit()) {
+#if defined(BLIT_SIMD_SSE2)
+		return &blitAlphaRowSSE2;
+#elif defined(BLIT_SIMD_NEON)
+		return &blitAlphaRowNEON;
+#endif
+	}
+
+	return &blitAlphaRowScalar;
+}
+
+BlitColorModRowFunc getBlitColorModRowFunc() {
+	if (s_simdEnabled && hasSIMDBlit()) {
+#if defined(BLIT_SIMD_SSE2)
+		return &blitColorModRowSSE2;
+#elif defined(BLIT_SIMD_NEON)
+		return &blitColorModRowNEON;
+#endif
+	}
+
+	return &blitColorModRowScalar;
+}
+
+} // End of namespace Wintermute
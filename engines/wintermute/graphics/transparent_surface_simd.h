@@ -0,0 +1,66 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef WINTERMUTE_TRANSPARENT_SURFACE_SIMD_H
+#define WINTERMUTE_TRANSPARENT_SURFACE_SIMD_H
+
+#include "common/scummsys.h"
+
+namespace Wintermute {
+
+/**
+ * The color modulation of a blit. The color components have already been
+ * scaled by the alpha component, like TransparentSurface::blit() does.
+ */
+struct BlitColorMod {
+	int a, r, g, b;
+};
+
+/**
+ * Blends one row of 32 bpp ARGB pixels onto the target row, using the
+ * alpha channel of the source pixels. inStep is 4, or -4 for a mirrored
+ * source, in which case 'in' points at the last pixel of the source row.
+ */
+typedef void (*BlitAlphaRowFunc)(const byte *in, byte *out, uint32 width, int32 inStep);
+
+/**
+ * Like BlitAlphaRowFunc, but additionally modulates the source pixels by
+ * the given color.
+ */
+typedef void (*BlitColorModRowFunc)(const byte *in, byte *out, uint32 width, int32 inStep, const BlitColorMod &mod);
+
+/**
+ * Return the row kernels. The vectorized kernels are picked when the CPU
+ * supports them and SIMD blitting is enabled, otherwise the scalar
+ * reference kernels are returned. Both produce bit-identical output.
+ */
+BlitAlphaRowFunc getBlitAlphaRowFunc();
+BlitColorModRowFunc getBlitColorModRowFunc();
+
+/** Check whether SSE2 or NEON blit kernels are available on this CPU. */
+bool hasSIMDBlit();
+
+/** Enable or disable the SIMD blit kernels (they are enabled by default). */
+void enableSIMDBlit(bool enable);
+
+} // End of namespace Wintermute
+
+#endif
@@ -85,8 +85,10 @@ MODULE_OBJS := \
 	base/base_transition_manager.o \
 	base/base_viewport.o \
 	base/saveload.o \
+	debugger.o \
 	detection.o \
 	graphics/transparent_surface.o \
+	graphics/transparent_surface_simd.o \
 	math/math_util.o \
 	math/matrix4.o \
 	math/vector2.o \
@@ -34,6 +34,7 @@
 #include "engines/util.h"
 #include "engines/wintermute/ad/ad_game.h"
 #include "engines/wintermute/wintermute.h"
+#include "engines/wintermute/debugger.h"
 #include "engines/wintermute/platform_osystem.h"
 #include "engines/wintermute/base/base_engine.h"
 
@@ -48,6 +49,7 @@ namespace Wintermute {
 // This might not be the prettiest solution
 WintermuteEngine::WintermuteEngine() : Engine(g_system) {
 	_game = new AdGame("");
+	_console = NULL;
 }
 
 WintermuteEngine::WintermuteEngine(OSystem *syst, const ADGameDescription *desc)
@@ -71,6 +73,7 @@ WintermuteEngine::WintermuteEngine(OSystem *syst, const ADGameDescription *desc)
 	DebugMan.addDebugChannel(kWintermuteDebugGeneral, "general", "various issues not covered by any of the above");
 
 	_game = NULL;
+	_console = NULL;
 }
 
 WintermuteEngine::~WintermuteEngine() {
@@ -97,6 +100,10 @@ bool WintermuteEngine::hasFeature(EngineFeature f) const {
 	return false;
 }
 
+GUI::Debugger *WintermuteEngine::getDebugger() {
+	return _console;
+}
+
 Common::Error WintermuteEngine::run() {
 	// Initialize graphics using following:
 	Graphics::PixelFormat format(4, 8, 8, 8, 8, 16, 8, 0, 24);
@@ -234,8 +241,14 @@ int WintermuteEngine::messageLoop() {
 	while (!done) {
 		Common::Event event;
 		while (_system->getEventManager()->pollEvent(event)) {
+			// CTRL-D: Attach the debugger
+			if (event.type == Common::EVENT_KEYDOWN && event.kbd.hasFlags(Common::KBD_CTRL) && event.kbd.keycode == Common::KEYCODE_d) {
+				_console->attach();
+				continue;
+			}
 			BasePlatform::handleEvent(&event);
 		}
+		_console->onFrame();
 
 		if (_game && _game->_renderer->_active && _game->_renderer->_ready) {
 			_game->displayContent();
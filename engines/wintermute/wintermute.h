@@ -25,7 +25,6 @@
 
 #include "engines/engine.h"
 #include "engines/advancedDetector.h"
-#include "gui/debugger.h"
 
 namespace Wintermute {
 
@@ -50,6 +49,7 @@ public:
 
 	virtual Common::Error run();
 	virtual bool hasFeature(EngineFeature f) const;
+	virtual GUI::Debugger *getDebugger();
 	Common::SaveFileManager *getSaveFileMan() { return _saveFileMan; }
 	virtual Common::Error loadGameState(int slot);
 	virtual bool canLoadGameStateCurrently();
@@ -66,13 +66,6 @@ private:
 	const ADGameDescription *_gameDescription;
 };
 
-// Example console class
-class Console : public GUI::Debugger {
-public:
-	Console(WintermuteEngine *vm) {}
-	virtual ~Console(void) {}
-};
-
 } // End of namespace Wintermute
 
 #endif
@@ -28,6 +28,7 @@
 #include "common/endian.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
+#include "common/util.h"
 
 namespace Graphics {
 
@@ -45,7 +46,8 @@ static const uint8 _zigZagOrder[64] = {
 
 JPEGDecoder::JPEGDecoder() : ImageDecoder(),
 	_stream(NULL), _w(0), _h(0), _numComp(0), _components(NULL), _numScanComp(0),
-	_scanComp(NULL), _currentComp(NULL), _rgbSurface(0) {
+	_scanComp(NULL), _currentComp(NULL), _rgbSurface(0), _colorSpace(kColorSpaceRGB),
+	_outputFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), _idct(getJPEGIDCTFunc()) {
 
 	// Initialize the quantization tables
 	for (int i = 0; i < JPEG_MAX_QUANT_TABLES; i++)
@@ -57,6 +59,7 @@ JPEGDecoder::JPEGDecoder() : ImageDecoder(),
 		_huff[i].values = NULL;
 		_huff[i].sizes = NULL;
 		_huff[i].codes = NULL;
+		buildHuffLookup(i);
 	}
 }
 
@@ -69,12 +72,13 @@ const Surface *JPEGDecoder::getSurface() const {
 	if (!isLoaded())
 		return 0;
 
+	// Images decoded to RGB are converted while decoding them
 	if (_rgbSurface)
 		return _rgbSurface;
 
-	// Create an RGBA8888 surface
+	// Create the RGB surface
 	_rgbSurface = new Graphics::Surface();
-	_rgbSurface->create(_w, _h, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+	_rgbSurface->create(_w, _h, _outputFormat);
 
 	// Get our component surfaces
 	const Graphics::Surface *yComponent = getComponent(1);
@@ -86,6 +90,11 @@ const Surface *JPEGDecoder::getSurface() const {
 	return _rgbSurface;
 }
 
+void JPEGDecoder::setOutputPixelFormat(const PixelFormat &format) {
+	assert(format.bytesPerPixel == 2 || format.bytesPerPixel == 4);
+	_outputFormat = format;
+}
+
 void JPEGDecoder::destroy() {
 	// Reset member variables
 	_stream = NULL;
@@ -115,11 +124,13 @@ void JPEGDecoder::destroy() {
 		delete[] _huff[i].values; _huff[i].values = NULL;
 		delete[] _huff[i].sizes; _huff[i].sizes = NULL;
 		delete[] _huff[i].codes; _huff[i].codes = NULL;
+		buildHuffLookup(i);
 	}
 
 	if (_rgbSurface) {
 		_rgbSurface->free();
 		delete _rgbSurface;
+		_rgbSurface = 0;
 	}
 }
 
@@ -336,6 +347,8 @@ bool JPEGDecoder::readDHT() {
 			curCode++;
 			cur++;
 		}
+
+		buildHuffLookup(tableNum);
 	}
 
 	return true;
@@ -418,7 +431,7 @@ bool JPEGDecoder::readSOS() {
 	}
 
 	// Entropy coded sequence starts, initialize Huffman decoder
-	_bitsNumber = 0;
+	initBits();
 
 	// Read all the scan MCUs
 	uint16 xMCU = _w / (_maxFactorH * 8);
@@ -430,9 +443,27 @@ bool JPEGDecoder::readSOS() {
 	if (_h % (_maxFactorV * 8) != 0)
 		yMCU++;
 
+	// When the scan holds all of a YCbCr image, each row of MCUs is
+	// converted to RGB right after decoding it, so that the components
+	// only need to hold one row of MCUs. Otherwise the components are
+	// kept, and converted by getSurface().
+	Component *yuvComp[3] = { 0, 0, 0 };
+	for (int c = 0; c < _numComp; c++) {
+		if (_components[c].id >= 1 && _components[c].id <= 3)
+			yuvComp[_components[c].id - 1] = &_components[c];
+	}
+
+	const bool convertRows = _colorSpace == kColorSpaceRGB && !_rgbSurface && _numComp == 3 &&
+	                         _numScanComp == 3 && yuvComp[0] && yuvComp[1] && yuvComp[2];
+
+	if (convertRows) {
+		_rgbSurface = new Graphics::Surface();
+		_rgbSurface->create(_w, _h, _outputFormat);
+	}
+
 	// Initialize the scan surfaces
 	for (uint16 c = 0; c < _numScanComp; c++) {
-		_scanComp[c]->surface.create(xMCU * _maxFactorH * 8, yMCU * _maxFactorV * 8, PixelFormat::createFormatCLUT8());
+		_scanComp[c]->surface.create(xMCU * _maxFactorH * 8, (convertRows ? 1 : yMCU) * _maxFactorV * 8, PixelFormat::createFormatCLUT8());
 	}
 
 	bool ok = true;
@@ -440,7 +471,7 @@ bool JPEGDecoder::readSOS() {
 
 	for (int y = 0; ok && (y < yMCU); y++) {
 		for (int x = 0; ok && (x < xMCU); x++) {
-			ok = readMCU(x, y);
+			ok = readMCU(x, convertRows ? 0 : y);
 
 			// If we have a restart interval, we'll need to reset a couple
 			// variables
@@ -449,20 +480,45 @@ bool JPEGDecoder::readSOS() {
 
 				if (interval == 0) {
 					interval = _restartInterval;
-					_bitsNumber = 0;
+					restartBits();
 
 					for (byte i = 0; i < _numScanComp; i++)
 						_scanComp[i]->DCpredictor = 0;
 				}
 			}
 		}
+
+		if (convertRows) {
+			// Convert this row of MCUs straight into the RGB surface
+			const uint16 top = y * _maxFactorV * 8;
+
+			Graphics::Surface rows;
+			rows.w = _w;
+			rows.h = MIN<int>(_maxFactorV * 8, _h - top);
+			rows.pitch = _rgbSurface->pitch;
+			rows.pixels = _rgbSurface->getBasePtr(0, top);
+			rows.format = _rgbSurface->format;
+
+			YUVToRGBMan.convert444(&rows, Graphics::YUVToRGBManager::kScaleFull,
+			                       (const byte *)yuvComp[0]->surface.pixels, (const byte *)yuvComp[1]->surface.pixels,
+			                       (const byte *)yuvComp[2]->surface.pixels, rows.w, rows.h,
+			                       yuvComp[0]->surface.pitch, yuvComp[1]->surface.pitch);
+		}
 	}
 
-	// Trim Component surfaces back to image height and width
-	// Note: Code using jpeg must use surface.pitch correctly...
-	for (uint16 c = 0; c < _numScanComp; c++) {
-		_scanComp[c]->surface.w = _w;
-		_scanComp[c]->surface.h = _h;
+	// Continue with the marker after the entropy coded data
+	finishBits();
+
+	if (convertRows) {
+		for (uint16 c = 0; c < _numScanComp; c++)
+			_scanComp[c]->surface.free();
+	} else {
+		// Trim Component surfaces back to image height and width
+		// Note: Code using jpeg must use surface.pitch correctly...
+		for (uint16 c = 0; c < _numScanComp; c++) {
+			_scanComp[c]->surface.w = _w;
+			_scanComp[c]->surface.h = _h;
+		}
 	}
 
 	return ok;
@@ -528,102 +584,27 @@ bool JPEGDecoder::readMCU(uint16 xMCU, uint16 yMCU) {
 	return ok;
 }
 
-// triple-butterfly-add (and possible rounding)
-#define xadd3(xa, xb, xc, xd, h) \
-	p = xa + xb; \
-	n = xa - xb; \
-	xa = p + xc + h; \
-	xb = n + xd + h; \
-	xc = p - xc + h; \
-	xd = n - xd + h;
-
-// butterfly-mul
-#define xmul(xa, xb, k1, k2, sh) \
-	n = k1 * (xa + xb); \
-	p = xa; \
-	xa = (n + (k2 - k1) * xb) >> sh; \
-	xb = (n - (k2 + k1) * p) >> sh;
-
-// IDCT based on public domain code from http://halicery.com/jpeg/idct.html
-void JPEGDecoder::idct1D8x8(int32 src[8], int32 dest[64], int32 ps, int32 half) {
-	int p, n;
-
-	src[0] <<= 9;
-	src[1] <<= 7;
-	src[3] *= 181;
-	src[4] <<= 9;
-	src[5] *= 181;
-	src[7] <<= 7;
-
-	// Even part
-	xmul(src[6], src[2], 277, 669, 0)
-	xadd3(src[0], src[4], src[6], src[2], half)
-
-	// Odd part
-	xadd3(src[1], src[7], src[3], src[5], 0)
-	xmul(src[5], src[3], 251, 50, 6)
-	xmul(src[1], src[7], 213, 142, 6)
-
-	dest[0 * 8] = (src[0] + src[1]) >> ps;
-	dest[1 * 8] = (src[4] + src[5]) >> ps;
-	dest[2 * 8] = (src[2] + src[3]) >> ps;
-	dest[3 * 8] = (src[6] + src[7]) >> ps;
-	dest[4 * 8] = (src[6] - src[7]) >> ps;
-	dest[5 * 8] = (src[2] - src[3]) >> ps;
-	dest[6 * 8] = (src[4] - src[5]) >> ps;
-	dest[7 * 8] = (src[0] - src[1]) >> ps;
-}
-
-void JPEGDecoder::idct2D8x8(int32 block[64]) {
-	int32 tmp[64];
-
-	// Apply 1D IDCT to rows
-	for (int i = 0; i < 8; i++)
-		idct1D8x8(&block[i * 8], &tmp[i], 9, 1 << 8);
-
-	// Apply 1D IDCT to columns
-	for (int i = 0; i < 8; i++)
-		idct1D8x8(&tmp[i * 8], &block[i], 12, 1 << 11);
- }
-
 bool JPEGDecoder::readDataUnit(uint16 x, uint16 y) {
-	// Prepare an empty data array
-	int16 readData[64];
-	for (int i = 1; i < 64; i++)
-		readData[i] = 0;
-
-	// Read the DC component
-	readData[0] = _currentComp->DCpredictor + readDC();
-	_currentComp->DCpredictor = readData[0];
+	const uint16 *quant = _quant[_currentComp->quantTableSelector];
 
-	// Read the AC components (stored in Zig-Zag)
-	readAC(readData);
-
-	// Calculate the DCT coefficients from the input sequence
+	// Prepare an empty block
 	int32 block[64];
-	for (uint8 i = 0; i < 64; i++) {
-		// Dequantize
-		int32 val = readData[i];
-		int16 quant = _quant[_currentComp->quantTableSelector][i];
-		val *= quant;
+	memset(block, 0, sizeof(block));
 
-		// Store the normalized coefficients, undoing the Zig-Zag
-		block[_zigZagOrder[i]] = val;
-	}
+	// Read and dequantize the DC component
+	_currentComp->DCpredictor += readDC();
+	block[0] = _currentComp->DCpredictor * (int16)quant[0];
+
+	// Read and dequantize the AC components
+	readAC(block, quant);
 
 	// Apply the IDCT
-	idct2D8x8(block);
+	_idct(block);
 
 	// Level shift to make the values unsigned
-	for (int i = 0; i < 64; i++) {
-		block[i] = block[i] + 128;
-
-		if (block[i] < 0)
-			block[i] = 0;
-
-		if (block[i] > 255)
-			block[i] = 255;
-	}
+	byte pixels[64];
+	for (int i = 0; i < 64; i++)
+		pixels[i] = CLIP<int32>(block[i] + 128, 0, 255);
 
 	// Paint the component surface
 	uint8 scalingV = _maxFactorV / _currentComp->factorV;
@@ -638,9 +619,14 @@ bool JPEGDecoder::readDataUnit(uint16 x, uint16 y) {
 			// Get the beginning of the block line
 			byte *ptr = (byte *)_currentComp->surface.getBasePtr(x * scalingH, (y + j) * scalingV + sV);
 
+			if (scalingH == 1) {
+				memcpy(ptr, pixels + j * 8, 8);
+				continue;
+			}
+
 			for (uint8 i = 0; i < 8; i++) {
 				for (uint16 sH = 0; sH < scalingH; sH++) {
-					*ptr = (byte)(block[j * 8 + i]);
+					*ptr = pixels[j * 8 + i];
 					ptr++;
 				}
 			}
@@ -661,7 +647,7 @@ int16 JPEGDecoder::readDC() {
 	return readSignedBits(numBits);
 }
 
-void JPEGDecoder::readAC(int16 *out) {
+void JPEGDecoder::readAC(int32 *block, const uint16 *quant) {
 	// AC is type 1
 	uint8 tableNum = (_currentComp->ACentropyTableSelector << 1) + 1;
 
@@ -683,22 +669,26 @@ void JPEGDecoder::readAC(int16 *out) {
 		} else {
 			// Skip r values
 			cur += r;
+			if (cur >= 64)
+				break;
 
-			// Read the next value
-			out[cur] = readSignedBits(s);
+			// Read the next value, and store the dequantized
+			// coefficient, undoing the Zig-Zag
+			block[_zigZagOrder[cur]] = readSignedBits(s) * (int16)quant[cur];
 			cur++;
 		}
 	}
 }
 
 int16 JPEGDecoder::readSignedBits(uint8 numBits) {
-	uint16 ret = 0;
+	if (numBits == 0)
+		return 0;
 	if (numBits > 16)
 		error("requested %d bits", numBits); //XXX
 
 	// MSB=0 for negatives, 1 for positives
-	for (int i = 0; i < numBits; i++)
-		ret = (ret << 1) + readBit();
+	uint16 ret = peekBits(numBits);
+	skipBits(numBits);
 
 	// Extend sign bits (PAG109)
 	if (!(ret >> (numBits - 1))) {
@@ -708,71 +698,165 @@ int16 JPEGDecoder::readSignedBits(uint8 numBits) {
 	return ret;
 }
 
-// TODO: optimize?
-uint8 JPEGDecoder::readHuff(uint8 table) {
-	bool foundCode = false;
-	uint8 val = 0;
-
-	uint8 cur = 0;
-	uint8 codeSize = 1;
-	uint16 code = readBit();
-	while (!foundCode) {
-		// Prepare a code of the current size
-		while (codeSize < _huff[table].sizes[cur]) {
-			code = (code << 1) + readBit();
-			codeSize++;
+void JPEGDecoder::buildHuffLookup(uint8 table) {
+	HuffmanTable &huff = _huff[table];
+
+	memset(huff.lookup, 0, sizeof(huff.lookup));
+	for (int len = 0; len <= 16; len++) {
+		huff.maxCode[len] = -1;
+		huff.valOffset[len] = 0;
+	}
+
+	// The codes are sorted by length, and ascending within each length
+	for (int i = 0; i < huff.count; i++) {
+		const uint8 len = huff.sizes[i];
+		const uint16 code = huff.codes[i];
+
+		if (code >= (1 << len)) {
+			warning("JPEG: Invalid Huffman table");
+			return;
 		}
 
-		// Compare the codes of the current size
-		while (!foundCode && (codeSize == _huff[table].sizes[cur])) {
-			if (code == _huff[table].codes[cur]) {
-				// Found the code
-				val = _huff[table].values[cur];
-				foundCode = true;
-			} else {
-				// Continue reading
-				cur++;
-			}
+		if (huff.maxCode[len] < 0)
+			huff.valOffset[len] = i - code;
+		huff.maxCode[len] = code;
+
+		// Short codes fill all lookup entries starting with them
+		if (len <= JPEG_HUFF_LOOKUP_BITS) {
+			const uint8 fill = JPEG_HUFF_LOOKUP_BITS - len;
+			for (uint32 j = 0; j < (1u << fill); j++)
+				huff.lookup[(code << fill) | j] = (len << 8) | huff.values[i];
 		}
 	}
+}
 
-	return val;
+uint8 JPEGDecoder::readHuff(uint8 table) {
+	const HuffmanTable &huff = _huff[table];
+
+	// Look up the short codes
+	const uint16 entry = huff.lookup[peekBits(JPEG_HUFF_LOOKUP_BITS)];
+	if (entry) {
+		skipBits(entry >> 8);
+		return entry & 0xFF;
+	}
+
+	// Compare the longer codes with the largest code of each length
+	const uint32 bits = peekBits(16);
+	for (uint8 len = JPEG_HUFF_LOOKUP_BITS + 1; len <= 16; len++) {
+		const int32 code = bits >> (16 - len);
+		if (code <= huff.maxCode[len]) {
+			skipBits(len);
+			return huff.values[code + huff.valOffset[len]];
+		}
+	}
+
+	warning("JPEG: Invalid Huffman code");
+	skipBits(16);
+	return 0;
+}
+
+void JPEGDecoder::initBits() {
+	_bufferPos = _bufferEnd = 0;
+	_bufferStreamPos = _stream->pos();
+	_bitBuffer = 0;
+	_bitsNumber = 0;
+	_entropyEnd = false;
+	_markerPos = -1;
 }
 
-uint8 JPEGDecoder::readBit() {
-	// Read a whole byte if necessary
-	if (_bitsNumber == 0) {
-		_bitsData = _stream->readByte();
-		_bitsNumber = 8;
+bool JPEGDecoder::readEntropyByte(uint8 &data) {
+	if (_bufferPos == _bufferEnd) {
+		_bufferStreamPos = _stream->pos();
+		_bufferEnd = _stream->read(_buffer, JPEG_BUFFER_SIZE);
+		_bufferPos = 0;
+
+		if (_bufferEnd == 0)
+			return false;
+	}
+
+	data = _buffer[_bufferPos++];
+	return true;
+}
+
+void JPEGDecoder::fillBits() {
+	while (_bitsNumber <= 24 && !_entropyEnd) {
+		uint8 data;
+		if (!readEntropyByte(data)) {
+			_entropyEnd = true;
+			break;
+		}
 
 		// Detect markers
-		if (_bitsData == 0xFF) {
-			uint8 byte2 = _stream->readByte();
+		if (data == 0xFF) {
+			const int32 markerPos = _bufferStreamPos + _bufferPos - 1;
 
-			// A stuffed 0 validates the previous byte
+			uint8 byte2;
+			if (!readEntropyByte(byte2)) {
+				_entropyEnd = true;
+				break;
+			}
+
+			if (byte2 >= 0xD0 && byte2 <= 0xD7) {
+				// The bits of the interval are realigned by restartBits()
+				debug(7, "RST%d marker detected", byte2 & 7);
+				continue;
+			}
+
+			// A stuffed 0 validates the previous byte, any other
+			// marker ends the entropy coded data
 			if (byte2 != 0) {
-				if (byte2 == 0xDC) {
-					// DNL marker: Define Number of Lines
-					// TODO: terminate scan
-					warning("DNL marker detected: terminate scan");
-				} else if (byte2 >= 0xD0 && byte2 <= 0xD7) {
-					debug(7, "RST%d marker detected", byte2 & 7);
-					_bitsData = _stream->readByte();
-				} else {
-					warning("Error: marker 0x%02X read in entropy data", byte2);
-				}
+				_entropyEnd = true;
+				_markerPos = markerPos;
+				break;
 			}
 		}
+
+		_bitBuffer |= (uint32)data << (24 - _bitsNumber);
+		_bitsNumber += 8;
 	}
-	_bitsNumber--;
+}
+
+uint32 JPEGDecoder::peekBits(uint8 numBits) {
+	// Past the end of the entropy coded data, 0 bits are read
+	if (_bitsNumber < numBits)
+		fillBits();
+
+	return _bitBuffer >> (32 - numBits);
+}
 
-	return (_bitsData & (1 << _bitsNumber)) ? 1 : 0;
+void JPEGDecoder::skipBits(uint8 numBits) {
+	_bitBuffer <<= numBits;
+	_bitsNumber = (_bitsNumber > numBits) ? _bitsNumber - numBits : 0;
+}
+
+void JPEGDecoder::restartBits() {
+	// Drop the rest of the current byte
+	skipBits(_bitsNumber & 7);
+}
+
+void JPEGDecoder::finishBits() {
+	// Skip the bits left, up to the next marker
+	while (!_entropyEnd) {
+		_bitBuffer = 0;
+		_bitsNumber = 0;
+		fillBits();
+	}
+
+	if (_markerPos >= 0)
+		_stream->seek(_markerPos);
+	else
+		_stream->seek(0, SEEK_END);
 }
 
 const Surface *JPEGDecoder::getComponent(uint c) const {
-	for (int i = 0; i < _numComp; i++)
-		if (_components[i].id == c) // We found the desired component
+	for (int i = 0; i < _numComp; i++) {
+		if (_components[i].id == c) { // We found the desired component
+			if (!_components[i].surface.pixels)
+				error("JPEGDecoder::getComponent: Component %d was not kept", c);
+
 			return &_components[i].surface;
+		}
+	}
 
 	error("JPEGDecoder::getComponent: No component %d present", c);
 	return NULL;
@@ -31,8 +31,10 @@
 #ifndef GRAPHICS_JPEG_H
 #define GRAPHICS_JPEG_H
 
+#include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 #include "graphics/decoders/image_decoder.h"
+#include "graphics/decoders/jpeg_idct.h"
 
 namespace Common {
 class SeekableReadStream;
@@ -40,11 +42,15 @@ class SeekableReadStream;
 
 namespace Graphics {
 
-struct PixelFormat;
-
 #define JPEG_MAX_QUANT_TABLES 4
 #define JPEG_MAX_HUFF_TABLES 2
 
+// Huffman codes of up to this many bits are decoded with a single table lookup
+#define JPEG_HUFF_LOOKUP_BITS 9
+
+// Size of the buffer the entropy coded data is read into
+#define JPEG_BUFFER_SIZE 4096
+
 class JPEGDecoder : public ImageDecoder {
 public:
 	JPEGDecoder();
@@ -58,6 +64,30 @@ public:
 	bool isLoaded() const { return _numComp && _w && _h; }
 	uint16 getWidth() const { return _w; }
 	uint16 getHeight() const { return _h; }
+
+	enum ColorSpace {
+		kColorSpaceRGB, ///< Convert the image to RGB while decoding it
+		kColorSpaceYUV  ///< Keep the Y, Cb and Cr components, see getComponent()
+	};
+
+	/**
+	 * Set the color space the next images are decoded to. It defaults
+	 * to RGB, in which case the components are only kept while each row
+	 * of MCUs is converted.
+	 */
+	void setOutputColorSpace(ColorSpace colorSpace) { _colorSpace = colorSpace; }
+
+	/**
+	 * Set the pixel format of the surface returned by getSurface() for
+	 * the next images. It must have 2 or 4 bytes per pixel, and defaults
+	 * to RGBA8888.
+	 */
+	void setOutputPixelFormat(const PixelFormat &format);
+
+	/**
+	 * Return the surface of a component (1 for Y, 2 for Cb, 3 for Cr).
+	 * Only available when decoding to the YUV color space.
+	 */
 	const Surface *getComponent(uint c) const;
 
 private:
@@ -65,6 +95,9 @@ private:
 	uint16 _w, _h;
 	uint16 _restartInterval;
 
+	ColorSpace _colorSpace;
+	PixelFormat _outputFormat;
+
 	// mutable so that we can convert to RGB only during
 	// a getSurface() call while still upholding the
 	// const requirement in other ImageDecoders
@@ -108,6 +141,16 @@ private:
 		uint8 *values;
 		uint8 *sizes;
 		uint16 *codes;
+
+		// (length << 8) | value of the codes of up to JPEG_HUFF_LOOKUP_BITS
+		// bits, indexed by the next JPEG_HUFF_LOOKUP_BITS bits, 0 for
+		// longer codes
+		uint16 lookup[1 << JPEG_HUFF_LOOKUP_BITS];
+
+		// Largest code of each length (-1 if none), and the offset from
+		// the codes of that length to the index of their values
+		int32 maxCode[17];
+		int32 valOffset[17];
 	} _huff[2 * JPEG_MAX_HUFF_TABLES];
 
 	// Marker read functions
@@ -122,18 +165,34 @@ private:
 	bool readMCU(uint16 xMCU, uint16 yMCU);
 	bool readDataUnit(uint16 x, uint16 y);
 	int16 readDC();
-	void readAC(int16 *out);
+	void readAC(int32 *block, const uint16 *quant);
 	int16 readSignedBits(uint8 numBits);
 
 	// Huffman decoding
+	void buildHuffLookup(uint8 table);
 	uint8 readHuff(uint8 table);
-	uint8 readBit();
-	uint8 _bitsData;
+
+	// Entropy coded data reading. The data is read ahead into _buffer,
+	// and the unstuffed bits are cached MSB first in _bitBuffer.
+	void initBits();
+	bool readEntropyByte(uint8 &data);
+	void fillBits();
+	uint32 peekBits(uint8 numBits);
+	void skipBits(uint8 numBits);
+	void restartBits();
+	void finishBits();
+
+	byte _buffer[JPEG_BUFFER_SIZE];
+	uint32 _bufferPos;
+	uint32 _bufferEnd;
+	int32 _bufferStreamPos; // Position of _buffer in the stream
+	uint32 _bitBuffer;
 	uint8 _bitsNumber;
+	bool _entropyEnd;       // A marker or the end of the stream was reached
+	int32 _markerPos;       // Position of that marker, or -1
 
 	// Inverse Discrete Cosine Transformation
-	static void idct1D8x8(int32 src[8], int32 dest[64], int32 ps, int32 half);
-	static void idct2D8x8(int32 block[64]);
+	JPEGIDCTFunc _idct;
 };
 
 } // End of Graphics namespace
@@ -0,0 +1,339 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/*
+ * IDCT kernels used by JPEGDecoder.
+ *
+ * The scalar kernel is the reference implementation. The SSE2 and NEON
+ * kernels run the same integer arithmetic on four rows (or columns) at a
+ * time, so they produce bit-identical output.
+ *
+ * SSE2 kernels are built with a function level target attribute on GCC, so
+ * 32 bit x86 builds pick them at runtime only on CPUs supporting SSE2.
+ */
+
+#include "graphics/decoders/jpeg_idct.h"
+
+#include "common/simd.h"
+
+#if defined(SCUMMVM_SIMD_SSE2)
+#define JPEG_SIMD_SSE2
+#elif defined(SCUMMVM_SIMD_NEON)
+#define JPEG_SIMD_NEON
+#endif
+
+namespace Graphics {
+
+static bool s_simdEnabled = true;
+
+#pragma mark -
+#pragma mark --- Scalar kernel ---
+#pragma mark -
+
+// triple-butterfly-add (and possible rounding)
+#define xadd3(xa, xb, xc, xd, h) \
+	p = xa + xb; \
+	n = xa - xb; \
+	xa = p + xc + h; \
+	xb = n + xd + h; \
+	xc = p - xc + h; \
+	xd = n - xd + h;
+
+// butterfly-mul
+#define xmul(xa, xb, k1, k2, sh) \
+	n = k1 * (xa + xb); \
+	p = xa; \
+	xa = (n + (k2 - k1) * xb) >> sh; \
+	xb = (n - (k2 + k1) * p) >> sh;
+
+// IDCT based on public domain code from http://halicery.com/jpeg/idct.html
+static void idct1D8x8(int32 src[8], int32 dest[64], int32 ps, int32 half) {
+	int p, n;
+
+	src[0] <<= 9;
+	src[1] <<= 7;
+	src[3] *= 181;
+	src[4] <<= 9;
+	src[5] *= 181;
+	src[7] <<= 7;
+
+	// Even part
+	xmul(src[6], src[2], 277, 669, 0)
+	xadd3(src[0], src[4], src[6], src[2], half)
+
+	// Odd part
+	xadd3(src[1], src[7], src[3], src[5], 0)
+	xmul(src[5], src[3], 251, 50, 6)
+	xmul(src[1], src[7], 213, 142, 6)
+
+	dest[0 * 8] = (src[0] + src[1]) >> ps;
+	dest[1 * 8] = (src[4] + src[5]) >> ps;
+	dest[2 * 8] = (src[2] + src[3]) >> ps;
+	dest[3 * 8] = (src[6] + src[7]) >> ps;
+	dest[4 * 8] = (src[6] - src[7]) >> ps;
+	dest[5 * 8] = (src[2] - src[3]) >> ps;
+	dest[6 * 8] = (src[4] - src[5]) >> ps;
+	dest[7 * 8] = (src[0] - src[1]) >> ps;
+}
+
+#undef xadd3
+#undef xmul
+
+static void idct2D8x8Scalar(int32 block[64]) {
+	int32 tmp[64];
+
+	// Apply 1D IDCT to rows
+	for (int i = 0; i < 8; i++)
+		idct1D8x8(&block[i * 8], &tmp[i], 9, 1 << 8);
+
+	// Apply 1D IDCT to columns
+	for (int i = 0; i < 8; i++)
+		idct1D8x8(&tmp[i * 8], &block[i], 12, 1 << 11);
+}
+
+/*
+ * The vector kernels below apply idct1D8x8() to four rows of the source at
+ * once: each vector holds the same coefficient of four rows, which takes a
+ * transposition on load. The results of the four rows then are contiguous
+ * in the destination, which is transposed just like in the scalar kernel.
+ */
+
+#ifdef JPEG_SIMD_SSE2
+
+#pragma mark -
+#pragma mark --- SSE2 kernel ---
+#pragma mark -
+
+/** Multiplies the 32 bit lanes by a constant, keeping the low 32 bits of the products. */
+SCUMMVM_SSE2_TARGET
+static inline __m128i mulSSE2(__m128i a, int32 k) {
+	const __m128i kv = _mm_set1_epi32(k);
+	const __m128i even = _mm_mul_epu32(a, kv);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), kv);
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/** Loads four times four coefficients and transposes them. */
+SCUMMVM_SSE2_TARGET
+static inline void loadTransposedSSE2(const int32 *src, __m128i out[4]) {
+	const __m128i r0 = _mm_loadu_si128((const __m128i *)(src + 0 * 8));
+	const __m128i r1 = _mm_loadu_si128((const __m128i *)(src + 1 * 8));
+	const __m128i r2 = _mm_loadu_si128((const __m128i *)(src + 2 * 8));
+	const __m128i r3 = _mm_loadu_si128((const __m128i *)(src + 3 * 8));
+
+	const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+	const __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+	const __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+	const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+	out[0] = _mm_unpacklo_epi64(t0, t1);
+	out[1] = _mm_unpackhi_epi64(t0, t1);
+	out[2] = _mm_unpacklo_epi64(t2, t3);
+	out[3] = _mm_unpackhi_epi64(t2, t3);
+}
+
+SCUMMVM_SSE2_TARGET
+static inline void idctPassSSE2(const int32 *src, int32 *dest, int ps, int32 half) {
+	const __m128i shift = _mm_cvtsi32_si128(ps);
+	const __m128i h = _mm_set1_epi32(half);
+
+	for (int r = 0; r < 8; r += 4) {
+		__m128i s[8];
+		loadTransposedSSE2(src + r * 8, s);
+		loadTransposedSSE2(src + r * 8 + 4, s + 4);
+
+		s[0] = _mm_slli_epi32(s[0], 9);
+		s[1] = _mm_slli_epi32(s[1], 7);
+		s[3] = mulSSE2(s[3], 181);
+		s[4] = _mm_slli_epi32(s[4], 9);
+		s[5] = mulSSE2(s[5], 181);
+		s[7] = _mm_slli_epi32(s[7], 7);
+
+		// Even part
+		__m128i n = mulSSE2(_mm_add_epi32(s[6], s[2]), 277);
+		__m128i p = s[6];
+		s[6] = _mm_add_epi32(n, mulSSE2(s[2], 669 - 277));
+		s[2] = _mm_sub_epi32(n, mulSSE2(p, 669 + 277));
+
+		p = _mm_add_epi32(s[0], s[4]);
+		n = _mm_sub_epi32(s[0], s[4]);
+		s[0] = _mm_add_epi32(_mm_add_epi32(p, s[6]), h);
+		s[4] = _mm_add_epi32(_mm_add_epi32(n, s[2]), h);
+		s[6] = _mm_add_epi32(_mm_sub_epi32(p, s[6]), h);
+		s[2] = _mm_add_epi32(_mm_sub_epi32(n, s[2]), h);
+
+		// Odd part
+		p = _mm_add_epi32(s[1], s[7]);
+		n = _mm_sub_epi32(s[1], s[7]);
+		s[1] = _mm_add_epi32(p, s[3]);
+		s[7] = _mm_add_epi32(n, s[5]);
+		s[3] = _mm_sub_epi32(p, s[3]);
+		s[5] = _mm_sub_epi32(n, s[5]);
+
+		n = mulSSE2(_mm_add_epi32(s[5], s[3]), 251);
+		p = s[5];
+		s[5] = _mm_srai_epi32(_mm_add_epi32(n, mulSSE2(s[3], 50 - 251)), 6);
+		s[3] = _mm_srai_epi32(_mm_sub_epi32(n, mulSSE2(p, 50 + 251)), 6);
+
+		n = mulSSE2(_mm_add_epi32(s[1], s[7]), 213);
+		p = s[1];
+		s[1] = _mm_srai_epi32(_mm_add_epi32(n, mulSSE2(s[7], 142 - 213)), 6);
+		s[7] = _mm_srai_epi32(_mm_sub_epi32(n, mulSSE2(p, 142 + 213)), 6);
+
+		_mm_storeu_si128((__m128i *)(dest + 0 * 8 + r), _mm_sra_epi32(_mm_add_epi32(s[0], s[1]), shift));
+		_mm_storeu_si128((__m128i *)(dest + 1 * 8 + r), _mm_sra_epi32(_mm_add_epi32(s[4], s[5]), shift));
+		_mm_storeu_si128((__m128i *)(dest + 2 * 8 + r), _mm_sra_epi32(_mm_add_epi32(s[2], s[3]), shift));
+		_mm_storeu_si128((__m128i *)(dest + 3 * 8 + r), _mm_sra_epi32(_mm_add_epi32(s[6], s[7]), shift));
+		_mm_storeu_si128((__m128i *)(dest + 4 * 8 + r), _mm_sra_epi32(_mm_sub_epi32(s[6], s[7]), shift));
+		_mm_storeu_si128((__m128i *)(dest + 5 * 8 + r), _mm_sra_epi32(_mm_sub_epi32(s[2], s[3]), shift));
+		_mm_storeu_si128((__m128i *)(dest + 6 * 8 + r), _mm_sra_epi32(_mm_sub_epi32(s[4], s[5]), shift));
+		_mm_storeu_si128((__m128i *)(dest + 7 * 8 + r), _mm_sra_epi32(_mm_sub_epi32(s[0], s[1]), shift));
+	}
+}
+
+SCUMMVM_SSE2_TARGET
+static void idct2D8x8SSE2(int32 block[64]) {
+	int32 tmp[64];
+
+	// Apply 1D IDCT to rows, then to columns
+	idctPassSSE2(block, tmp, 9, 1 << 8);
+	idctPassSSE2(tmp, block, 12, 1 << 11);
+}
+
+#endif // JPEG_SIMD_SSE2
+
+#ifdef JPEG_SIMD_NEON
+
+#pragma mark -
+#pragma mark --- NEON kernel ---
+#pragma mark -
+
+/** Loads four times four coefficients and transposes them. */
+static inline void loadTransposedNEON(const int32 *src, int32x4_t out[4]) {
+	const int32x4x2_t t0 = vtrnq_s32(vld1q_s32(src + 0 * 8), vld1q_s32(src + 1 * 8));
+	const int32x4x2_t t1 = vtrnq_s32(vld1q_s32(src + 2 * 8), vld1q_s32(src + 3 * 8));
+
+	out[0] = vcombine_s32(vget_low_s32(t0.val[0]), vget_low_s32(t1.val[0]));
+	out[1] = vcombine_s32(vget_low_s32(t0.val[1]), vget_low_s32(t1.val[1]));
+	out[2] = vcombine_s32(vget_high_s32(t0.val[0]), vget_high_s32(t1.val[0]));
+	out[3] = vcombine_s32(vget_high_s32(t0.val[1]), vget_high_s32(t1.val[1]));
+}
+
+static inline void idctPassNEON(const int32 *src, int32 *dest, int ps, int32 half) {
+	// Shifting left by a negative amount is an arithmetic shift right
+	const int32x4_t shift = vdupq_n_s32(-ps);
+	const int32x4_t h = vdupq_n_s32(half);
+
+	for (int r = 0; r < 8; r += 4) {
+		int32x4_t s[8];
+		loadTransposedNEON(src + r * 8, s);
+		loadTransposedNEON(src + r * 8 + 4, s + 4);
+
+		s[0] = vshlq_n_s32(s[0], 9);
+		s[1] = vshlq_n_s32(s[1], 7);
+		s[3] = vmulq_n_s32(s[3], 181);
+		s[4] = vshlq_n_s32(s[4], 9);
+		s[5] = vmulq_n_s32(s[5], 181);
+		s[7] = vshlq_n_s32(s[7], 7);
+
+		// Even part
+		int32x4_t n = vmulq_n_s32(vaddq_s32(s[6], s[2]), 277);
+		int32x4_t p = s[6];
+		s[6] = vaddq_s32(n, vmulq_n_s32(s[2], 669 - 277));
+		s[2] = vsubq_s32(n, vmulq_n_s32(p, 669 + 277));
+
+		p = vaddq_s32(s[0], s[4]);
+		n = vsubq_s32(s[0], s[4]);
+		s[0] = vaddq_s32(vaddq_s32(p, s[6]), h);
+		s[4] = vaddq_s32(vaddq_s32(n, s[2]), h);
+		s[6] = vaddq_s32(vsubq_s32(p, s[6]), h);
+		s[2] = vaddq_s32(vsubq_s32(n, s[2]), h);
+
+		// Odd part
+		p = vaddq_s32(s[1], s[7]);
+		n = vsubq_s32(s[1], s[7]);
+		s[1] = vaddq_s32(p, s[3]);
+		s[7] = vaddq_s32(n, s[5]);
+		s[3] = vsubq_s32(p, s[3]);
+		s[5] = vsubq_s32(n, s[5]);
+
+		n = vmulq_n_s32(vaddq_s32(s[5], s[3]), 251);
+		p = s[5];
+		s[5] = vshrq_n_s32(vaddq_s32(n, vmulq_n_s32(s[3], 50 - 251)), 6);
+		s[3] = vshrq_n_s32(vsubq_s32(n, vmulq_n_s32(p, 50 + 251)), 6);
+
+		n = vmulq_n_s32(vaddq_s32(s[1], s[7]), 213);
+		p = s[1];
+		s[1] = vshrq_n_s32(vaddq_s32(n, vmulq_n_s32(s[7], 142 - 213)), 6);
+		s[7] = vshrq_n_s32(vsubq_s32(n, vmulq_n_s32(p, 142 + 213)), 6);
+
+		vst1q_s32(dest + 0 * 8 + r, vshlq_s32(vaddq_s32(s[0], s[1]), shift));
+		vst1q_s32(dest + 1 * 8 + r, vshlq_s32(vaddq_s32(s[4], s[5]), shift));
+		vst1q_s32(dest + 2 * 8 + r, vshlq_s32(vaddq_s32(s[2], s[3]), shift));
+		vst1q_s32(dest + 3 * 8 + r, vshlq_s32(vaddq_s32(s[6], s[7]), shift));
+		vst1q_s32(dest + 4 * 8 + r, vshlq_s32(vsubq_s32(s[6], s[7]), shift));
+		vst1q_s32(dest + 5 * 8 + r, vshlq_s32(vsubq_s32(s[2], s[3]), shift));
+		vst1q_s32(dest + 6 * 8 + r, vshlq_s32(vsubq_s32(s[4], s[5]), shift));
+		vst1q_s32(dest + 7 * 8 + r, vshlq_s32(vsubq_s32(s[0], s[1]), shift));
+	}
+}
+
+static void idct2D8x8NEON(int32 block[64]) {
+	int32 tmp[64];
+
+	// Apply 1D IDCT to rows, then to columns
+	idctPassNEON(block, tmp, 9, 1 << 8);
+	idctPassNEON(tmp, block, 12, 1 << 11);
+}
+
+#endif // JPEG_SIMD_NEON
+
+#pragma mark -
+
+bool hasSIMDJPEGIDCT() {
+#if defined(JPEG_SIMD_SSE2)
+	static const bool sse2 = Common::hasSSE2();
+	return sse2;
+#elif defined(JPEG_SIMD_NEON)
+	return true;
+#else
+	return false;
+#endif
+}
+
+void enableSIMDJPEGIDCT(bool enable) {
+	s_simdEnabled = enable;
+}
+
+JPEGIDCTFunc getJPEGIDCTFunc() {
+	if (s_simdEnabled && hasSIMDJPEGIDCT()) {
+#if defined(JPEG_SIMD_SSE2)
+		return &idct2D8x8SSE2;
+#elif defined(JPEG_SIMD_NEON)
+		return &idct2D8x8NEON;
+#endif
+	}
+
+	return &idct2D8x8Scalar;
+}
+
+} // End of Graphics namespace
@@ -0,0 +1,52 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_JPEG_IDCT_H
+#define GRAPHICS_JPEG_IDCT_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * Applies the inverse DCT to a block of 8x8 dequantized coefficients, stored
+ * in natural (not zig-zag) order. The result replaces the coefficients and
+ * is not level shifted yet.
+ */
+typedef void (*JPEGIDCTFunc)(int32 block[64]);
+
+/**
+ * Return the IDCT kernel. The SSE2 or NEON kernel is picked when the CPU
+ * supports it and SIMD IDCT is enabled, otherwise the scalar reference
+ * kernel is returned. Both produce bit-identical output.
+ */
+JPEGIDCTFunc getJPEGIDCTFunc();
+
+/** Check whether an SSE2 or NEON IDCT kernel is available on this CPU. */
+bool hasSIMDJPEGIDCT();
+
+/** Enable or disable the SIMD IDCT kernels (they are enabled by default). */
+void enableSIMDJPEGIDCT(bool enable);
+
+} // End of Graphics namespace
+
+#endif // GRAPHICS_JPEG_IDCT_H
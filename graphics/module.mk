@@ -25,6 +25,7 @@ MODULE_OBJS := \
 	yuv_to_rgb.o \
 	decoders/bmp.o \
 	decoders/jpeg.o \
+	decoders/jpeg_idct.o \
 	decoders/pcx.o \
 	decoders/pict.o \
 	decoders/png.o \
@@ -20,6 +20,7 @@
  *
  */
 
+#include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
 #include "graphics/scaler/scalebit.h"
 #include "common/util.h"
@@ -387,3 +388,41 @@ void DotMatrix(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPi
 }
 
 #endif // #ifdef USE_SCALERS
+
+int splitScalerJob(const ScalerJob &job, int scaleFactor, int maxBands, int minBandHeight, ScalerJob *bands) {
+	assert(maxBands >= 1);
+
+	// Keep band heights even, see scaler.h
+	minBandHeight = MAX(minBandHeight, 2);
+	int numBands = MIN(maxBands, job.height / minBandHeight);
+	if (numBands <= 1) {
+		bands[0] = job;
+		return 1;
+	}
+
+	const int bandHeight = ((job.height + numBands - 1) / numBands + 1) & ~1;
+	int y = 0;
+	numBands = 0;
+	while (y < job.height) {
+		ScalerJob &band = bands[numBands++];
+		band = job;
+		band.srcPtr = job.srcPtr + y * job.srcPitch;
+		band.dstPtr = job.dstPtr + y * scaleFactor * job.dstPitch;
+		band.height = bandHeight;
+		// Some scalers (e.g. AdvMame) need at least two lines, so never
+		// leave a single line for the last band
+		if (job.height - y - bandHeight < 2)
+			band.height = job.height - y;
+		y += band.height;
+	}
+
+	return numBands;
+}
+
+bool isScalerReentrant(ScalerProc *proc) {
+#if defined(USE_HQ_SCALERS) && defined(USE_NASM)
+	if (proc == HQ2x || proc == HQ3x)
+		return false;
+#endif
+	return true;
+}
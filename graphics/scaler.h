@@ -61,6 +61,48 @@ DECLARE_SCALER(HQ3x);
 
 #endif // #ifdef USE_SCALERS
 
+/**
+ * A single invocation of a scaler: scale a width x height block starting
+ * at srcPtr into the block starting at dstPtr.
+ */
+struct ScalerJob {
+	ScalerProc *proc;
+	const uint8 *srcPtr;
+	uint32 srcPitch;
+	uint8 *dstPtr;
+	uint32 dstPitch;
+	int width, height;
+
+	void run() const { proc(srcPtr, srcPitch, dstPtr, dstPitch, width, height); }
+};
+
+/**
+ * Splits a scaler job into horizontal bands which can be processed
+ * independently, e.g. from several threads.
+ *
+ * Scalers read the lines above and below the block they scale straight from
+ * the source, which (as for any scaler call) must have a border of at least
+ * one pixel, so bands need no extra overlap and the combined output is
+ * identical to scaling the whole block at once. Band heights are kept even
+ * and at least two lines, since some scalers (e.g. DotMatrix) use patterns
+ * repeating every two source lines and others (AdvMame) need two lines.
+ *
+ * @param job           the job to split
+ * @param scaleFactor   the (integral) scale factor of the scaler
+ * @param maxBands      the maximum number of bands to create
+ * @param minBandHeight the minimal height (in source lines) of a band
+ * @param bands         array receiving at least maxBands bands
+ * @return the number of bands created (1 if the job was not split)
+ */
+extern int splitScalerJob(const ScalerJob &job, int scaleFactor, int maxBands, int minBandHeight, ScalerJob *bands);
+
+/**
+ * Returns whether the given scaler may be invoked from several threads at
+ * the same time. This is not the case for the assembler HQ scalers, which
+ * keep their temporaries in global variables.
+ */
+extern bool isScalerReentrant(ScalerProc *proc);
+
 // creates a 160x100 thumbnail for 320x200 games
 // and 160x120 thumbnail for 320x240 and 640x480 games
 // only 565 mode
@@ -0,0 +1,147 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/str.h"
+
+#include "helper.h"
+#include "../benchmark.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	/**
+	 * Runs a full sine stream through a rate converter, in chunks of
+	 * the given size, mixing into a buffer which is pre-filled with loud
+	 * samples so that the saturating addition gets exercised as well.
+	 */
+	int16 *convert(bool simd, const int inRate, const int outRate, const bool isStereo, const bool reverseStereo,
+	               const uint16 volL, const uint16 volR, const int chunk, int &frames) {
+		Audio::enableSIMDRateConversion(simd);
+		Audio::SeekableAudioStream *s = createSineStream<int16>(inRate, 1, 0, false, isStereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, isStereo, reverseStereo);
+		Audio::enableSIMDRateConversion(true);
+
+		const int maxFrames = outRate * 2;
+		int16 *buffer = new int16[maxFrames * 2];
+		for (int i = 0; i < maxFrames * 2; ++i)
+			buffer[i] = (int16)((i * 7919) % 50000 - 25000);
+
+		frames = 0;
+		while (frames + chunk <= maxFrames) {
+			const int res = converter->flow(*s, buffer + frames * 2, chunk, volL, volR);
+			frames += res;
+			if (res < chunk)
+				break;
+		}
+
+		delete converter;
+		delete s;
+		return buffer;
+	}
+
+	void compareTemplate(const int inRate, const int outRate, const bool isStereo, const bool reverseStereo,
+	                     const uint16 volL, const uint16 volR, const int chunk) {
+		int scalarFrames, simdFrames;
+		int16 *scalar = convert(false, inRate, outRate, isStereo, reverseStereo, volL, volR, chunk, scalarFrames);
+		int16 *simd = convert(true, inRate, outRate, isStereo, reverseStereo, volL, volR, chunk, simdFrames);
+
+		TS_ASSERT_EQUALS(scalarFrames, simdFrames);
+		TS_ASSERT_LESS_THAN(0, scalarFrames);
+		TS_ASSERT_EQUALS(memcmp(scalar, simd, outRate * 2 * 2 * sizeof(int16)), 0);
+
+		delete[] scalar;
+		delete[] simd;
+	}
+
+	/** Returns the time in milliseconds spent mixing 'channels' streams for one second of output. */
+	double benchmark(bool simd, const int inRate, const bool isStereo, const int channels) {
+		const int outRate = 44100;
+		const int chunk = 2048;
+		int16 *buffer = new int16[chunk * 2];
+
+		Audio::enableSIMDRateConversion(simd);
+		Audio::SeekableAudioStream **streams = new Audio::SeekableAudioStream *[channels];
+		Audio::RateConverter **converters = new Audio::RateConverter *[channels];
+		for (int i = 0; i < channels; ++i) {
+			streams[i] = createSineStream<int16>(inRate, 1, 0, false, isStereo);
+			converters[i] = Audio::makeRateConverter(inRate, outRate, isStereo, false);
+		}
+		Audio::enableSIMDRateConversion(true);
+
+		const double start = getBenchmarkMillis();
+		for (int done = 0; done < outRate; done += chunk) {
+			memset(buffer, 0, chunk * 2 * sizeof(int16));
+			for (int i = 0; i < channels; ++i)
+				converters[i]->flow(*streams[i], buffer, chunk, 200, 180);
+		}
+		const double elapsed = getBenchmarkMillis() - start;
+
+		for (int i = 0; i < channels; ++i) {
+			delete converters[i];
+			delete streams[i];
+		}
+		delete[] converters;
+		delete[] streams;
+		delete[] buffer;
+
+		return elapsed;
+	}
+
+public:
+	void test_copy_mono() {
+		compareTemplate(22050, 22050, false, false, Audio::Mixer::kMaxMixerVolume, 77, 1000);
+	}
+
+	// Stereo copies are mixed by the scalar kernel on SSE2, and by the same
+	// stereo kernels as the other converters on NEON, tested below
+
+	void test_simple_mono() {
+		compareTemplate(44100, 22050, false, false, 200, 201, 127);
+	}
+
+	void test_simple_stereo() {
+		compareTemplate(44100, 11025, true, false, Audio::Mixer::kMaxMixerVolume, 0, 4096);
+	}
+
+	void test_simple_stereo_reversed() {
+		compareTemplate(44100, 22050, true, true, 17, 250, 555);
+	}
+
+	void test_linear_mono() {
+		compareTemplate(11025, 44100, false, false, 99, Audio::Mixer::kMaxMixerVolume, 1023);
+	}
+
+	void test_linear_stereo() {
+		compareTemplate(22050, 48000, true, false, 256, 256, 513);
+	}
+
+	void test_linear_stereo_reversed() {
+		compareTemplate(8000, 22050, true, true, 1, 255, 2047);
+	}
+
+	void test_benchmark() {
+		if (!Audio::hasSIMDRateConversion()) {
+			TS_TRACE("No SIMD mixing kernels available, skipping benchmark");
+			return;
+		}
+
+		static const struct {
+			int rate;
+			bool stereo;
+			const char *name;
+		} configs[] = {
+			{ 44100, false, "copy mono" },
+			{ 22050, false, "linear mono" },
+			{ 22050, true, "linear stereo" }
+		};
+
+		for (int i = 0; i < ARRAYSIZE(configs); ++i) {
+			const double scalar = benchmark(false, configs[i].rate, configs[i].stereo, 16);
+			const double simd = benchmark(true, configs[i].rate, configs[i].stereo, 16);
+			TS_TRACE(Common::String::format("16 channels, %s, 1s of output: scalar %.2f ms, SIMD %.2f ms",
+			                                configs[i].name, scalar, simd).c_str());
+		}
+	}
+};
@@ -0,0 +1,259 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/bitstream.h"
+#include "common/memstream.h"
+#include "common/substream.h"
+
+#include "../benchmark.h"
+
+class BitStreamTestSuite : public CxxTest::TestSuite
+{
+	static const uint32 kDataSize = 4096;
+
+	byte *_data;
+
+	/** Return bit i of the test data, in the order a bit stream with the given layout hands it out. */
+	static uint32 getReferenceBit(const byte *data, int valueBits, bool isLE, bool msb2lsb, uint32 i) {
+		const uint32 valueBytes = valueBits / 8;
+		const byte *value = data + (i / valueBits) * valueBytes;
+
+		uint32 v = 0;
+		for (uint32 b = 0; b < valueBytes; b++)
+			v |= value[b] << (8 * (isLE ? b : valueBytes - 1 - b));
+
+		const uint32 bit = i % valueBits;
+		return (v >> (msb2lsb ? valueBits - 1 - bit : bit)) & 1;
+	}
+
+	/** Return the next n bits of the test data, combined like getBits() does. */
+	static uint32 getReferenceBits(const byte *data, int valueBits, bool isLE, bool msb2lsb, uint32 pos, uint8 n) {
+		uint32 v = 0;
+		for (uint8 i = 0; i < n; i++) {
+			const uint32 bit = getReferenceBit(data, valueBits, isLE, msb2lsb, pos + i);
+			if (msb2lsb)
+				v = (v << 1) | bit;
+			else
+				v |= bit << i;
+		}
+		return v;
+	}
+
+	/** Read the test data with a mix of getBit(), getBits(), peekBits(), addBit() and skip(). */
+	void checkBits(Common::BitStream &bits, int valueBits, bool isLE, bool msb2lsb) {
+		TS_ASSERT_EQUALS(bits.size(), kDataSize * 8);
+		TS_ASSERT_EQUALS(bits.isMSB2LSB(), msb2lsb);
+
+		uint32 pos = 0;
+		uint32 seed = 1;
+		while (pos + 100 < kDataSize * 8) {
+			seed = seed * 1103515245 + 12345;
+			const uint8 n = (seed >> 16) % 33;
+
+			TS_ASSERT_EQUALS(bits.pos(), pos);
+
+			switch ((seed >> 8) % 5) {
+			case 0:
+				TS_ASSERT_EQUALS(bits.getBit(), getReferenceBit(_data, valueBits, isLE, msb2lsb, pos));
+				pos++;
+				break;
+			case 1:
+				TS_ASSERT_EQUALS(bits.getBits(n), getReferenceBits(_data, valueBits, isLE, msb2lsb, pos, n));
+				pos += n;
+				break;
+			case 2:
+				TS_ASSERT_EQUALS(bits.peekBits(n), getReferenceBits(_data, valueBits, isLE, msb2lsb, pos, n));
+				break;
+			case 3: {
+				uint32 x = 0;
+				for (uint8 i = 0; i < n; i++)
+					bits.addBit(x, i);
+				TS_ASSERT_EQUALS(x, getReferenceBits(_data, valueBits, isLE, msb2lsb, pos, n));
+				pos += n;
+				break;
+			}
+			default:
+				// Sometimes skip several values at once
+				bits.skip(n * ((seed >> 12) % 3 + 1));
+				pos += n * ((seed >> 12) % 3 + 1);
+				break;
+			}
+		}
+
+		// Bits past the end are peeked as 0, but can't be read
+		bits.skip(kDataSize * 8 - pos - 3);
+		TS_ASSERT(!bits.eos());
+		TS_ASSERT_EQUALS(bits.peekBits(8), getReferenceBits(_data, valueBits, isLE, msb2lsb, kDataSize * 8 - 3, 3) << (msb2lsb ? 5 : 0));
+		bits.skip(3);
+		TS_ASSERT(bits.eos());
+		TS_ASSERT_EQUALS(bits.peekBits(32), 0U);
+
+		bits.rewind();
+		TS_ASSERT_EQUALS(bits.pos(), 0U);
+		TS_ASSERT_EQUALS(bits.getBits(32), getReferenceBits(_data, valueBits, isLE, msb2lsb, 0, 32));
+	}
+
+	/** Check a layout, reading the data through a MemoryReadStream and through another stream. */
+	template<class BITSTREAM>
+	void checkLayout(int valueBits, bool isLE, bool msb2lsb) {
+		Common::MemoryReadStream memory(_data, kDataSize);
+		BITSTREAM memoryBits(memory);
+		checkBits(memoryBits, valueBits, isLE, msb2lsb);
+
+		Common::SeekableSubReadStream stream(&memory, 0, kDataSize);
+		BITSTREAM streamBits(&stream);
+		checkBits(streamBits, valueBits, isLE, msb2lsb);
+	}
+
+	/** Read fields of 1 to 16 bits, as codecs do, and return the time taken in milliseconds. */
+	template<class BITSTREAM, class STREAM>
+	double benchmarkFields(STREAM &stream, uint32 &sum) {
+		const double start = getBenchmarkMillis();
+		for (int round = 0; round < 50; round++) {
+			stream.seek(0);
+			BITSTREAM bits(stream);
+			uint8 n = 1;
+			while (bits.pos() + 16 <= bits.size()) {
+				sum += bits.getBits(n);
+				n = (n % 16) + 1;
+			}
+		}
+		return getBenchmarkMillis() - start;
+	}
+
+	/** Peek 9 bits and skip 1 to 9 of them, like a Huffman table lookup. */
+	template<class BITSTREAM, class STREAM>
+	double benchmarkPeekSkip(STREAM &stream, uint32 &sum) {
+		const double start = getBenchmarkMillis();
+		for (int round = 0; round < 50; round++) {
+			stream.seek(0);
+			BITSTREAM bits(stream);
+			while (bits.pos() + 16 <= bits.size()) {
+				const uint32 v = bits.peekBits(9);
+				sum += v;
+				bits.skip((v % 9) + 1);
+			}
+		}
+		return getBenchmarkMillis() - start;
+	}
+
+	/** Read fields bit by bit, with one stream read per value, like a plain bit reader does. */
+	template<class STREAM>
+	double benchmarkBitByBit(STREAM &stream, uint32 &sum) {
+		const double start = getBenchmarkMillis();
+		for (int round = 0; round < 50; round++) {
+			stream.seek(0);
+			uint32 value = 0;
+			uint8 inValue = 0;
+			uint32 pos = 0;
+			uint8 n = 1;
+			while (pos + 16 <= kDataSize * 8) {
+				uint32 v = 0;
+				for (uint8 i = 0; i < n; i++) {
+					if (inValue == 0)
+						value = stream.readUint32LE();
+					v |= (value & 1) << i;
+					value >>= 1;
+					inValue = (inValue + 1) % 32;
+				}
+				sum += v;
+				pos += n;
+				n = (n % 16) + 1;
+			}
+		}
+		return getBenchmarkMillis() - start;
+	}
+
+	public:
+	void setUp() {
+		_data = new byte[kDataSize];
+		uint32 seed = 0x12345678;
+		for (uint32 i = 0; i < kDataSize; i++) {
+			seed = seed * 1103515245 + 12345;
+			_data[i] = seed >> 24;
+		}
+	}
+
+	void tearDown() {
+		delete[] _data;
+	}
+
+	void test_layouts() {
+		checkLayout<Common::BitStream8MSB>(8, false, true);
+		checkLayout<Common::BitStream8LSB>(8, false, false);
+		checkLayout<Common::BitStream16LEMSB>(16, true, true);
+		checkLayout<Common::BitStream16LELSB>(16, true, false);
+		checkLayout<Common::BitStream16BEMSB>(16, false, true);
+		checkLayout<Common::BitStream16BELSB>(16, false, false);
+		checkLayout<Common::BitStream32LEMSB>(32, true, true);
+		checkLayout<Common::BitStream32LELSB>(32, true, false);
+		checkLayout<Common::BitStream32BEMSB>(32, false, true);
+		checkLayout<Common::BitStream32BELSB>(32, false, false);
+	}
+
+	void test_stream_offset() {
+		// A bit stream starts at the current position of the stream
+		Common::MemoryReadStream memory(_data, kDataSize);
+		memory.seek(6);
+		Common::BitStream16LELSB bits(memory);
+		TS_ASSERT_EQUALS(bits.pos(), 48U);
+		TS_ASSERT_EQUALS(bits.getBits(16), (uint32)READ_LE_UINT16(_data + 6));
+	}
+
+	void test_end_of_stream() {
+		// Only whole values are read
+		Common::MemoryReadStream memory(_data, 7);
+		Common::BitStream32BEMSB bits(memory);
+		TS_ASSERT_EQUALS(bits.size(), 32U);
+		bits.skip(24);
+		TS_ASSERT_EQUALS(bits.peekBits(16), (uint32)(_data[3] << 8));
+		TS_ASSERT_EQUALS(bits.getBits(8), (uint32)_data[3]);
+		TS_ASSERT(bits.eos());
+	}
+
+	template<class BITSTREAM>
+	void checkSkipFullCache() {
+		// Peeking a bit fills the cache from empty, then all of it is skipped
+		static const byte data[16] = {
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+		};
+		Common::MemoryReadStream memory(data, sizeof(data));
+		BITSTREAM bits(memory);
+		TS_ASSERT_EQUALS(bits.peekBits(1), 1U);
+		bits.skip(64);
+		TS_ASSERT_EQUALS(bits.pos(), 64U);
+		TS_ASSERT_EQUALS(bits.getBits(32), 0U);
+		TS_ASSERT_EQUALS(bits.getBits(32), 0U);
+	}
+
+	void test_skip_full_cache() {
+		checkSkipFullCache<Common::BitStream8MSB>();
+		checkSkipFullCache<Common::BitStream16BELSB>();
+		checkSkipFullCache<Common::BitStream32LELSB>();
+		checkSkipFullCache<Common::BitStream32BEMSB>();
+	}
+
+	void test_benchmark() {
+		Common::MemoryReadStream memory(_data, kDataSize);
+		Common::SeekableSubReadStream stream(&memory, 0, kDataSize);
+		uint32 sumBitByBit = 0, sumMemory = 0, sumStream = 0;
+
+		const double bitByBit = benchmarkBitByBit(stream, sumBitByBit);
+		const double fieldsMemory = benchmarkFields<Common::BitStream32LELSB>(memory, sumMemory);
+		const double fieldsStream = benchmarkFields<Common::BitStream32LELSB>(stream, sumStream);
+		TS_ASSERT_EQUALS(sumMemory, sumBitByBit);
+		TS_ASSERT_EQUALS(sumStream, sumBitByBit);
+
+		const double bits = 50.0 * kDataSize * 8;
+		TS_TRACE(Common::String::format("getBits(), 1 to 16 bits: bit by bit %.0f Mbit/s, MemoryReadStream %.0f Mbit/s, other stream %.0f Mbit/s",
+		                                bits / 1000.0 / MAX(bitByBit, 0.01), bits / 1000.0 / MAX(fieldsMemory, 0.01),
+		                                bits / 1000.0 / MAX(fieldsStream, 0.01)).c_str());
+
+		sumMemory = sumStream = 0;
+		const double peekMemory = benchmarkPeekSkip<Common::BitStream32LELSB>(memory, sumMemory);
+		const double peekStream = benchmarkPeekSkip<Common::BitStream32LELSB>(stream, sumStream);
+		TS_ASSERT_EQUALS(sumMemory, sumStream);
+		TS_TRACE(Common::String::format("peekBits(9) and skip(): MemoryReadStream %.0f Mbit/s, other stream %.0f Mbit/s",
+		                                bits / 1000.0 / MAX(peekMemory, 0.01), bits / 1000.0 / MAX(peekStream, 0.01)).c_str());
+	}
+};
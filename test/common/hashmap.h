@@ -1,8 +1,11 @@
 #include <cxxtest/TestSuite.h>
 
 #include "common/hashmap.h"
+#include "common/flathashmap.h"
 #include "common/hash-str.h"
 
+#include "../benchmark.h"
+
 class HashMapTestSuite : public CxxTest::TestSuite
 {
 	public:
@@ -232,3 +235,191 @@ class HashMapTestSuite : public CxxTest::TestSuite
 
 	// TODO: Add test cases for iterators, find, ...
 };
+
+class FlatHashMapTestSuite : public CxxTest::TestSuite
+{
+	typedef Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FlatStringMap;
+
+	/** Returns the time in milliseconds spent on lookups of existing and missing keys. */
+	template<class Map>
+	double benchmarkLookups(const int count, const int rounds) {
+		Map map;
+		for (int i = 0; i < count; ++i)
+			map[i * 7] = i;
+
+		const double start = getBenchmarkMillis();
+		int sum = 0;
+		for (int r = 0; r < rounds; ++r) {
+			for (int i = 0; i < count * 7; ++i) {
+				if (map.contains(i))
+					sum += map.getVal(i);
+			}
+		}
+		const double elapsed = getBenchmarkMillis() - start;
+
+		TS_ASSERT_EQUALS(sum, rounds * (count * (count - 1) / 2));
+		return elapsed;
+	}
+
+	template<class Map>
+	double benchmarkStringLookups(const int count, const int rounds) {
+		Common::Array<Common::String> keys;
+		Map map;
+		for (int i = 0; i < count; ++i) {
+			keys.push_back(Common::String::format("resource.%03d", i));
+			map[keys[i]] = keys[i];
+		}
+
+		const double start = getBenchmarkMillis();
+		uint found = 0;
+		for (int r = 0; r < rounds; ++r) {
+			for (int i = 0; i < count; ++i)
+				found += map.getVal(keys[i]).size();
+		}
+		const double elapsed = getBenchmarkMillis() - start;
+
+		TS_ASSERT_EQUALS(found, (uint)(rounds * count * strlen("resource.000")));
+		return elapsed;
+	}
+
+	public:
+	void test_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+		TS_ASSERT(!container.contains(0));
+
+		FlatStringMap container2;
+		TS_ASSERT(container2.empty());
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(!container2.empty());
+		container2.clear(true);
+		TS_ASSERT(container2.empty());
+		TS_ASSERT(!container2.contains("foo"));
+	}
+
+	void test_contains() {
+		FlatStringMap container;
+		container["foo"] = "bar";
+		container["quux"] = "blub";
+		TS_ASSERT(container.contains("foo"));
+		TS_ASSERT(container.contains("QUUX"));
+		TS_ASSERT(!container.contains("bar"));
+		TS_ASSERT_EQUALS(container.getVal("Foo"), "bar");
+		TS_ASSERT_EQUALS(container.size(), 2U);
+	}
+
+	void test_lookup_with_default() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = -1;
+		container.setVal(2, 45);
+
+		const Common::FlatHashMap<int, int> &containerRef = container;
+
+		TS_ASSERT_EQUALS(containerRef.getVal(0), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(2), 45);
+		TS_ASSERT_EQUALS(containerRef.getVal(17), 0);
+		TS_ASSERT_EQUALS(containerRef.getVal(1, -10), -1);
+		TS_ASSERT_EQUALS(containerRef.getVal(17, -10), -10);
+		TS_ASSERT_EQUALS(containerRef.size(), 3U);
+	}
+
+	void test_collision() {
+		// Multiples of a power of two end up in the same bucket with
+		// trivial hashing, make sure they still work with erasing.
+		Common::FlatHashMap<int, int> h;
+		for (int i = 0; i < 8; ++i)
+			h[i << 12] = i;
+		h.erase(1 << 12);
+		h.erase(4 << 12);
+		for (int i = 0; i < 8; ++i) {
+			TS_ASSERT_EQUALS(h.contains(i << 12), i != 1 && i != 4);
+			if (i != 1 && i != 4)
+				TS_ASSERT_EQUALS(h[i << 12], i);
+		}
+		TS_ASSERT_EQUALS(h.size(), 6U);
+	}
+
+	void test_against_hashmap() {
+		// Random inserts and erases, with the map growing through several
+		// sizes, must behave exactly like the pointer based HashMap.
+		uint32 seed = 0x1234;
+		Common::HashMap<int, int> ref;
+		Common::FlatHashMap<int, int> flat;
+
+		for (int i = 0; i < 20000; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const int key = ((seed >> 8) % 2001) * 16;
+			switch ((seed >> 24) % 4) {
+			case 0:
+				ref.erase(key);
+				flat.erase(key);
+				break;
+			case 1: {
+				Common::FlatHashMap<int, int>::iterator it = flat.find(key);
+				TS_ASSERT_EQUALS(it != flat.end(), ref.contains(key));
+				if (it != flat.end()) {
+					TS_ASSERT_EQUALS(it->_key, key);
+					flat.erase(it);
+					ref.erase(key);
+				}
+				break;
+			}
+			default:
+				ref[key] = i;
+				flat[key] = i;
+				break;
+			}
+			TS_ASSERT_EQUALS(flat.size(), ref.size());
+		}
+
+		Common::HashMap<int, int>::const_iterator r;
+		for (r = ref.begin(); r != ref.end(); ++r)
+			TS_ASSERT_EQUALS(flat.getVal(r->_key, -1), r->_value);
+
+		uint visited = 0;
+		Common::FlatHashMap<int, int>::const_iterator f;
+		for (f = flat.begin(); f != flat.end(); ++f) {
+			TS_ASSERT_EQUALS(ref.getVal(f->_key, -1), f->_value);
+			visited++;
+		}
+		TS_ASSERT_EQUALS(visited, ref.size());
+	}
+
+	void test_copy_reserve() {
+		Common::FlatHashMap<int, int> map1;
+		map1.reserve(1000);
+		for (int i = 0; i < 1000; ++i)
+			map1[i] = -i;
+
+		Common::FlatHashMap<int, int> map2(map1), map3;
+		map3[5] = 5;
+		map3 = map1;
+		map1.clear();
+
+		TS_ASSERT_EQUALS(map2.size(), 1000U);
+		TS_ASSERT_EQUALS(map3.size(), 1000U);
+		for (int i = 0; i < 1000; ++i) {
+			TS_ASSERT_EQUALS(map2[i], -i);
+			TS_ASSERT_EQUALS(map3[i], -i);
+		}
+	}
+
+	void test_benchmark() {
+		const double hashInt = benchmarkLookups<Common::HashMap<int, int> >(5000, 20);
+		const double flatInt = benchmarkLookups<Common::FlatHashMap<int, int> >(5000, 20);
+		TS_TRACE(Common::String::format("int keys, 700000 lookups: HashMap %.2f ms, FlatHashMap %.2f ms",
+		                                hashInt, flatInt).c_str());
+
+		const double hashStr = benchmarkStringLookups<Common::StringMap>(1000, 100);
+		const double flatStr = benchmarkStringLookups<FlatStringMap>(1000, 100);
+		TS_TRACE(Common::String::format("string keys, 100000 lookups: HashMap %.2f ms, FlatHashMap %.2f ms",
+		                                hashStr, flatStr).c_str());
+	}
+};
@@ -0,0 +1,235 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/huffman.h"
+#include "common/bitstream.h"
+#include "common/memstream.h"
+
+#include "../benchmark.h"
+
+// Bink codebooks 13 and 14, with codes of 1 to 7 bits, LSB first
+static const uint32 huffmanTestBinkCodes[2][16] = {
+	{ 0x00, 0x01, 0x05, 0x03, 0x07, 0x27, 0x17, 0x37, 0x0F, 0x4F, 0x2F, 0x6F, 0x1F, 0x5F, 0x3F, 0x7F },
+	{ 0x00, 0x01, 0x05, 0x03, 0x07, 0x17, 0x37, 0x77, 0x0F, 0x4F, 0x2F, 0x6F, 0x1F, 0x5F, 0x3F, 0x7F }
+};
+
+static const uint8 huffmanTestBinkLengths[2][16] = {
+	{ 1, 3, 3, 3, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 7, 7 },
+	{ 1, 3, 3, 3, 5, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7 }
+};
+
+class HuffmanTestSuite : public CxxTest::TestSuite
+{
+	/** Writes codes into the 32 bit words of a BitStream32LELSB or BitStream32BEMSB. */
+	class BitWriter {
+	public:
+		BitWriter(bool msb2lsb) : _msb2lsb(msb2lsb), _bits(0) {}
+
+		void putBit(uint32 bit) {
+			if ((_bits % 32) == 0)
+				_words.push_back(0);
+			if (bit)
+				_words.back() |= _msb2lsb ? (0x80000000 >> (_bits % 32)) : (1u << (_bits % 32));
+			_bits++;
+		}
+
+		/** Write a code, whose first bit is the one addBit() adds first. */
+		void putCode(uint32 code, uint8 length) {
+			for (uint8 i = 0; i < length; i++)
+				putBit(_msb2lsb ? (code >> (length - 1 - i)) & 1 : (code >> i) & 1);
+		}
+
+		/** Return the words in the byte order of the bit stream. */
+		byte *getData(uint32 &size) const {
+			size = _words.size() * 4;
+			byte *data = new byte[size];
+			for (uint32 i = 0; i < _words.size(); i++) {
+				if (_msb2lsb)
+					WRITE_BE_UINT32(data + i * 4, _words[i]);
+				else
+					WRITE_LE_UINT32(data + i * 4, _words[i]);
+			}
+			return data;
+		}
+
+		uint32 bits() const {
+			return _bits;
+		}
+
+	private:
+		bool _msb2lsb;
+		uint32 _bits;
+		Common::Array<uint32> _words;
+	};
+
+	/** A fixed pseudo-random sequence, as Common::RandomSource needs g_system. */
+	class TestRandom {
+	public:
+		TestRandom() : _seed(0x12345678) {}
+
+		uint32 getRandomNumber(uint32 max) {
+			_seed = _seed * 1103515245 + 12345;
+			return (_seed >> 8) % (max + 1);
+		}
+
+	private:
+		uint32 _seed;
+	};
+
+	/** Assign canonical codes to the given code lengths, MSB first. */
+	static void makeCanonicalCodes(const uint8 *lengths, uint32 count, uint32 *codes) {
+		uint32 code = 0;
+		for (uint8 length = 1; length <= 32; length++) {
+			for (uint32 i = 0; i < count; i++) {
+				if (lengths[i] == length)
+					codes[i] = code++;
+			}
+			code <<= 1;
+		}
+	}
+
+	/** Reverse the bit order of the codes, to read them from an LSB first stream. */
+	static void reverseCodes(const uint8 *lengths, uint32 count, uint32 *codes) {
+		for (uint32 i = 0; i < count; i++) {
+			uint32 reversed = 0;
+			for (uint8 j = 0; j < lengths[i]; j++)
+				reversed |= ((codes[i] >> j) & 1) << (lengths[i] - 1 - j);
+			codes[i] = reversed;
+		}
+	}
+
+	/** Encode the symbols, decode them again, and check that the stream ends right after the last one. */
+	void checkRoundTrip(bool msb2lsb, uint8 maxLength, uint32 count, const uint32 *codes, const uint8 *lengths,
+	                    const uint32 *symbols, const Common::Array<uint32> &indices) {
+		Common::Huffman huffman(maxLength, count, codes, lengths, symbols);
+
+		BitWriter writer(msb2lsb);
+		for (uint32 i = 0; i < indices.size(); i++)
+			writer.putCode(codes[indices[i]], lengths[indices[i]]);
+		const uint32 codeBits = writer.bits();
+		// Pad to a full word, as the bit streams can't read partial words
+		while (writer.bits() % 32)
+			writer.putBit(0);
+
+		uint32 size;
+		byte *data = writer.getData(size);
+		Common::MemoryReadStream stream(data, size, DisposeAfterUse::YES);
+
+		Common::BitStream *bits;
+		if (msb2lsb)
+			bits = new Common::BitStream32BEMSB(stream);
+		else
+			bits = new Common::BitStream32LELSB(stream);
+
+		for (uint32 i = 0; i < indices.size(); i++)
+			TS_ASSERT_EQUALS(huffman.getSymbol(*bits), symbols ? symbols[indices[i]] : indices[i]);
+		TS_ASSERT_EQUALS(bits->pos(), codeBits);
+
+		delete bits;
+	}
+
+	/** Decode the symbols by comparing the code read so far with all codes of that length. */
+	static uint32 getSymbolLinear(Common::BitStream &bits, uint8 maxLength, uint32 count, const uint32 *codes, const uint8 *lengths) {
+		uint32 code = 0;
+		for (uint8 length = 1; length <= maxLength; length++) {
+			bits.addBit(code, length - 1);
+			for (uint32 i = 0; i < count; i++) {
+				if (lengths[i] == length && codes[i] == code)
+					return i;
+			}
+		}
+		return 0xFFFFFFFF;
+	}
+
+	public:
+	void test_bink_codebooks() {
+		TestRandom rnd;
+
+		for (int book = 0; book < 2; book++) {
+			Common::Array<uint32> indices;
+			for (int i = 0; i < 1000; i++)
+				indices.push_back(rnd.getRandomNumber(15));
+
+			checkRoundTrip(false, 0, 16, huffmanTestBinkCodes[book], huffmanTestBinkLengths[book], 0, indices);
+		}
+	}
+
+	void test_symbols() {
+		static const uint8 lengths[] = { 2, 2, 2, 3, 3 };
+		static const uint32 symbols[] = { 100, 200, 300, 400, 500 };
+		uint32 codes[5];
+		makeCanonicalCodes(lengths, 5, codes);
+
+		Common::Array<uint32> indices;
+		for (uint32 i = 0; i < 5; i++)
+			indices.push_back(4 - i);
+
+		checkRoundTrip(true, 0, 5, codes, lengths, symbols, indices);
+	}
+
+	void test_long_codes() {
+		// Codes of up to 14 bits, longer than the prefix tables
+		uint8 lengths[15];
+		for (uint32 i = 0; i < 14; i++)
+			lengths[i] = i + 1;
+		lengths[14] = 14;
+
+		uint32 codes[15];
+		makeCanonicalCodes(lengths, 15, codes);
+
+		TestRandom rnd;
+		Common::Array<uint32> indices;
+		for (int i = 0; i < 2000; i++)
+			indices.push_back(rnd.getRandomNumber(14));
+		// End on the shortest code, which is read bit by bit at the end of the stream
+		indices.push_back(0);
+
+		checkRoundTrip(true, 0, 15, codes, lengths, 0, indices);
+
+		reverseCodes(lengths, 15, codes);
+		checkRoundTrip(false, 0, 15, codes, lengths, 0, indices);
+	}
+
+	void test_benchmark() {
+		TestRandom rnd;
+
+		const uint32 *codes = huffmanTestBinkCodes[1];
+		const uint8 *lengths = huffmanTestBinkLengths[1];
+		const uint32 symbolCount = 200000;
+
+		// Symbol frequencies roughly as implied by the code lengths
+		BitWriter writer(false);
+		for (uint32 i = 0; i < symbolCount; i++) {
+			uint32 index = 0;
+			while (index < 15 && rnd.getRandomNumber(1))
+				index++;
+			writer.putCode(codes[index], lengths[index]);
+		}
+		while (writer.bits() % 32)
+			writer.putBit(0);
+
+		uint32 size;
+		byte *data = writer.getData(size);
+		Common::MemoryReadStream stream(data, size, DisposeAfterUse::YES);
+		Common::Huffman huffman(0, 16, codes, lengths);
+
+		Common::BitStream32LELSB linearBits(stream);
+		double start = getBenchmarkMillis();
+		uint32 linearSum = 0;
+		for (uint32 i = 0; i < symbolCount; i++)
+			linearSum += getSymbolLinear(linearBits, 7, 16, codes, lengths);
+		const double linear = getBenchmarkMillis() - start;
+
+		stream.seek(0);
+		Common::BitStream32LELSB tableBits(stream);
+		start = getBenchmarkMillis();
+		uint32 tableSum = 0;
+		for (uint32 i = 0; i < symbolCount; i++)
+			tableSum += huffman.getSymbol(tableBits);
+		const double table = getBenchmarkMillis() - start;
+
+		TS_ASSERT_EQUALS(linearSum, tableSum);
+		TS_TRACE(Common::String::format("Bink codebook 14, %u symbols: linear search %.2f ms (%.0f symbols/s), lookup table %.2f ms (%.0f symbols/s)",
+		                                symbolCount, linear, symbolCount * 1000.0 / MAX(linear, 0.01),
+		                                table, symbolCount * 1000.0 / MAX(table, 0.01)).c_str());
+	}
+};
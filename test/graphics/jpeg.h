@@ -0,0 +1,161 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/stream.h"
+
+#include "graphics/surface.h"
+#include "graphics/decoders/jpeg.h"
+#include "graphics/decoders/jpeg_idct.h"
+
+/**
+ * A 32x32 baseline JPEG with 4:2:0 chroma subsampling, made of four 16x16
+ * MCUs in flat colors (red, green, blue and gray, in reading order). It has
+ * a restart interval of one MCU, so every MCU but the first one follows a
+ * restart marker.
+ */
+static const byte jpegRestartImage[] = {
+	0xff, 0xd8, 0xff, 0xe0, 0x00, 0x10, 0x4a, 0x46, 0x49, 0x46, 0x00, 0x01,
+	0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0xff, 0xdb, 0x00, 0x43,
+	0x00, 0x03, 0x02, 0x02, 0x03, 0x02, 0x02, 0x03, 0x03, 0x03, 0x03, 0x04,
+	0x03, 0x03, 0x04, 0x05, 0x08, 0x05, 0x05, 0x04, 0x04, 0x05, 0x0a, 0x07,
+	0x07, 0x06, 0x08, 0x0c, 0x0a, 0x0c, 0x0c, 0x0b, 0x0a, 0x0b, 0x0b, 0x0d,
+	0x0e, 0x12, 0x10, 0x0d, 0x0e, 0x11, 0x0e, 0x0b, 0x0b, 0x10, 0x16, 0x10,
+	0x11, 0x13, 0x14, 0x15, 0x15, 0x15, 0x0c, 0x0f, 0x17, 0x18, 0x16, 0x14,
+	0x18, 0x12, 0x14, 0x15, 0x14, 0xff, 0xdb, 0x00, 0x43, 0x01, 0x03, 0x04,
+	0x04, 0x05, 0x04, 0x05, 0x09, 0x05, 0x05, 0x09, 0x14, 0x0d, 0x0b, 0x0d,
+	0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14,
+	0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14,
+	0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14,
+	0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14,
+	0x14, 0x14, 0xff, 0xc0, 0x00, 0x11, 0x08, 0x00, 0x20, 0x00, 0x20, 0x03,
+	0x01, 0x22, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01, 0xff, 0xc4, 0x00,
+	0x17, 0x00, 0x01, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x08, 0x09, 0xff, 0xc4,
+	0x00, 0x14, 0x10, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xc4, 0x00, 0x18,
+	0x01, 0x00, 0x02, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x06, 0x07, 0x08, 0xff, 0xc4,
+	0x00, 0x14, 0x11, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xdd, 0x00, 0x04,
+	0x00, 0x01, 0xff, 0xda, 0x00, 0x0c, 0x03, 0x01, 0x00, 0x02, 0x11, 0x03,
+	0x11, 0x00, 0x3f, 0x00, 0xae, 0x80, 0x28, 0xc3, 0x53, 0x7f, 0xff, 0xd0,
+	0x9d, 0x80, 0xc3, 0xe5, 0xc4, 0xff, 0xd1, 0xcf, 0x70, 0x0d, 0x4d, 0x07,
+	0x7f, 0xff, 0xd2, 0x00, 0x03, 0xff, 0xd9
+};
+
+class JPEGTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	int32 nextRandom(int32 min, int32 max) {
+		_seed = _seed * 1103515245 + 12345;
+		return min + (int32)((_seed >> 8) % (uint32)(max - min + 1));
+	}
+
+	/** Checks that the selected IDCT kernel produces the same output as the scalar one. */
+	void compareIDCT(const int32 block[64]) {
+		int32 scalar[64], simd[64];
+		memcpy(scalar, block, sizeof(scalar));
+		memcpy(simd, block, sizeof(simd));
+
+		Graphics::enableSIMDJPEGIDCT(false);
+		Graphics::getJPEGIDCTFunc()(scalar);
+		Graphics::enableSIMDJPEGIDCT(true);
+		Graphics::getJPEGIDCTFunc()(simd);
+
+		TS_ASSERT_EQUALS(memcmp(scalar, simd, sizeof(scalar)), 0);
+	}
+
+	const Graphics::Surface *decode(Graphics::JPEGDecoder &decoder) {
+		Common::MemoryReadStream stream(jpegRestartImage, sizeof(jpegRestartImage));
+		TS_ASSERT(decoder.loadStream(stream));
+		return decoder.getSurface();
+	}
+
+public:
+	void test_idct_random_blocks() {
+		if (!Graphics::hasSIMDJPEGIDCT())
+			TS_TRACE("No SIMD IDCT kernel available, comparing the scalar kernel with itself");
+
+		_seed = 12345;
+		int32 block[64];
+		for (int i = 0; i < 2000; ++i) {
+			// Sparse blocks like most real ones, and dense ones
+			const int density = (i & 1) ? 64 : 8;
+			for (int j = 0; j < 64; ++j)
+				block[j] = (nextRandom(0, 63) < density) ? nextRandom(-2048, 2047) : 0;
+			compareIDCT(block);
+		}
+	}
+
+	void test_idct_extreme_blocks() {
+		// The largest coefficients a baseline JPEG can encode: with equal,
+		// alternating and checkered signs, and alone in every position
+		static const int32 extremes[] = { 2047, -2048 };
+		int32 block[64];
+		for (int sign = 0; sign < 2; ++sign) {
+			for (int j = 0; j < 64; ++j)
+				block[j] = extremes[sign];
+			compareIDCT(block);
+
+			for (int j = 0; j < 64; ++j)
+				block[j] = extremes[(j + sign) & 1];
+			compareIDCT(block);
+
+			for (int j = 0; j < 64; ++j)
+				block[j] = extremes[((j >> 3) + (j & 7) + sign) & 1];
+			compareIDCT(block);
+
+			for (int j = 0; j < 64; ++j) {
+				memset(block, 0, sizeof(block));
+				block[j] = extremes[sign];
+				compareIDCT(block);
+			}
+		}
+	}
+
+	void test_decode_restart_markers() {
+		static const byte colors[4][3] = {
+			{ 255, 0, 0 }, { 0, 255, 0 }, { 0, 0, 255 }, { 128, 128, 128 }
+		};
+
+		Graphics::JPEGDecoder decoder;
+		const Graphics::Surface *surface = decode(decoder);
+		TS_ASSERT(surface);
+		if (!surface)
+			return;
+
+		TS_ASSERT_EQUALS(surface->w, 32);
+		TS_ASSERT_EQUALS(surface->h, 32);
+		TS_ASSERT_EQUALS(surface->format.bytesPerPixel, 4);
+
+		// Lossy compression and the color conversion leave the colors a
+		// bit off, but mixing up the DC predictors of the MCUs would not
+		for (int y = 0; y < 32; ++y) {
+			for (int x = 0; x < 32; ++x) {
+				const byte *expected = colors[(y / 16) * 2 + x / 16];
+				byte r, g, b;
+				surface->format.colorToRGB(*(const uint32 *)surface->getBasePtr(x, y), r, g, b);
+				TS_ASSERT_LESS_THAN(ABS(r - expected[0]), 8);
+				TS_ASSERT_LESS_THAN(ABS(g - expected[1]), 8);
+				TS_ASSERT_LESS_THAN(ABS(b - expected[2]), 8);
+			}
+		}
+	}
+
+	void test_decode_simd_matches_scalar() {
+		Graphics::enableSIMDJPEGIDCT(false);
+		Graphics::JPEGDecoder scalarDecoder;
+		Graphics::enableSIMDJPEGIDCT(true);
+		Graphics::JPEGDecoder simdDecoder;
+
+		const Graphics::Surface *scalar = decode(scalarDecoder);
+		const Graphics::Surface *simd = decode(simdDecoder);
+		TS_ASSERT(scalar && simd);
+		if (!scalar || !simd)
+			return;
+
+		for (int y = 0; y < scalar->h; ++y)
+			TS_ASSERT_EQUALS(memcmp(scalar->getBasePtr(0, y), simd->getBasePtr(0, y), scalar->w * scalar->format.bytesPerPixel), 0);
+	}
+};
@@ -0,0 +1,140 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/endian.h"
+
+#include "graphics/scaler.h"
+
+class ScalerTestSuite : public CxxTest::TestSuite
+{
+	// Scalers may read one pixel around the block they scale, leave more
+	static const int kBorder = 4;
+	static const int kWidth = 40;
+	static const int kMaxHeight = 200;
+	static const int kSrcPitch = (kWidth + 2 * kBorder) * 2;
+	static const int kMaxDstPitch = kWidth * 3 * 2;
+
+	byte *_src;
+	byte *_serial;
+	byte *_banded;
+
+public:
+	void setUp() {
+		InitScalers(565);
+
+		_src = new byte[kSrcPitch * (kMaxHeight + 2 * kBorder)];
+		_serial = new byte[kMaxDstPitch * kMaxHeight * 3];
+		_banded = new byte[kMaxDstPitch * kMaxHeight * 3];
+
+		// Random pixels, with runs of equal ones, which some scalers
+		// handle specially
+		uint32 seed = 1;
+		uint16 pixel = 0;
+		for (int i = 0; i < kSrcPitch * (kMaxHeight + 2 * kBorder) / 2; ++i) {
+			seed = seed * 1103515245 + 12345;
+			if ((seed >> 16) % 4 != 0)
+				pixel = (uint16)(seed >> 8);
+			WRITE_UINT16(_src + i * 2, pixel);
+		}
+	}
+
+	void tearDown() {
+		delete[] _src;
+		delete[] _serial;
+		delete[] _banded;
+
+		DestroyScalers();
+	}
+
+private:
+	/**
+	 * Scales the block of the given height with a single scaler call, and
+	 * band by band, and checks that the results are identical.
+	 */
+	void checkBands(ScalerProc *proc, int scaleFactor, int height, int maxBands, int minBandHeight) {
+		ScalerJob job;
+		job.proc = proc;
+		job.srcPtr = _src + kBorder * kSrcPitch + kBorder * 2;
+		job.srcPitch = kSrcPitch;
+		job.dstPitch = kWidth * scaleFactor * 2;
+		job.width = kWidth;
+		job.height = height;
+
+		const uint32 dstSize = job.dstPitch * height * scaleFactor;
+		memset(_serial, 0xAA, dstSize);
+		job.dstPtr = _serial;
+		job.run();
+
+		ScalerJob bands[8];
+		memset(_banded, 0x55, dstSize);
+		job.dstPtr = _banded;
+		const int numBands = splitScalerJob(job, scaleFactor, maxBands, minBandHeight, bands);
+		TS_ASSERT_LESS_THAN_EQUALS(1, numBands);
+		TS_ASSERT_LESS_THAN_EQUALS(numBands, maxBands);
+
+		// The bands must cover the block exactly, in order
+		int y = 0;
+		for (int i = 0; i < numBands; ++i) {
+			TS_ASSERT_EQUALS(bands[i].srcPtr, job.srcPtr + y * kSrcPitch);
+			TS_ASSERT_EQUALS(bands[i].dstPtr, job.dstPtr + y * scaleFactor * job.dstPitch);
+			if (numBands > 1)
+				TS_ASSERT_LESS_THAN_EQUALS(2, bands[i].height);
+			y += bands[i].height;
+			bands[i].run();
+		}
+		TS_ASSERT_EQUALS(y, height);
+
+		TS_ASSERT_EQUALS(memcmp(_serial, _banded, dstSize), 0);
+	}
+
+	void checkScaler(ScalerProc *proc, int scaleFactor) {
+		static const int minBandHeights[] = { 1, 2, 3, 16 };
+
+		for (int height = 2; height <= 40; ++height) {
+			for (int maxBands = 1; maxBands <= 8; ++maxBands) {
+				for (int i = 0; i < ARRAYSIZE(minBandHeights); ++i)
+					checkBands(proc, scaleFactor, height, maxBands, minBandHeights[i]);
+			}
+		}
+
+		checkBands(proc, scaleFactor, 199, 3, 16);
+		checkBands(proc, scaleFactor, kMaxHeight, 8, 16);
+	}
+
+public:
+	void test_normal() {
+		checkScaler(Normal1x, 1);
+#ifdef USE_SCALERS
+		checkScaler(Normal2x, 2);
+		checkScaler(Normal3x, 3);
+#endif
+	}
+
+	void test_advmame() {
+#ifdef USE_SCALERS
+		checkScaler(AdvMame2x, 2);
+		checkScaler(AdvMame3x, 3);
+#endif
+	}
+
+	void test_sai() {
+#ifdef USE_SCALERS
+		checkScaler(_2xSaI, 2);
+		checkScaler(Super2xSaI, 2);
+		checkScaler(SuperEagle, 2);
+#endif
+	}
+
+	void test_tv_dotmatrix() {
+#ifdef USE_SCALERS
+		checkScaler(TV2x, 2);
+		checkScaler(DotMatrix, 2);
+#endif
+	}
+
+	void test_hq() {
+#ifdef USE_HQ_SCALERS
+		checkScaler(HQ2x, 2);
+		checkScaler(HQ3x, 3);
+#endif
+	}
+};
@@ -31,7 +31,7 @@
 #include "common/textconsole.h"
 #include "common/math.h"
 #include "common/stream.h"
-#include "common/substream.h"
+#include "common/memstream.h"
 #include "common/file.h"
 #include "common/str.h"
 #include "common/bitstream.h"
@@ -39,6 +39,8 @@
 #include "common/rdft.h"
 #include "common/dct.h"
 #include "common/system.h"
+#include "common/config-manager.h"
+#include "common/worker.h"
 
 #include "graphics/yuv_to_rgb.h"
 #include "graphics/surface.h"
@@ -63,6 +65,13 @@ namespace Video {
 
 BinkDecoder::BinkDecoder() {
 	_bink = 0;
+
+	_videoWorker = 0;
+	_audioWorker = 0;
+
+	_packetData     = 0;
+	_packetDataSize = 0;
+	_decodingFrame  = -1;
 }
 
 BinkDecoder::~BinkDecoder() {
@@ -127,6 +136,20 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 		_bink->skip(4 * audioTrackCount);
 	}
 
+	// Decode the packets on worker threads, one frame ahead of the
+	// one shown, if enabled and offered by the backend
+	if (ConfMan.hasKey("video_threads") && ConfMan.getBool("video_threads")) {
+		_videoWorker = new Common::Worker();
+
+		if (_videoWorker->isThreaded()) {
+			if (audioTrackCount > 0)
+				_audioWorker = new Common::Worker();
+		} else {
+			delete _videoWorker;
+			_videoWorker = 0;
+		}
+	}
+
 	// Reading video frame properties
 	_frames.resize(frameCount);
 	for (uint32 i = 0; i < frameCount; i++) {
@@ -147,11 +170,23 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 }
 
 void BinkDecoder::close() {
+	// The workers may still be decoding into the tracks
+	finishPacket();
+
+	delete _videoWorker;
+	_videoWorker = 0;
+	delete _audioWorker;
+	_audioWorker = 0;
+
 	VideoDecoder::close();
 
 	delete _bink;
 	_bink = 0;
 
+	delete[] _packetData;
+	_packetData     = 0;
+	_packetDataSize = 0;
+
 	_audioTracks.clear();
 	_frames.clear();
 }
@@ -162,56 +197,120 @@ void BinkDecoder::readNextPacket() {
 	if (videoTrack->endOfTrack())
 		return;
 
-	VideoFrame &frame = _frames[videoTrack->getCurFrame() + 1];
+	int32 frameNum = videoTrack->getCurFrame() + 1;
+
+	// Unless it has been started while showing the previous frame
+	if (_decodingFrame != frameNum)
+		startPacket(frameNum);
+
+	finishPacket();
+	videoTrack->showDecodedFrame();
+
+	// Decode the next packet in the background while this frame is shown
+	if (_videoWorker && (frameNum + 1) < (int32)_frames.size())
+		startPacket(frameNum + 1);
+}
+
+void BinkDecoder::startPacket(int32 frameNum) {
+	assert(_decodingFrame < 0);
+
+	VideoFrame &frame = _frames[frameNum];
 
 	if (!_bink->seek(frame.offset))
 		error("Bad bink seek");
 
+	// Read the whole packet at once, so that decoding never touches
+	// the file stream, which might be shared with other streams
+	if (frame.size > _packetDataSize) {
+		delete[] _packetData;
+
+		_packetData     = new byte[frame.size];
+		_packetDataSize = frame.size;
+	}
+
+	if (_bink->read(_packetData, frame.size) != frame.size)
+		error("Bad bink read");
+
+	const byte *data = _packetData;
 	uint32 frameSize = frame.size;
 
 	for (uint32 i = 0; i < _audioTracks.size(); i++) {
 		AudioInfo &audio = _audioTracks[i];
 
-		uint32 audioPacketLength = _bink->readUint32LE();
+		if (frameSize < 4)
+			error("Audio packet too big for the frame");
+
+		uint32 audioPacketLength = READ_LE_UINT32(data);
 
+		data      += 4;
 		frameSize -= 4;
 
 		if (frameSize < audioPacketLength)
 			error("Audio packet too big for the frame");
 
 		if (audioPacketLength >= 4) {
-			// Get our track - audio index plus one as the first track is video
-			BinkAudioTrack *audioTrack = (BinkAudioTrack *)getTrack(i + 1);
-			uint32 audioPacketStart = _bink->pos();
-			uint32 audioPacketEnd   = _bink->pos() + audioPacketLength;
-
 			//                  Number of samples in bytes
-			audio.sampleCount = _bink->readUint32LE() / (2 * audio.channels);
+			audio.sampleCount = READ_LE_UINT32(data) / (2 * audio.channels);
+
+			audio.bits = new Common::BitStream32LELSB(new Common::MemoryReadStream(data + 4,
+					audioPacketLength - 4), true);
+
+			data      += audioPacketLength;
+			frameSize -= audioPacketLength;
+		}
+	}
 
-			audio.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-					audioPacketStart + 4, audioPacketEnd), true);
+	frame.bits = new Common::BitStream32LELSB(new Common::MemoryReadStream(data, frameSize), true);
 
-			audioTrack->decodePacket();
+	_decodingFrame = frameNum;
 
-			delete audio.bits;
-			audio.bits = 0;
+	if (_audioWorker)
+		_audioWorker->start(decodeAudioProc, this);
+	else
+		decodeAudioProc(this);
 
-			_bink->seek(audioPacketEnd);
+	if (_videoWorker)
+		_videoWorker->start(decodeVideoProc, this);
+	else
+		decodeVideoProc(this);
+}
 
-			frameSize -= audioPacketLength;
-		}
+void BinkDecoder::finishPacket() {
+	if (_audioWorker)
+		_audioWorker->wait();
+	if (_videoWorker)
+		_videoWorker->wait();
+
+	if (_decodingFrame < 0)
+		return;
+
+	for (uint32 i = 0; i < _audioTracks.size(); i++) {
+		delete _audioTracks[i].bits;
+		_audioTracks[i].bits = 0;
 	}
 
-	uint32 videoPacketStart = _bink->pos();
-	uint32 videoPacketEnd   = _bink->pos() + frameSize;
+	delete _frames[_decodingFrame].bits;
+	_frames[_decodingFrame].bits = 0;
 
-	frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-			videoPacketStart, videoPacketEnd), true);
+	_decodingFrame = -1;
+}
 
-	videoTrack->decodePacket(frame);
+void BinkDecoder::decodeAudioProc(void *arg) {
+	BinkDecoder *decoder = (BinkDecoder *)arg;
 
-	delete frame.bits;
-	frame.bits = 0;
+	for (uint32 i = 0; i < decoder->_audioTracks.size(); i++) {
+		if (!decoder->_audioTracks[i].bits)
+			continue;
+
+		// Get our track - audio index plus one as the first track is video
+		((BinkAudioTrack *)decoder->getTrack(i + 1))->decodePacket();
+	}
+}
+
+void BinkDecoder::decodeVideoProc(void *arg) {
+	BinkDecoder *decoder = (BinkDecoder *)arg;
+
+	((BinkVideoTrack *)decoder->getTrack(0))->decodePacket(decoder->_frames[decoder->_decodingFrame]);
 }
 
 BinkDecoder::VideoFrame::VideoFrame() : bits(0) {
@@ -343,18 +442,22 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 			break;
 	}
 
+	// Swap the planes with the reference planes
+	for (int i = 0; i < 4; i++)
+		SWAP(_curPlanes[i], _oldPlanes[i]);
+}
+
+void BinkDecoder::BinkVideoTrack::showDecodedFrame() {
 	// Convert the YUV data we have to our format
 	// We're ignoring alpha for now
 	// The width used here is the surface-width, and not the video-width
 	// to allow for odd-sized videos.
-	assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2]);
-	YUVToRGBMan.convert420(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
+	// This is done here and not in decodePacket(), which may run on a
+	// worker thread, as the YUVToRGBManager lookup is shared.
+	assert(_oldPlanes[0] && _oldPlanes[1] && _oldPlanes[2]);
+	YUVToRGBMan.convert420(&_surface, Graphics::YUVToRGBManager::kScaleITU, _oldPlanes[0], _oldPlanes[1], _oldPlanes[2],
 			_surfaceWidth, _surfaceHeight, _surfaceWidth, _surfaceWidth >> 1);
 
-	// And swap the planes with the reference planes
-	for (int i = 0; i < 4; i++)
-		SWAP(_curPlanes[i], _oldPlanes[i]);
-
 	_curFrame++;
 }
 
@@ -48,6 +48,8 @@ class Huffman;
 
 class RDFT;
 class DCT;
+
+class Worker;
 }
 
 namespace Graphics {
@@ -150,6 +152,9 @@ private:
 		/** Decode a video packet. */
 		void decodePacket(VideoFrame &frame);
 
+		/** Convert the last decoded packet into the surface, making it the current frame. */
+		void showDecodedFrame();
+
 	protected:
 		Common::Rational getFrameRate() const { return _frameRate; }
 
@@ -348,7 +353,22 @@ private:
 	Common::Array<AudioInfo> _audioTracks; ///< All audio tracks.
 	Common::Array<VideoFrame> _frames;      ///< All video frames.
 
+	Common::Worker *_videoWorker; ///< Worker decoding video packets, or 0 to decode them right away.
+	Common::Worker *_audioWorker; ///< Worker decoding audio packets, or 0 to decode them right away.
+
+	byte  *_packetData;     ///< The packet being decoded.
+	uint32 _packetDataSize; ///< The size of the packet buffer.
+	int32  _decodingFrame;  ///< The frame whose packet is being decoded, or -1.
+
 	void initAudioTrack(AudioInfo &audio);
+
+	/** Read a packet and start decoding its audio and video. */
+	void startPacket(int32 frameNum);
+	/** Wait until the packet being decoded is done. */
+	void finishPacket();
+
+	static void decodeAudioProc(void *arg);
+	static void decodeVideoProc(void *arg);
 };
 
 } // End of namespace Video
@@ -35,32 +35,23 @@ namespace Video {
 
 JPEGDecoder::JPEGDecoder() : Codec() {
 	_pixelFormat = g_system->getScreenFormat();
-	_surface = NULL;
+
+	// Decode the frames straight to the screen format
+	_jpeg = new Graphics::JPEGDecoder();
+	_jpeg->setOutputPixelFormat(_pixelFormat);
 }
 
 JPEGDecoder::~JPEGDecoder() {
-	if (_surface) {
-		_surface->free();
-		delete _surface;
-	}
+	delete _jpeg;
 }
 
 const Graphics::Surface *JPEGDecoder::decodeImage(Common::SeekableReadStream *stream) {
-	Graphics::JPEGDecoder jpeg;
-
-	if (!jpeg.loadStream(*stream)) {
+	if (!_jpeg->loadStream(*stream)) {
 		warning("Failed to decode JPEG frame");
 		return 0;
 	}
 
-	if (_surface) {
-		_surface->free();
-		delete _surface;
-	}
-
-	_surface = jpeg.getSurface()->convertTo(_pixelFormat);
-
-	return _surface;
+	return _jpeg->getSurface();
 }
 
 } // End of namespace Video
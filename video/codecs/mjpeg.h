@@ -32,6 +32,7 @@ class SeekableReadStream;
 
 namespace Graphics {
 struct Surface;
+class JPEGDecoder;
 }
 
 namespace Video {
@@ -50,7 +51,7 @@ public:
 
 private:
 	Graphics::PixelFormat _pixelFormat;
-	Graphics::Surface *_surface;
+	Graphics::JPEGDecoder *_jpeg;
 };
 
 } // End of namespace Video